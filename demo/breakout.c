@@ -198,7 +198,7 @@ void life_depleting_collision_handler(Body *body1, Body *body2, Vector axis, voi
         body_remove(body2);
     }
 
-    while(find_collision(body_get_shape(body1), body_get_shape(body2)).collided){
+    while(find_collision_view(body_get_shape_view(body1), body_get_shape_view(body2)).collided){
         body_tick(body1, .001);
         body_tick(body2, .001);
     }
@@ -7,7 +7,6 @@
 #include "scene.h"
 #include "sdl_wrapper.h"
 
-#define CIRCLE_POINTS 40
 
 #define MAX ((Vector) {.x = 80.0, .y = 80.0})
 
@@ -20,6 +19,7 @@
 #define PEG_RADIUS 0.5
 #define BALL_RADIUS 1.0
 #define DROP_INTERVAL 1.0 // s
+#define PHYSICS_STEP (1.0 / 120) // s
 #define ELASTICITY 0.3
 #define WALL_WIDTH 1.0
 #define DELTA_X 1.0
@@ -32,6 +32,11 @@
 #define PEG_COLOR ((RGBColor) {0, 1, 0})
 #define WALL_COLOR ((RGBColor) {0, 0, 1})
 
+// Collision groups
+#define BALL_GROUP 1
+#define OBSTACLE_GROUP 2
+#define FROZEN_GROUP 3
+
 #define G 6.67E-11 // N m^2 / kg^2
 #define M 6E24 // kg
 #define g 9.8 // m / s^2
@@ -73,20 +78,6 @@ List *rect_init(double width, double height) {
     return rect;
 }
 
-/** Constructs a circles with the given radius centered at (0, 0) */
-List *circle_init(double radius) {
-    List *circle = list_init(CIRCLE_POINTS, free);
-    double arc_angle = 2 * M_PI / CIRCLE_POINTS;
-    Vector point = {.x = radius, .y = 0.0};
-    for (int i = 0; i < CIRCLE_POINTS; i++) {
-        Vector *v = malloc(sizeof(*v));
-        *v = point;
-        list_add(circle, v);
-        point = vec_rotate(point, arc_angle);
-    }
-    return circle;
-}
-
 /** Computes the center of the peg in the given row and column */
 Vector get_peg_center(int row, int col) {
     Vector center = {
@@ -113,13 +104,13 @@ Body *get_gravity_body() {
 
 /** Creates a ball with the given starting position and velocity */
 Body *get_ball(Vector center, Vector velocity) {
-    List *shape = circle_init(BALL_RADIUS);
     BodyType *info = malloc(sizeof(*info));
     *info = BALL;
-    Body *ball = body_init_with_info(shape, BALL_MASS, BALL_COLOR, info, free);
+    Body *ball = body_init_circle(BALL_RADIUS, BALL_MASS, BALL_COLOR, info, free);
 
     body_set_centroid(ball, center);
     body_set_velocity(ball, velocity);
+    body_set_collision_group(ball, BALL_GROUP);
 
     return ball;
 }
@@ -132,22 +123,18 @@ void freeze(Body *ball, Body *target, Vector axis, void *aux) {
     // Replace the ball with a frozen version
     Scene *scene = (Scene *) aux;
     body_remove(ball);
-    Body *frozen = get_ball(body_get_centroid(ball), VEC_ZERO);
-    *((BodyType *) body_get_info(frozen)) = FROZEN;
-    scene_add_body(scene, frozen);
-
+    BodyType *info = malloc(sizeof(*info));
+    *info = FROZEN;
+    Body *frozen = body_init_circle(BALL_RADIUS, INFINITY, BALL_COLOR, info, free);
+    body_set_centroid(frozen, body_get_centroid(ball));
     // Make other falling bodies freeze when they collide with this body
-    size_t body_count = scene_bodies(scene);
-    for (size_t i = 0; i < body_count; i++) {
-        Body *body = scene_get_body(scene, i);
-        if (get_type(body) == BALL) {
-            create_collision(scene, body, frozen, freeze, scene, NULL);
-        }
-    }
+    body_set_collision_group(frozen, FROZEN_GROUP);
+    // Frozen balls never move again, so they are not ticked
+    scene_add_static_body(scene, frozen);
 }
 
 /** Adds a ball to the scene */
-void add_ball(Scene *scene, Body *gravity_body, List *obstacles) {
+void add_ball(Scene *scene, Body *gravity_body) {
     // Add the ball to the scene.
     Vector ball_center = {
         .x = MAX.x / 2 + (rand_double() - 0.5) * DELTA_X,
@@ -159,38 +146,22 @@ void add_ball(Scene *scene, Body *gravity_body, List *obstacles) {
     // Simulate earth's gravity acting on the ball.
     create_newtonian_gravity(scene, G, gravity_body, ball);
 
-    // Add collisions between all bodies
-    size_t obstacle_count = list_size(obstacles);
-    for (size_t i = 0; i < obstacle_count; i++) {
-        Body *obstacle = list_get(obstacles, i);
-        create_physics_collision(scene, ELASTICITY, ball, obstacle);
-    }
-
-    // Make ball freeze when it hits the ground or other balls
-    size_t body_count = scene_bodies(scene);
-    for (size_t i = 0; i < body_count; i++) {
-        Body *body = scene_get_body(scene, i);
-        if (get_type(body) == FROZEN) {
-            create_collision(scene, ball, body, freeze, scene, NULL);
-        }
-    }
+    // Collisions with obstacles and frozen balls come from the
+    // group collisions added in main(), so nothing is registered per ball
 }
 
 /** Builds the scene to render */
-List *add_obstacles(Scene *scene){
-    List *obstacles = list_init(N_ROWS * N_ROWS, NULL);
-
+void add_obstacles(Scene *scene){
     // Add N_ROWS and N_COLS of pegs.
     for (int i = 1; i <= N_ROWS; i++) {
         for (int j = 0; j <= i; j++) {
-            List *polygon = circle_init(PEG_RADIUS);
             BodyType *type = malloc(sizeof(*type));
             *type = WALL;
             Body *body =
-                body_init_with_info(polygon, INFINITY, PEG_COLOR, type, free);
+                body_init_circle(PEG_RADIUS, INFINITY, PEG_COLOR, type, free);
             body_set_centroid(body, get_peg_center(i, j));
-            scene_add_body(scene, body);
-            list_add(obstacles, body);
+            body_set_collision_group(body, OBSTACLE_GROUP);
+            scene_add_static_body(scene, body);
         }
     }
 
@@ -201,8 +172,8 @@ List *add_obstacles(Scene *scene){
     BodyType *type = malloc(sizeof(*type));
     *type = WALL;
     Body *body = body_init_with_info(rect, INFINITY, WALL_COLOR, type, free);
-    scene_add_body(scene, body);
-    list_add(obstacles, body);
+    body_set_collision_group(body, OBSTACLE_GROUP);
+    scene_add_static_body(scene, body);
 
     rect = rect_init(WALL_LENGTH, WALL_WIDTH);
     polygon_translate(rect, (Vector) {.x = MAX.x - WALL_LENGTH / 2, .y = 0.0});
@@ -210,8 +181,8 @@ List *add_obstacles(Scene *scene){
     type = malloc(sizeof(*type));
     *type = WALL;
     body = body_init_with_info(rect, INFINITY, WALL_COLOR, type, free);
-    scene_add_body(scene, body);
-    list_add(obstacles, body);
+    body_set_collision_group(body, OBSTACLE_GROUP);
+    scene_add_static_body(scene, body);
 
     // Ground is special; it freezes balls when they touch it
     rect = rect_init(MAX.x, WALL_WIDTH);
@@ -219,9 +190,8 @@ List *add_obstacles(Scene *scene){
     *type = FROZEN;
     body = body_init_with_info(rect, INFINITY, WALL_COLOR, type, free);
     body_set_centroid(body, (Vector) {.x = MAX.x / 2, .y = WALL_WIDTH / 2});
-    scene_add_body(scene, body);
-
-    return obstacles;
+    body_set_collision_group(body, FROZEN_GROUP);
+    scene_add_static_body(scene, body);
 }
 
 int main(int argc, char **argv){
@@ -237,7 +207,15 @@ int main(int argc, char **argv){
     scene_add_body(scene, gravity_body);
 
     // Add pegs and walls
-    List *obstacles = add_obstacles(scene);
+    add_obstacles(scene);
+
+    // Balls bounce off obstacles and freeze when they hit the ground
+    // or another frozen ball
+    create_group_physics_collision(scene, ELASTICITY, BALL_GROUP, OBSTACLE_GROUP);
+    scene_add_group_collision(scene, BALL_GROUP, FROZEN_GROUP, freeze, scene, NULL);
+
+    // Physics runs at a fixed rate, however fast frames are drawn
+    scene_set_fixed_step(scene, PHYSICS_STEP, 8);
 
     // Repeatedly render scene
     double time_since_drop = INFINITY;
@@ -247,16 +225,15 @@ int main(int argc, char **argv){
         // Add a new ball every DROP_INTERVAL seconds
         time_since_drop += dt;
         if (time_since_drop > DROP_INTERVAL) {
-            add_ball(scene, gravity_body, obstacles);
+            add_ball(scene, gravity_body);
             time_since_drop = 0.0;
         }
 
-        scene_tick(scene, dt);
+        scene_step_fixed(scene, dt);
         sdl_render_scene(scene);
     }
 
     // Clean up scene
-    list_free(obstacles);
     scene_free(scene);
     return 0;
 }
@@ -144,9 +144,7 @@ Body *create_instructions(Scene *scene) {
 }
 
 void create_large_planet(Scene *scene, RGBColor color) {
-    List *planet_shape = make_ngon(100, 1000);
-    Body *planet = body_init(planet_shape, LARGE_NUMBER, color);
-    body_set_radius(planet, 1000);
+    Body *planet = body_init_circle(1000, LARGE_NUMBER, color, NULL, NULL);
     body_set_image(planet, "images/planetwin0000.png");
     body_set_velocity(planet, VEC_ZERO);
     body_set_centroid(planet, (Vector){0, -1250});
@@ -193,9 +191,7 @@ Body *create_ship(Scene *scene) {
 }
 
 Body *create_habitable_planet(Scene *scene) {
-    List *planet_shape = make_ngon(20, 30);
-    Body *planet = body_init(planet_shape, PLANET_MASS, COLOR_GREEN);
-    body_set_radius(planet, 30);
+    Body *planet = body_init_circle(30, PLANET_MASS, COLOR_GREEN, NULL, NULL);
     body_set_image(planet, "images/planetwin0000.png");
     body_set_centroid(planet, HABITABLE_PLANET_POSITION);
     body_set_velocity(planet, VEC_ZERO);
@@ -209,9 +205,7 @@ void create_planets(Scene *scene) {
         double x_pos = PLANET_X[i];
         double planet_radius = PLANET_RADII[i];
         double mass = PLANET_MASS * pow(planet_radius, 3) / pow(30, 3);
-        List *planet_shape = make_ngon(20, planet_radius);
-        Body *planet = body_init(planet_shape, mass, COLOR_BLUE);
-        body_set_radius(planet, planet_radius);
+        Body *planet = body_init_circle(planet_radius, mass, COLOR_BLUE, NULL, NULL);
         body_set_image(planet, PLANET_IMAGES[i]);
         body_set_centroid(planet, (Vector) {x_pos, y_pos});
         body_set_velocity(planet, VEC_ZERO);
@@ -224,9 +218,7 @@ void create_asteroids(Scene *scene) {
         int which = rand() % 2;
         double y_pos = ASTEROID_Y[i];
         double x_pos = ASTEROID_X[i];
-        List *asteroid_shape = make_ngon(10, 8);
-        Body *asteroid = body_init(asteroid_shape, ASTEROID_MASS, COLOR_YELLOW);
-        body_set_radius(asteroid, 8);
+        Body *asteroid = body_init_circle(8, ASTEROID_MASS, COLOR_YELLOW, NULL, NULL);
         if (which) {
           body_set_image(asteroid, "images/asteroid10000.png");
         }
@@ -243,9 +235,7 @@ void create_aliens(Scene *scene) {
     for (int i = 0; i < NUM_ALIENS; i++) {
         double y_pos = ALIENS_Y[i];
         double x_pos = ALIENS_X[i];
-        List *alien_shape = make_ngon(10, 5);
-        Body *alien = body_init(alien_shape, SMALL_MASS, COLOR_RED);
-        body_set_radius(alien, 5);
+        Body *alien = body_init_circle(5, SMALL_MASS, COLOR_RED, NULL, NULL);
         body_set_image(alien, "images/alien0000.png");
         body_set_centroid(alien, (Vector) {x_pos, y_pos});
         body_set_velocity(alien, ASTEROID_INIT_VEL);
@@ -257,9 +247,7 @@ void create_black_holes(Scene *scene) {
     for (int i = 0; i < NUM_BLACK_HOLES; i++) {
         double y_pos = BLACK_HOLE_Y[i];
         double x_pos = BLACK_HOLE_X[i];
-        List *black_hole_shape = make_ngon(10, 20);
-        Body *black_hole = body_init(black_hole_shape, BLACK_HOLE_MASS, COLOR_WHITE);
-        body_set_radius(black_hole, 20);
+        Body *black_hole = body_init_circle(20, BLACK_HOLE_MASS, COLOR_WHITE, NULL, NULL);
         body_set_image(black_hole, "images/blackhole0000.png");
         body_set_centroid(black_hole, (Vector) {x_pos, y_pos});
         body_set_velocity(black_hole, VEC_ZERO);
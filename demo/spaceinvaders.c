@@ -250,7 +250,7 @@ int main(int argc, char *argv[]) {
       for (int i = 0; i < scene_bodies(scene); i++) { // the bodies we are testing
         for (int j = num_enemies_left + 1; j < scene_bodies(scene); j++) { // the bodies they are colliding with
           //if (i != j) { // if they are different bodies
-            if (find_collision(body_get_shape(scene_get_body(scene, i)), body_get_shape(scene_get_body(scene, j))).collided) {
+            if (find_collision_view(body_get_shape_view(scene_get_body(scene, i)), body_get_shape_view(scene_get_body(scene, j))).collided) {
               // the info of the tested body
               bool thisbody = (bool)body_get_info(scene_get_body(scene, i));
               // the info of the body we are colliding with
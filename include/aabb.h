@@ -0,0 +1,82 @@
+#ifndef __AABB_H__
+#define __AABB_H__
+
+#include <stdbool.h>
+#include "vector.h"
+#include "shape.h"
+
+/**
+ * An axis-aligned bounding box.
+ * AABB is defined here instead of aabb.c because it is passed *by value*.
+ */
+typedef struct {
+    /** The corner with the smallest x and y */
+    Vector min;
+    /** The corner with the largest x and y */
+    Vector max;
+} AABB;
+
+/**
+ * Computes the box around a circle.
+ *
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @return the smallest box containing the circle
+ */
+AABB aabb_of_circle(Vector center, double radius);
+
+/**
+ * Computes the box around the vertices of a polygon.
+ *
+ * @param shape a view of at least one vertex
+ * @return the smallest box containing every vertex
+ */
+AABB aabb_of_view(ShapeView shape);
+
+/**
+ * Determines whether two boxes intersect.
+ * Boxes that only touch along an edge do not intersect.
+ *
+ * @param a the first box
+ * @param b the second box
+ * @return whether the interiors of the boxes overlap
+ */
+bool aabb_overlap(AABB a, AABB b);
+
+/**
+ * Determines whether one box lies entirely inside another.
+ *
+ * @param outer the containing box
+ * @param inner the contained box
+ * @return whether inner is inside outer
+ */
+bool aabb_contains(AABB outer, AABB inner);
+
+/**
+ * Computes the smallest box containing two boxes.
+ *
+ * @param a the first box
+ * @param b the second box
+ * @return the union of a and b
+ */
+AABB aabb_union(AABB a, AABB b);
+
+/**
+ * Grows a box by the same margin on every side.
+ *
+ * @param box the box to grow
+ * @param margin the distance to move each side outwards
+ * @return the grown box
+ */
+AABB aabb_fatten(AABB box, double margin);
+
+/**
+ * Computes the perimeter of a box.
+ * This is the usual cost metric when deciding how to group boxes.
+ *
+ * @param box the box
+ * @return the perimeter of box
+ */
+double aabb_perimeter(AABB box);
+
+#endif // #ifndef __AABB_H__
@@ -0,0 +1,108 @@
+#ifndef __AABB_TREE_H__
+#define __AABB_TREE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "aabb.h"
+#include "broadphase.h"
+
+/**
+ * A dynamic bounding volume hierarchy over boxes.
+ * Each leaf stores a "fat" box, grown by a margin around the box it was given.
+ * A leaf is only moved in the tree when its box leaves its fat box,
+ * so slowly moving boxes usually cost nothing to update.
+ * Leaves are inserted next to the sibling that grows the tree's total
+ * perimeter the least, and the tree is rebalanced with rotations.
+ *
+ * Unlike a uniform grid, the tree handles boxes of very different sizes well.
+ */
+typedef struct aabb_tree AABBTree;
+
+/**
+ * A function called on each box found by aabb_tree_query().
+ */
+typedef BroadphaseQueryHandler AABBTreeQueryHandler;
+
+/**
+ * Allocates memory for an empty tree.
+ * Asserts that the required memory was allocated.
+ *
+ * @param margin how far fat boxes extend beyond the boxes inserted,
+ *   as a fraction of each box's larger side
+ * @return a pointer to the newly allocated tree
+ */
+AABBTree *aabb_tree_init(double margin);
+
+/**
+ * Releases the memory allocated for a tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ */
+void aabb_tree_free(AABBTree *tree);
+
+/**
+ * Adds a box to a tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param id the id to report the box by in pairs and queries
+ * @param box the box
+ * @return a proxy to pass to aabb_tree_move() and aabb_tree_remove()
+ */
+size_t aabb_tree_insert(AABBTree *tree, size_t id, AABB box);
+
+/**
+ * Removes a box from a tree. The proxy may be reused afterwards.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param proxy a proxy returned from aabb_tree_insert()
+ */
+void aabb_tree_remove(AABBTree *tree, size_t proxy);
+
+/**
+ * Moves a box and changes the id it is reported by.
+ * The leaf is only reinserted if the new box is not inside its fat box.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param proxy a proxy returned from aabb_tree_insert()
+ * @param id the id to report the box by
+ * @param box the new box
+ * @return whether the leaf had to be reinserted
+ */
+bool aabb_tree_move(AABBTree *tree, size_t proxy, size_t id, AABB box);
+
+/**
+ * Calls a function on every box in a tree that overlaps a given box.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param box the box to search
+ * @param handler the function to call with the id of each box found
+ * @param aux the auxiliary value to pass to the handler
+ */
+void aabb_tree_query(AABBTree *tree, AABB box, AABBTreeQueryHandler handler, void *aux);
+
+/**
+ * Finds every pair of boxes in a tree that overlap.
+ * Each pair is added to the buffer exactly once, in no particular order.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param pairs the buffer to add the overlapping pairs to
+ */
+void aabb_tree_find_pairs(AABBTree *tree, PairBuffer *pairs);
+
+/**
+ * Gets the height of a tree, i.e. the number of nodes on its longest path.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @return the height of the tree, or 0 if it is empty
+ */
+size_t aabb_tree_height(AABBTree *tree);
+
+/**
+ * Asserts that a tree's parent links, heights and boxes are consistent.
+ * Meant for tests.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ */
+void aabb_tree_validate(AABBTree *tree);
+
+#endif // #ifndef __AABB_TREE_H__
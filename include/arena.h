@@ -0,0 +1,70 @@
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A bump allocator for short-lived memory, such as scratch space for a tick.
+ * Allocating just moves a pointer forward, and nothing is freed on its own;
+ * arena_reset() releases everything allocated from the arena at once.
+ */
+typedef struct arena Arena;
+
+/**
+ * Allocates memory for an empty arena.
+ * Asserts that the required memory was allocated.
+ *
+ * @param capacity the number of bytes to allocate space for
+ * @param fixed if true, the arena never grows past its capacity
+ * @return the new arena
+ */
+Arena *arena_init(size_t capacity, bool fixed);
+
+/**
+ * Releases the memory allocated for an arena.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_free(Arena *arena);
+
+/**
+ * Allocates memory from an arena, aligned for any type.
+ * If the arena is full, it grows unless it is fixed.
+ * Asserts that a fixed arena has enough space left.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @param size the number of bytes to allocate
+ * @return the allocated memory, valid until the next arena_reset()
+ */
+void *arena_alloc(Arena *arena, size_t size);
+
+/**
+ * Releases everything allocated from an arena.
+ * If the arena had to grow, its space is merged into one block,
+ * so later rounds of allocations do not grow it again.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ */
+void arena_reset(Arena *arena);
+
+/**
+ * Gets the number of bytes allocated from an arena since it was last reset.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @return the number of bytes in use, including alignment padding
+ */
+size_t arena_used(Arena *arena);
+
+/**
+ * Releases everything allocated from an arena since it had a given number
+ * of bytes in use, so that scratch space for a repeated step can be reused.
+ * Memory allocated before then stays valid. If the arena grew since,
+ * the space it grew by still counts towards the block arena_reset() merges.
+ *
+ * @param arena a pointer to an arena returned from arena_init()
+ * @param used a value of arena_used() since the arena was last reset
+ */
+void arena_rewind(Arena *arena, size_t used);
+
+#endif // #ifndef __ARENA_H__
@@ -4,7 +4,10 @@
 #include "body.h"
 
 /**
- * A struct that contains a list of bodies and a list of constants
+ * A struct that contains a list of bodies and a list of constants,
+ * for user-defined force creators registered with
+ * scene_add_bodies_force_creator(). The built-in forces store their
+ * parameters inline instead (see scene_add_force_params()).
  */
 typedef struct aux Aux;
 
@@ -18,10 +21,10 @@ Aux *aux_init(size_t num_bodies, size_t num_constants);
 
 
 /**
- * Releases memory allocated for a given aux
- * and all the bodies and force creators it contains.
+ * Releases memory allocated for a given aux.
+ * Does not free the bodies it refers to.
  *
- * @param scene a pointer to a scene returned from scene_init()
+ * @param aux a pointer to an aux returned from aux_init()
  */
 void aux_free(Aux *aux);
 
@@ -0,0 +1,63 @@
+#ifndef __BARNES_HUT_H__
+#define __BARNES_HUT_H__
+
+#include <stddef.h>
+#include "vector.h"
+
+/**
+ * A Barnes-Hut quadtree for computing the gravitational field of many masses.
+ * Each cell of the tree stores the total mass and center of mass of the
+ * masses inside it. When evaluating the field at a point, a cell that looks
+ * small from the point (its side divided by its distance is below the
+ * opening angle theta) is treated as a single mass at its center of mass.
+ * This takes the cost of computing every mass's field from O(N^2) to O(N log N).
+ *
+ * The tree is rebuilt with barnes_hut_build() whenever the masses move;
+ * its arrays are kept between builds.
+ */
+typedef struct barnes_hut BarnesHut;
+
+/**
+ * Allocates memory for an empty tree.
+ * Asserts that the required memory was allocated.
+ *
+ * @param theta the opening angle; 0 computes the field exactly,
+ *   and larger values are faster but less accurate (0.5 is typical)
+ * @param min_distance distances below this are treated as this distance,
+ *   so the field cannot approach infinity when two masses get close
+ * @return a pointer to the newly allocated tree
+ */
+BarnesHut *barnes_hut_init(double theta, double min_distance);
+
+/**
+ * Releases the memory allocated for a tree.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ */
+void barnes_hut_free(BarnesHut *tree);
+
+/**
+ * Builds the tree over a set of masses, replacing any previous masses.
+ * The arrays are read during this call and by barnes_hut_field(),
+ * so they must not change until the next build.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ * @param positions the position of each mass
+ * @param masses the value of each mass
+ * @param n the number of masses
+ */
+void barnes_hut_build(BarnesHut *tree, const Vector *positions, const double *masses, size_t n);
+
+/**
+ * Computes the gravitational field at the position of one of the masses,
+ * due to every other mass, divided by the gravitational constant.
+ * Multiplying by G and by the mass gives the force on it.
+ *
+ * @param tree a pointer to a tree returned from barnes_hut_init()
+ * @param index the index of the mass, as given to barnes_hut_build()
+ * @return the sum of m * r / (|r| * max(|r|, min_distance)^2)
+ *   over the other masses m at displacements r
+ */
+Vector barnes_hut_field(BarnesHut *tree, size_t index);
+
+#endif // #ifndef __BARNES_HUT_H__
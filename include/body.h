@@ -11,15 +11,41 @@
 #include "list.h"
 #include "vector.h"
 #include "polygon.h"
+#include "shape.h"
+#include "body_store.h"
+#include "aabb.h"
+#include "broadphase.h"
 
 /**
  * A rigid body constrained to the plane.
  * Implemented as a polygon with uniform density.
  * Bodies can accumulate forces and impulses during each tick.
  * Angular physics (i.e. torques) are not currently implemented.
+ *
+ * A Body is a handle: its position, velocity, forces, impulses,
+ * inverse mass and removal flag live in a slot of a BodyStore.
+ * A body that is not in a scene owns a private single-slot store;
+ * scene_add_body() moves the slot into the scene's store.
+ *
+ * The shape is stored once relative to the centroid, together with the
+ * body's angle. Moving or rotating a body is O(1); the world-space vertices
+ * are only recomputed when something asks for them after a change.
+ *
+ * A body can instead be an exact circle (see body_init_circle()),
+ * which has no vertices at all and collides analytically.
  */
 typedef struct body Body;
 
+/**
+ * The kinds of shape a body can have.
+ */
+typedef enum {
+    /** A convex polygon given by its vertices */
+    BODY_POLYGON,
+    /** A circle around the centroid, with radius body_get_radius() */
+    BODY_CIRCLE
+} BodyKind;
+
 /**
  * Initializes a body without any info.
  * Acts like body_init_with_info() where info and info_freer are NULL.
@@ -43,6 +69,48 @@ Body *body_init_with_info(
     List *shape, double mass, RGBColor color, void *info, FreeFunc info_freer
 );
 
+/**
+ * Allocates memory for a body whose vertices are given as a Shape.
+ * Acts like body_init_with_info(), but the body takes ownership of the shape
+ * instead of copying a list.
+ *
+ * @param shape the initial shape of the body, freed with the body
+ * @param mass the mass of the body (if INFINITY, prevents the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+Body *body_init_shape(
+    Shape *shape, double mass, RGBColor color, void *info, FreeFunc info_freer
+);
+
+/**
+ * Allocates memory for a body shaped like an exact circle.
+ * Acts like body_init_shape(), but the body stores no vertices:
+ * its shape views are empty, it is drawn as a circle, and
+ * collisions with it are computed from its centroid and radius.
+ *
+ * @param radius the radius of the circle
+ * @param mass the mass of the body (if INFINITY, prevents the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+Body *body_init_circle(
+    double radius, double mass, RGBColor color, void *info, FreeFunc info_freer
+);
+
+/**
+ * Gets the kind of shape a body has.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return BODY_CIRCLE if the body was made with body_init_circle(),
+ *   and BODY_POLYGON otherwise
+ */
+BodyKind body_get_kind(Body *body);
+
 /**
  * Releases the memory allocated for a body.
  *
@@ -65,6 +133,7 @@ SDL_Surface *body_get_image(Body *body);
 
 /**
  * Sets the radius of a round body.
+ * For a circle body, this also resizes the circle it collides as.
  *
  * @param body the body to set
  * @param radius the radius
@@ -85,6 +154,167 @@ double body_get_radius(Body *body);
  */
 List *body_get_shape(Body *body);
 
+/**
+ * Gets a borrowed view of the current vertices of a body, without copying.
+ * The view must not be freed. It is valid until the body is next moved,
+ * rotated, or freed; take a new view after any of those.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a view of the body's vertices in world space
+ */
+ShapeView body_get_shape_view(Body *body);
+
+/**
+ * Gets the outward unit normals of the edges of a body in world space,
+ * in the order given by polygon_view_edge_normals().
+ * The normals are computed once in model space and are only rotated
+ * when the body's rotation changes. The array must not be freed,
+ * and is valid until the body is next rotated or freed.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the first of body_get_shape_view().size normals
+ */
+const Vector *body_get_normals(Body *body);
+
+/**
+ * Gets a box that contains a body at every rotation.
+ * The box is centered on the centroid and reaches as far as
+ * the farthest vertex, so computing it does not touch the vertices.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a box containing the body
+ */
+AABB body_get_aabb(Body *body);
+
+/**
+ * Gets the distance from a body's centroid to its farthest vertex.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the radius of the smallest circle around the centroid
+ *   that contains the body
+ */
+double body_get_bounding_radius(Body *body);
+
+/**
+ * Puts a body in a collision group.
+ * Bodies in groups are checked for collisions by the scene's broadphase
+ * according to the rules added with scene_add_group_collision().
+ * Bodies start in group 0, which is never checked.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param group the new group of the body
+ */
+void body_set_collision_group(Body *body, size_t group);
+
+/**
+ * Gets the collision group of a body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the group set by body_set_collision_group(), or 0
+ */
+size_t body_get_collision_group(Body *body);
+
+/**
+ * Records the proxy of a body in its scene's incremental broadphase.
+ * Only the scene should call this.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param proxy the proxy, or NO_PROXY if the body is not in the broadphase
+ */
+void body_set_broadphase_proxy(Body *body, size_t proxy);
+
+/**
+ * Gets the proxy of a body in its scene's incremental broadphase.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the proxy set by body_set_broadphase_proxy(), or NO_PROXY
+ */
+size_t body_get_broadphase_proxy(Body *body);
+
+/**
+ * Records that one of its scene's force creators depends on a body,
+ * so the scene can find the body's forces without searching all of them.
+ * Only the scene should call this.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param handle the index of the force creator in the scene
+ * @return the slot of the handle in the body's list of force handles
+ */
+size_t body_add_force_handle(Body *body, size_t handle);
+
+/**
+ * Removes the force handle in a given slot by moving the last handle into it.
+ * Only the scene should call this.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param slot a slot returned from body_add_force_handle()
+ */
+void body_remove_force_handle(Body *body, size_t slot);
+
+/**
+ * Changes the force handle in a given slot, after the scene moved the force.
+ * Only the scene should call this.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param slot a slot returned from body_add_force_handle()
+ * @param handle the new index of the force creator in the scene
+ */
+void body_set_force_handle(Body *body, size_t slot, size_t handle);
+
+/**
+ * Gets the force handle in a given slot.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param slot a slot less than body_force_handles()
+ * @return the index of the force creator in the scene
+ */
+size_t body_get_force_handle(Body *body, size_t slot);
+
+/**
+ * Gets the number of its scene's force creators that depend on a body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the number of force handles
+ */
+size_t body_force_handles(Body *body);
+
+/**
+ * Sets whether a body takes part in its scene's gravity fields
+ * (see create_gravity_field()). Bodies start out not gravitating.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param gravitating whether the body attracts and is attracted by
+ *   the other gravitating bodies
+ */
+void body_set_gravitating(Body *body, bool gravitating);
+
+/**
+ * Gets whether a body takes part in its scene's gravity fields.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the value set by body_set_gravitating()
+ */
+bool body_is_gravitating(Body *body);
+
+/**
+ * Sets whether a body is a bullet, i.e. moves fast enough to pass through
+ * thin bodies within one tick. Its scene sweeps bullets along their motion
+ * and stops them at the first thing they hit (see ccd_time_of_impact()).
+ * Bodies start out not being bullets.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param bullet whether the body's collisions are found continuously
+ */
+void body_set_bullet(Body *body, bool bullet);
+
+/**
+ * Gets whether a body is a bullet.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the value set by body_set_bullet()
+ */
+bool body_is_bullet(Body *body);
+
 /**
  * Gets the current center of mass of a body.
  * While this could be calculated with polygon_centroid(), that becomes too slow
@@ -96,6 +326,18 @@ List *body_get_shape(Body *body);
  */
 Vector body_get_centroid(Body *body);
 
+/**
+ * Gets where to draw a body a fraction of the way through the next tick,
+ * by blending its centroid before and after the last tick.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param alpha how far through the next tick to draw the body,
+ *   from 0 (where it was before the last tick) to 1 (where it is now);
+ *   see scene_step_alpha()
+ * @return the body's interpolated center of mass
+ */
+Vector body_get_interpolated_centroid(Body *body, double alpha);
+
 /**
  * Gets the current velocity of a body.
  *
@@ -157,6 +399,8 @@ int body_get_depth(Body *body);
 /**
  * Translates a body to a new position.
  * The position is specified by the position of the body's center of mass.
+ * The body is not interpolated from its old position
+ * (see body_get_interpolated_centroid()).
  *
  * @param body a pointer to a body returned from body_init()
  * @param x the body's new centroid
@@ -165,6 +409,8 @@ void body_set_centroid(Body *body, Vector x);
 
 /**
  * Changes a body's velocity (the time-derivative of its position).
+ * A nonzero velocity wakes the body if it is asleep (see body_wake()).
+ * Static bodies keep a zero velocity (see body_is_static()).
  *
  * @param body a pointer to a body returned from body_init()
  * @param v the body's new velocity
@@ -187,6 +433,7 @@ void body_set_rotation(Body *body, double angle);
 /**
  * Applies a force to a body over the current tick.
  * If multiple forces are applied in the same tick, they should be added.
+ * Forces on static bodies are discarded.
  * Should not change the body's position or velocity; see body_tick().
  *
  * @param body a pointer to a body returned from body_init()
@@ -199,6 +446,7 @@ void body_add_force(Body *body, Vector force);
  * An impulse causes an instantaneous change in velocity,
  * which is useful for modeling collisions.
  * If multiple impulses are applied in the same tick, they should be added.
+ * Impulses on static bodies are discarded.
  * Should not change the body's position or velocity; see body_tick().
  *
  * @param body a pointer to a body returned from body_init()
@@ -238,9 +486,98 @@ void body_remove(Body *body);
  */
 bool body_is_removed(Body *body);
 
+/**
+ * Returns whether a body is asleep.
+ * A scene puts bodies to sleep when they have been still for long enough
+ * (see scene_set_sleep()); sleeping bodies are not integrated,
+ * and the forces added to them are discarded.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether the body is asleep
+ */
+bool body_is_asleep(Body *body);
+
+/**
+ * Returns whether a body is static, i.e. was added to its scene
+ * with scene_add_static_body(). Static bodies never move on their own.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether the body is static
+ */
+bool body_is_static(Body *body);
+
+/**
+ * Wakes a sleeping body, along with every body that fell asleep with it.
+ * Does nothing if the body is awake.
+ * Must not be called from a force creator.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_wake(Body *body);
+
+/**
+ * Gets the index of a body's slot in its store,
+ * which changes whenever the store moves the slot.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the index of the body's slot
+ */
+size_t body_get_slot(Body *body);
+
 /* Returns the distance between two bodies. */
 double body_distance(Body *b1, Body * b2);
 
+/**
+ * Moves a body's slot into a given store.
+ * If the body owned its previous store (i.e. it was not in a scene),
+ * that store is freed.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param store the store to move the body's state into
+ */
+void body_set_store(Body *body, BodyStore *store);
+
+/**
+ * Records where a body's slot is after its store moved it.
+ * Only called by body_store.c.
+ *
+ * @param body the body whose slot moved
+ * @param store the store holding the slot
+ * @param index the new index of the slot
+ */
+void body_attach(Body *body, BodyStore *store, size_t index);
+
+/**
+ * Gives up a body's slot in its store without freeing the body,
+ * so body_free() leaves the store alone. The body cannot be used
+ * for anything but body_free() afterwards.
+ * Called by a scene when it removes a body during a tick,
+ * so the slot can be reused before the body is freed.
+ *
+ * @param body the body to take out of its store
+ */
+void body_detach(Body *body);
+
+/**
+ * Makes the calling thread's body_add_force(), body_add_impulse(),
+ * and body_remove() on bodies in a given store write into an accumulator
+ * instead of the store, so that several threads can apply forces at once.
+ * Other threads are not affected.
+ *
+ * @param store the store whose bodies to redirect, or NULL to stop redirecting
+ * @param accumulator the thread's accumulator, reset to the store's size
+ */
+void body_redirect_accumulation(BodyStore *store, BodyAccumulator *accumulator);
+
+/**
+ * Brings the cached world-space vertices and normals of a body up to date,
+ * so that later body_get_shape_view() and body_get_normals() calls
+ * only read the body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_update_world(Body *body);
+
 /**
  * Sets the texture of the body as an SDL_Texture.
  *
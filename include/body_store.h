@@ -0,0 +1,266 @@
+#ifndef __BODY_STORE_H__
+#define __BODY_STORE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "vector.h"
+
+typedef struct body Body;
+
+/**
+ * Struct-of-arrays storage for the state of bodies that changes every tick.
+ * Slot i of every array belongs to the body handles[i].
+ * Keeping these fields in parallel contiguous arrays (instead of inside
+ * each Body) lets a scene integrate all of its bodies in one linear pass.
+ * The struct is defined here because body.c and scene.c index it directly.
+ *
+ * The slots of awake bodies come first: [0, awake) are awake and
+ * [awake, size) are asleep, so integrating only the awake bodies
+ * is still one linear pass however many bodies are asleep.
+ *
+ * A static store holds bodies that never move. It is never integrated,
+ * and the forces and impulses added to its bodies are discarded.
+ */
+typedef struct body_store {
+    size_t size;
+    size_t capacity;
+    /** The number of awake slots, which come before the sleeping ones */
+    size_t awake;
+    /** Whether the store holds static bodies */
+    bool is_static;
+    /** Set when a slot is removed or a static body is moved,
+        so that structures built over the slots know to rebuild */
+    bool changed;
+    /** The centroid of each body */
+    Vector *position;
+    /** The centroid before the body was last integrated,
+        for drawing bodies between ticks (see body_get_interpolated_centroid()) */
+    Vector *previous;
+    Vector *velocity;
+    /** The force accumulated during the current tick */
+    Vector *force;
+    /** The impulse accumulated during the current tick */
+    Vector *impulse;
+    /** 1 / mass, so that an INFINITY mass becomes 0 */
+    double *inv_mass;
+    /** Whether body_remove() has been called on the body */
+    bool *removed;
+    /** How long each awake body has been still enough to sleep, in seconds */
+    double *idle_time;
+    /** The island each sleeping body fell asleep with; unused while awake */
+    size_t *island;
+    /** The body that owns each slot */
+    Body **handles;
+} BodyStore;
+
+/**
+ * Allocates memory for an empty store.
+ * Asserts that the required memory was allocated.
+ *
+ * @param initial_size the number of slots to allocate space for
+ * @return the new store
+ */
+BodyStore *body_store_init(size_t initial_size);
+
+/**
+ * Releases the memory allocated for a store.
+ * Does not free the bodies whose slots are still in the store.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ */
+void body_store_free(BodyStore *store);
+
+/**
+ * Adds an awake slot for a body, growing the arrays if they are full.
+ * The new slot is at rest at the origin with no accumulated force or impulse.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param handle the body that owns the new slot
+ * @return the index of the new slot
+ */
+size_t body_store_add(BodyStore *store, Body *handle);
+
+/**
+ * Removes the slot at a given index by moving another slot into its place,
+ * keeping the awake slots before the sleeping ones.
+ * The body that owned the moved slot is told its new index,
+ * and the store is marked as changed.
+ * Asserts that the index is valid.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param index the slot to remove
+ */
+void body_store_remove(BodyStore *store, size_t index);
+
+/**
+ * Copies the slot at a given index of one store into a new awake slot
+ * of another, then removes it from the first store.
+ *
+ * @param store the store to move the slot into
+ * @param from the store currently holding the slot
+ * @param index the index of the slot in from
+ * @return the index of the slot in store
+ */
+size_t body_store_move(BodyStore *store, BodyStore *from, size_t index);
+
+/**
+ * Swaps two slots, telling their bodies their new indices.
+ * Asserts that the indices are valid.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param i one slot
+ * @param j the other slot
+ */
+void body_store_swap(BodyStore *store, size_t i, size_t j);
+
+/**
+ * Puts the body in an awake slot to sleep: its velocity is zeroed,
+ * its previous centroid is set to its centroid,
+ * and its slot moves to the front of the sleeping ones.
+ * Asserts that the slot is awake.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param index the awake slot
+ * @param island the island the body falls asleep with
+ * @return the new index of the slot
+ */
+size_t body_store_sleep(BodyStore *store, size_t index, size_t island);
+
+/**
+ * Wakes every sleeping body in an island, moving their slots
+ * to the back of the awake ones and restarting their idle times.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param island the island to wake
+ */
+void body_store_wake_island(BodyStore *store, size_t island);
+
+/**
+ * Integrates the slots in [start, end) over a given time interval.
+ * Each velocity is changed by the accumulated impulse and force,
+ * and each position is moved by the average of the old and new velocities.
+ * The accumulated forces and impulses are then reset.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param start the first slot to integrate
+ * @param end one past the last slot to integrate
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void body_store_integrate(BodyStore *store, size_t start, size_t end, double dt);
+
+/**
+ * Saves the positions of the slots in [start, end) as their previous positions,
+ * before they are integrated.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param start the first slot to save
+ * @param end one past the last slot to save
+ */
+void body_store_save_previous(BodyStore *store, size_t start, size_t end);
+
+/**
+ * Changes the velocities of the slots in [start, end) by their accumulated
+ * impulses, then resets the impulses.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param start the first slot
+ * @param end one past the last slot
+ */
+void body_store_apply_impulses(BodyStore *store, size_t start, size_t end);
+
+/**
+ * Changes the velocities of the slots in [start, end) by their accumulated
+ * forces over a time interval. The forces are kept.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param start the first slot
+ * @param end one past the last slot
+ * @param dt the time interval, in seconds
+ */
+void body_store_kick(BodyStore *store, size_t start, size_t end, double dt);
+
+/**
+ * Moves the positions of the slots in [start, end) by their velocities
+ * over a time interval, then resets their accumulated forces.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param start the first slot
+ * @param end one past the last slot
+ * @param dt the time interval, in seconds
+ */
+void body_store_drift(BodyStore *store, size_t start, size_t end, double dt);
+
+/** The number of force evaluations in one step of body_store_rk4_stage() */
+#define RK4_STAGES 4
+
+/**
+ * Runs one stage of a classical Runge-Kutta step of the slots in [start, end),
+ * using the forces accumulated at the state the previous stage left them in.
+ * Stage 0 starts from the slots' current positions and velocities.
+ * Each stage but the last leaves the slots at the state to accumulate
+ * the forces of the next stage at, and the last leaves them at the end
+ * of the step. Each stage resets the accumulated forces.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param start the first slot
+ * @param end one past the last slot
+ * @param dt the length of the whole step, in seconds
+ * @param stage the stage, from 0 to RK4_STAGES - 1
+ * @param scratch RK4_STAGES vectors per slot in [0, end),
+ *   kept between the stages of a step
+ */
+void body_store_rk4_stage(BodyStore *store, size_t start, size_t end, double dt,
+                          size_t stage, Vector *scratch);
+
+/**
+ * Private buffers that one thread accumulates forces, impulses, and removals
+ * into while several threads run force creators on the same store.
+ * Slot i of every array shadows slot i of the store.
+ * Summing the buffers into the store in a fixed order afterwards
+ * keeps the result independent of how the threads were scheduled.
+ */
+typedef struct body_accumulator {
+    size_t capacity;
+    Vector *force;
+    Vector *impulse;
+    bool *removed;
+} BodyAccumulator;
+
+/**
+ * Allocates memory for an accumulator with no slots.
+ * Asserts that the required memory was allocated.
+ *
+ * @return the new accumulator
+ */
+BodyAccumulator *body_accumulator_init(void);
+
+/**
+ * Releases the memory allocated for an accumulator.
+ *
+ * @param accumulator a pointer returned from body_accumulator_init()
+ */
+void body_accumulator_free(BodyAccumulator *accumulator);
+
+/**
+ * Clears the first size slots of an accumulator, growing it if needed.
+ *
+ * @param accumulator a pointer returned from body_accumulator_init()
+ * @param size the number of slots in the store it shadows
+ */
+void body_accumulator_reset(BodyAccumulator *accumulator, size_t size);
+
+/**
+ * Adds the slots in [start, end) of some accumulators into a store.
+ * The accumulators are added in the order they are given,
+ * so the sums are the same every time for the same inputs.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ * @param accumulators the accumulators, each reset to at least end slots
+ * @param count the number of accumulators
+ * @param start the first slot to reduce
+ * @param end one past the last slot to reduce
+ */
+void body_store_reduce(BodyStore *store, BodyAccumulator **accumulators, size_t count,
+                       size_t start, size_t end);
+
+#endif // #ifndef __BODY_STORE_H__
@@ -0,0 +1,91 @@
+#ifndef __BROADPHASE_H__
+#define __BROADPHASE_H__
+
+#include <stddef.h>
+
+/** The proxy of an item that is not in an incremental broadphase */
+#define NO_PROXY ((size_t) -1)
+
+/** The broadphases a scene can find group collisions with */
+typedef enum {
+    /** A spatial hash rebuilt every tick (see spatial_hash.h) */
+    BROADPHASE_GRID,
+    /** An incremental sort and sweep (see sweep.h) */
+    BROADPHASE_SWEEP,
+    /** A dynamic tree of fat boxes (see aabb_tree.h) */
+    BROADPHASE_TREE
+} BroadphaseType;
+
+/**
+ * A function called on each box a broadphase query finds.
+ *
+ * @param id the id the box was inserted with
+ * @param aux the auxiliary value passed to the query
+ */
+typedef void (*BroadphaseQueryHandler)(size_t id, void *aux);
+
+/**
+ * Two items that a broadphase found might be colliding,
+ * identified by the ids they were inserted with. first < second.
+ * BodyPair is defined here instead of broadphase.c because it is passed *by value*.
+ */
+typedef struct {
+    size_t first;
+    size_t second;
+} BodyPair;
+
+/**
+ * A growable array of candidate pairs filled in by a broadphase.
+ * The struct is defined here so that callers can iterate over pairs directly.
+ * Clearing the buffer keeps its memory, so a buffer reused every tick
+ * stops allocating once it has grown to the usual number of pairs.
+ */
+typedef struct pair_buffer {
+    size_t size;
+    size_t capacity;
+    BodyPair *pairs;
+} PairBuffer;
+
+/**
+ * Allocates memory for an empty pair buffer.
+ * Asserts that the required memory was allocated.
+ *
+ * @param initial_size the number of pairs to allocate space for
+ * @return a pointer to the newly allocated buffer
+ */
+PairBuffer *pair_buffer_init(size_t initial_size);
+
+/**
+ * Releases the memory allocated for a pair buffer.
+ *
+ * @param buffer a pointer to a buffer returned from pair_buffer_init()
+ */
+void pair_buffer_free(PairBuffer *buffer);
+
+/**
+ * Removes all pairs from a buffer without releasing its memory.
+ *
+ * @param buffer a pointer to a buffer returned from pair_buffer_init()
+ */
+void pair_buffer_clear(PairBuffer *buffer);
+
+/**
+ * Appends a pair to a buffer, growing it if it is full.
+ * The ids may be given in either order. Asserts that they differ.
+ *
+ * @param buffer a pointer to a buffer returned from pair_buffer_init()
+ * @param id1 the id of one item
+ * @param id2 the id of the other item
+ */
+void pair_buffer_add(PairBuffer *buffer, size_t id1, size_t id2);
+
+/**
+ * Sorts the pairs in a buffer by first id, then by second id.
+ * Different broadphases find pairs in different orders;
+ * sorting makes the order collisions are handled in the same for all of them.
+ *
+ * @param buffer a pointer to a buffer returned from pair_buffer_init()
+ */
+void pair_buffer_sort(PairBuffer *buffer);
+
+#endif // #ifndef __BROADPHASE_H__
@@ -0,0 +1,43 @@
+#ifndef __BROADPHASE_CHECK_H__
+#define __BROADPHASE_CHECK_H__
+
+/** A brute-force check shared by the broadphase test suites. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "aabb.h"
+#include "broadphase.h"
+
+/**
+ * Checks that a broadphase found exactly the pairs of overlapping boxes,
+ * by testing every pair of boxes. Sorts the pairs first.
+ * The broadphase must have given box i the id i.
+ *
+ * @param boxes the boxes, by id
+ * @param present whether each box is in the broadphase, or NULL if all are
+ * @param n the number of boxes
+ * @param pairs the pairs the broadphase found
+ */
+void check_pairs(const AABB *boxes, const bool *present, size_t n, PairBuffer *pairs);
+
+/**
+ * A query handler that counts how many times each id is found.
+ *
+ * @param id the id of the box found
+ * @param aux the array of counts, by id
+ */
+void count_found(size_t id, void *aux);
+
+/**
+ * Checks that a broadphase query found each box overlapping the query box
+ * exactly once and no others, by testing every box. Resets the counts.
+ *
+ * @param boxes the boxes, by id
+ * @param present whether each box is in the broadphase, or NULL if all are
+ * @param n the number of boxes
+ * @param box the box that was searched
+ * @param found the counts from count_found()
+ */
+void check_query(const AABB *boxes, const bool *present, size_t n, AABB box, size_t *found);
+
+#endif // #ifndef __BROADPHASE_CHECK_H__
@@ -0,0 +1,127 @@
+#ifndef __CCD_H__
+#define __CCD_H__
+
+#include <stdbool.h>
+#include "vector.h"
+#include "shape.h"
+#include "body.h"
+
+/**
+ * Continuous collision detection: finds when two moving shapes first touch
+ * during a step, so that fast bodies cannot pass through thin ones
+ * between the positions the discrete tests in collision.h see.
+ *
+ * Each test works in the frame of the second shape. Both shapes are given
+ * where they are at the end of the step, and the first shape is taken to
+ * have moved by motion relative to the second during the step, i.e.
+ * it started at its end position minus motion. Shapes only translate.
+ */
+
+/**
+ * Conservative advancement stops once the shapes are this fraction
+ * of the motion's length apart, so the time of impact it finds is
+ * at most this much before the exact one.
+ */
+#define CCD_TOLERANCE 1e-4
+
+/**
+ * Conservative advancement reports a time of impact after this many steps
+ * even if the shapes are not yet within CCD_TOLERANCE, which only happens
+ * when they approach corner to corner at a grazing angle.
+ */
+#define CCD_MAX_ITERATIONS 32
+
+/**
+ * A convex shape as seen by the swept tests: a polygon, or a circle.
+ */
+typedef struct {
+    /** The polygon's vertices in counterclockwise order, or empty for a circle */
+    ShapeView polygon;
+    /** The polygon's outward edge normals, or NULL to compute them */
+    const Vector *normals;
+    /** The circle's center, if polygon is empty */
+    Vector center;
+    /** The circle's radius, if polygon is empty */
+    double radius;
+} CcdShape;
+
+/**
+ * Gets the shape a body collides as, for the swept tests.
+ * The shape borrows the body's cached world vertices and normals,
+ * so it is valid until the body moves.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's shape at its current position
+ */
+CcdShape ccd_body_shape(Body *body);
+
+/**
+ * Finds when a moving circle first touches a convex polygon,
+ * by casting the circle's center against the polygon grown by its radius.
+ *
+ * @param center the circle's center at the end of the step
+ * @param radius the circle's radius
+ * @param polygon the polygon's vertices, in counterclockwise order
+ * @param normals the polygon's edge normals, or NULL to compute them
+ * @param motion how far the circle moved relative to the polygon
+ * @param toi set to the fraction of the step at which they touch
+ * @param axis set to the unit contact normal, from the circle to the polygon
+ * @return whether they touch during the step; false if they
+ *   already overlap at its start, which the discrete tests handle
+ */
+bool ccd_circle_polygon_toi(Vector center, double radius, ShapeView polygon,
+                            const Vector *normals, Vector motion, double *toi, Vector *axis);
+
+/**
+ * Finds when a moving circle first touches another circle.
+ *
+ * @param center1 the first circle's center at the end of the step
+ * @param radius1 the first circle's radius
+ * @param center2 the second circle's center
+ * @param radius2 the second circle's radius
+ * @param motion how far the first circle moved relative to the second
+ * @param toi set to the fraction of the step at which they touch
+ * @param axis set to the unit contact normal, from the first circle to the second
+ * @return whether they touch during the step; false if they
+ *   already overlap at its start
+ */
+bool ccd_circle_circle_toi(Vector center1, double radius1, Vector center2, double radius2,
+                           Vector motion, double *toi, Vector *axis);
+
+/**
+ * Finds when a moving convex polygon first touches another
+ * by conservative advancement: it repeatedly moves the first polygon
+ * along its motion by as far as it can go without closing the largest
+ * gap between them along an edge normal, until that gap is within
+ * CCD_TOLERANCE of the motion or starts growing.
+ *
+ * @param shape1 the first polygon at the end of the step
+ * @param normals1 the edge normals of shape1, or NULL to compute them
+ * @param shape2 the second polygon
+ * @param normals2 the edge normals of shape2, or NULL to compute them
+ * @param motion how far shape1 moved relative to shape2
+ * @param toi set to the fraction of the step at which they touch
+ * @param axis set to the unit contact normal, from shape1 to shape2
+ * @return whether they touch during the step; false if they
+ *   already overlap at its start
+ */
+bool ccd_conservative_advancement(ShapeView shape1, const Vector *normals1,
+                                  ShapeView shape2, const Vector *normals2,
+                                  Vector motion, double *toi, Vector *axis);
+
+/**
+ * Finds when two moving shapes first touch, using the swept circle tests
+ * if either is a circle and conservative advancement otherwise.
+ *
+ * @param shape1 the first shape at the end of the step
+ * @param shape2 the second shape
+ * @param motion how far shape1 moved relative to shape2
+ * @param toi set to the fraction of the step at which they touch
+ * @param axis set to the unit contact normal, from shape1 to shape2
+ * @return whether they touch during the step; false if they
+ *   already overlap at its start
+ */
+bool ccd_time_of_impact(CcdShape shape1, CcdShape shape2, Vector motion,
+                        double *toi, Vector *axis);
+
+#endif // #ifndef __CCD_H__
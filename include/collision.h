@@ -5,6 +5,17 @@
 #include "list.h"
 #include "vector.h"
 #include "body.h"
+#include "gjk.h"
+#include "contact.h"
+
+/**
+ * Bodies with more vertices than this between them are tested with GJK/EPA
+ * instead of SAT. SAT projects every vertex onto every edge normal,
+ * so its cost grows with the square of the vertex count, while GJK/EPA
+ * only walks the few vertices near each support point.
+ * tests/bench_collision.c shows the two break even between 32 and 64.
+ */
+#define GJK_VERTEX_THRESHOLD 40
 
 /**
  * Represents the status of a collision between two shapes.
@@ -20,8 +31,38 @@ typedef struct {
      * If collided is false, this value is undefined.
      */
     Vector axis;
+    /**
+     * If the shapes are colliding, how far they overlap along the axis,
+     * i.e. how far the second shape must move along it to stop colliding.
+     * If collided is false, this value is undefined.
+     */
+    double depth;
 } CollisionInfo;
 
+/**
+ * When choosing which polygon's edge to clip against, the second polygon's
+ * edge is only chosen if its normal is this much closer to the collision
+ * axis, so that nearly parallel edges do not trade places from tick to tick.
+ */
+#define REFERENCE_EDGE_TOLERANCE 1e-3
+
+/**
+ * A collision, along with the points where the shapes touch.
+ * Where polygons touch edge to edge, there are two points,
+ * and a body resting on the other is held up at both.
+ */
+typedef struct {
+    /** Whether the two shapes are colliding */
+    bool collided;
+    /** The collision axis, as in CollisionInfo */
+    Vector axis;
+    /** The penetration depth, as in CollisionInfo */
+    double depth;
+    /** The number of points, from 1 to MAX_MANIFOLD_POINTS if collided */
+    size_t count;
+    ContactPoint points[MAX_MANIFOLD_POINTS];
+} ContactManifold;
+
 /**
  * A function called when a collision occurs.
  * @param body1 the first body passed to create_collision()
@@ -40,6 +81,8 @@ typedef struct collision_aux {
   CollisionHandler handler;
   void *aux;
   FreeFunc freer;
+  /** Warm-start state for GJK, zeroed when the collision is created */
+  GjkCache cache;
 } ColAux;
 
 // frees a colaux
@@ -59,12 +102,159 @@ void col_aux_free(ColAux *colaux);
 CollisionInfo find_collision(List *shape1, List *shape2);
 
 /**
- * Computes the status of the collision between two circle bodies.
+ * Computes the status of the collision between two convex polygons
+ * given as borrowed views of their vertices, e.g. from body_get_shape_view().
+ * Acts like find_collision(), but does not allocate any memory.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @return whether the shapes are colliding, and if so, the collision axis.
+ * The axis is a unit vector pointing from shape1 towards shape2.
+ */
+CollisionInfo find_collision_view(ShapeView shape1, ShapeView shape2);
+
+/**
+ * Computes the status of the collision between two convex polygons
+ * whose outward edge normals are already known, e.g. from body_get_normals().
+ * Acts like find_collision_view(), but does not recompute the normals.
+ *
+ * @param shape1 the first shape
+ * @param normals1 the edge normals of shape1, as from
+ *   polygon_view_edge_normals(), or NULL to compute them
+ * @param shape2 the second shape
+ * @param normals2 the edge normals of shape2, or NULL to compute them
+ * @return whether the shapes are colliding, and if so,
+ *   the collision axis and penetration depth.
+ * The axis is a unit vector pointing from shape1 towards shape2.
+ */
+CollisionInfo find_collision_normals(ShapeView shape1, const Vector *normals1,
+                                     ShapeView shape2, const Vector *normals2);
+
+/**
+ * Computes the status of the collision between two convex polygons with GJK,
+ * and their penetration depth with EPA.
+ * Gives the same result as find_collision_view() up to rounding,
+ * but is much faster for polygons with many vertices.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @param cache the pair's warm-start state, which is read and updated
+ * @return whether the shapes are colliding, and if so,
+ *   the collision axis and penetration depth.
+ */
+CollisionInfo find_gjk_collision(ShapeView shape1, ShapeView shape2, GjkCache *cache);
+
+/**
+ * Computes the status of the collision between the shapes of two bodies.
+ * Circle bodies are tested exactly against circles and polygons.
+ * Between polygons, uses GJK/EPA if the bodies have more than
+ * GJK_VERTEX_THRESHOLD vertices between them, and SAT with their
+ * cached edge normals otherwise.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param cache the pair's warm-start state for GJK,
+ *   or NULL if the pair is not tested repeatedly
+ * @return whether the bodies are colliding, and if so,
+ *   the collision axis and penetration depth.
+ */
+CollisionInfo find_body_collision(Body *body1, Body *body2, GjkCache *cache);
+
+/**
+ * Computes the collision between two convex polygons like
+ * find_collision_normals(), along with the points where they touch.
+ * The edge best facing the other polygon along the collision axis
+ * is the reference edge, and the other polygon's edge most facing it
+ * is the incident edge. The points are the ends of the incident edge
+ * clipped to the sides of the reference edge, which are inside
+ * the reference polygon.
+ *
+ * @param shape1 the first shape
+ * @param normals1 the edge normals of shape1, or NULL to compute them
+ * @param shape2 the second shape
+ * @param normals2 the edge normals of shape2, or NULL to compute them
+ * @return whether the shapes are colliding, and if so, the collision axis,
+ *   penetration depth, and contact points
+ */
+ContactManifold find_collision_manifold(ShapeView shape1, const Vector *normals1,
+                                        ShapeView shape2, const Vector *normals2);
+
+/**
+ * Computes the collision between the shapes of two bodies like
+ * find_body_collision(), along with the points where they touch.
+ * Polygons are clipped as in find_collision_manifold(), and a circle
+ * touches at the one point of it deepest inside the other shape.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param cache the pair's warm-start state for GJK, or NULL
+ * @return whether the bodies are colliding, and if so, the collision axis,
+ *   penetration depth, and contact points
+ */
+ContactManifold find_body_manifold(Body *body1, Body *body2, GjkCache *cache);
+
+/**
+ * Calls a collision handler if two bodies are moving towards each other
+ * and their shapes intersect (see find_body_collision()).
+ * This is the narrowphase shared by create_collision() and scene broadphases.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param handler the function to call if the bodies collide
+ * @param aux the auxiliary value to pass to the handler
+ */
+void collide_bodies(Body *body1, Body *body2, CollisionHandler handler, void *aux);
+
+/**
+ * Acts like collide_bodies(), but warm-starts GJK from a cache
+ * kept for the pair, such as the one in its ColAux.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param handler the function to call if the bodies collide
+ * @param aux the auxiliary value to pass to the handler
+ * @param cache the pair's warm-start state, which is read and updated
+ */
+void collide_bodies_cached(Body *body1, Body *body2, CollisionHandler handler, void *aux,
+                           GjkCache *cache);
+
+/**
+ * Computes the status of the collision between two circles.
+ *
+ * @param center1 the center of the first circle
+ * @param radius1 the radius of the first circle
+ * @param center2 the center of the second circle
+ * @param radius2 the radius of the second circle
+ * @return whether the circles are colliding, and if so,
+ *   the collision axis and penetration depth.
+ * The axis is a unit vector pointing from the first circle towards the second.
+ */
+CollisionInfo find_circle_collision(Vector center1, double radius1, Vector center2, double radius2);
+
+/**
+ * Computes the status of the collision between a circle and a convex polygon.
+ *
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @param polygon the polygon's vertices, in counterclockwise order
+ * @param normals the polygon's edge normals, as from
+ *   polygon_view_edge_normals(), or NULL to compute them
+ * @return whether the shapes are colliding, and if so,
+ *   the collision axis and penetration depth.
+ * The axis is a unit vector pointing from the circle towards the polygon.
+ */
+CollisionInfo find_circle_polygon_collision(Vector center, double radius,
+                                            ShapeView polygon, const Vector *normals);
+
+/**
+ * Computes the status of the collision between two bodies,
+ * treating each as a circle of radius body_get_radius() around its centroid.
  *
  * @param body1 the first body
  * @param body2 the second body
- * @return whether the bodies are colliding, and if so, the collision axis.
- * The axis should be a unit vector pointing from body1 towards body2.
+ * @return whether the bodies are colliding, and if so,
+ *   the collision axis and penetration depth.
+ * The axis is a unit vector pointing from body1 towards body2.
  */
 CollisionInfo find_circle_body_collision(Body *body1, Body *body2);
 
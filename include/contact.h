@@ -0,0 +1,157 @@
+#ifndef __CONTACT_H__
+#define __CONTACT_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "vector.h"
+#include "gjk.h"
+
+typedef struct body Body;
+
+/**
+ * The most points a contact manifold has. Two convex polygons in the plane
+ * touch along at most one edge, which is held by its two ends.
+ */
+#define MAX_MANIFOLD_POINTS 2
+
+/**
+ * One of the points where two shapes touch, as found by find_body_manifold().
+ */
+typedef struct {
+    /** Where the shapes touch, on the surface of one of them */
+    Vector point;
+    /** How far the point is inside the other shape */
+    double depth;
+    /**
+     * Which features of the shapes made the point: the reference edge
+     * and either the incident vertex or the reference vertex it was
+     * clipped at. While the shapes only slide a little, a point keeps its id
+     * from tick to tick, which lets a solver match it with the last tick's.
+     */
+    uint32_t id;
+    /**
+     * The normal impulse the scene's contact solver has pushed with at
+     * this point. The collision tests leave it zero; the scene carries it
+     * over from the last tick's point with the same id.
+     */
+    double impulse;
+} ContactPoint;
+
+/**
+ * A pair of bodies that were touching at the end of the last tick,
+ * with what the scene remembers about them between ticks.
+ * The struct is defined here so that contact listeners can read it directly.
+ */
+typedef struct contact_pair {
+    /** The bodies, in the order the pair was first found in */
+    Body *body1;
+    Body *body2;
+    /** The collision axis, a unit vector from body1 towards body2 */
+    Vector axis;
+    /** How far the bodies overlap along the axis */
+    double depth;
+    /**
+     * The normal impulse applied to separate the bodies so far,
+     * kept so that a solver can warm-start from it.
+     * The scene's contact solver sets it (see scene_add_group_solver()).
+     */
+    double normal_impulse;
+    /**
+     * The points the bodies touch at, for pairs solved by the scene's
+     * contact solver (see scene_add_group_solver()). Other pairs have none.
+     */
+    ContactPoint points[MAX_MANIFOLD_POINTS];
+    size_t num_points;
+    /** Warm-start state for GJK */
+    GjkCache cache;
+    /** The number of the last tick the bodies were touching in */
+    size_t tick;
+} ContactPair;
+
+/** What happened to a contact during a tick */
+typedef enum {
+    /** The bodies started touching */
+    CONTACT_BEGIN,
+    /** The bodies were already touching and still are */
+    CONTACT_PERSIST,
+    /** The bodies stopped touching, or one of them was removed */
+    CONTACT_END
+} ContactEvent;
+
+/**
+ * A set of contact pairs keyed by their two bodies, in either order.
+ * The pairs are kept in a dense array, which is iterated in a fixed order,
+ * with an open-addressing hash index on top of it,
+ * so finding, adding, and removing a pair are O(1) on average.
+ */
+typedef struct contact_table ContactTable;
+
+/**
+ * Allocates memory for an empty table.
+ * Asserts that the required memory was allocated.
+ *
+ * @param initial_size the number of pairs to allocate space for
+ * @return a pointer to the newly allocated table
+ */
+ContactTable *contact_table_init(size_t initial_size);
+
+/**
+ * Releases the memory allocated for a table.
+ *
+ * @param table a pointer to a table returned from contact_table_init()
+ */
+void contact_table_free(ContactTable *table);
+
+/**
+ * Gets the number of pairs in a table.
+ *
+ * @param table a pointer to a table returned from contact_table_init()
+ * @return the number of pairs
+ */
+size_t contact_table_size(ContactTable *table);
+
+/**
+ * Gets the pair at a given index of the dense array.
+ * Asserts that the index is valid.
+ * The pointer is invalidated when a pair is added or removed.
+ *
+ * @param table a pointer to a table returned from contact_table_init()
+ * @param index an index less than contact_table_size()
+ * @return the pair
+ */
+ContactPair *contact_table_get(ContactTable *table, size_t index);
+
+/**
+ * Finds the pair of two bodies.
+ * The pointer is invalidated when a pair is added or removed.
+ *
+ * @param table a pointer to a table returned from contact_table_init()
+ * @param body1 one body
+ * @param body2 the other body
+ * @return the pair, or NULL if it is not in the table
+ */
+ContactPair *contact_table_find(ContactTable *table, Body *body1, Body *body2);
+
+/**
+ * Adds a pair for two bodies that are not in the table yet, growing it if needed.
+ * The new pair has a zero axis, depth, impulse, and cache.
+ * The pointer is invalidated when a pair is added or removed.
+ *
+ * @param table a pointer to a table returned from contact_table_init()
+ * @param body1 the first body of the pair
+ * @param body2 the second body of the pair
+ * @return the new pair
+ */
+ContactPair *contact_table_add(ContactTable *table, Body *body1, Body *body2);
+
+/**
+ * Removes the pair at a given index by moving the last pair into its place.
+ * Asserts that the index is valid.
+ *
+ * @param table a pointer to a table returned from contact_table_init()
+ * @param index an index less than contact_table_size()
+ */
+void contact_table_remove(ContactTable *table, size_t index);
+
+#endif // #ifndef __CONTACT_H__
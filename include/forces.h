@@ -30,6 +30,21 @@ void create_newtonian_gravity(Scene *scene, double G, Body *body1, Body *body2);
 
 void create_wrapping_newtonian_gravity(Scene *scene, double G, Body *body1, Body *body2, Vector canvas_dimensions);
 
+/**
+ * Adds a force creator that applies Newtonian gravity between every pair
+ * of gravitating bodies in the scene (see body_set_gravitating()).
+ * Instead of one force creator per pair, the forces are computed each tick
+ * with a Barnes-Hut quadtree (see barnes_hut.h) in O(N log N).
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param theta the Barnes-Hut opening angle; 0 gives the same forces as
+ *   create_newtonian_gravity() on every pair
+ * @param min_distance distances below this are treated as this distance,
+ *   so the forces cannot approach infinity
+ */
+void create_gravity_field(Scene *scene, double G, double theta, double min_distance);
+
 /* Returns the closest displacement vector, taking into account wrapping around. */
 Vector displacement(Vector v1, Vector v2, double width, double height);
 /**
@@ -111,4 +126,30 @@ void create_physics_collision(
     Scene *scene, double elasticity, Body *body1, Body *body2
 );
 
+/**
+ * Adds a destructive collision between every body in one collision group
+ * and every body in another (see scene_add_group_collision()).
+ *
+ * @param scene the scene containing the bodies
+ * @param group1 the first group
+ * @param group2 the second group
+ */
+void create_group_destructive_collision(Scene *scene, size_t group1, size_t group2);
+
+/**
+ * Adds a physics collision between every body in one collision group
+ * and every body in another. Unlike create_physics_collision(),
+ * the contacts are solved together by the scene's contact solver
+ * (see scene_add_group_solver()), which also pushes overlapping
+ * bodies apart.
+ *
+ * @param scene the scene containing the bodies
+ * @param elasticity the "coefficient of restitution" of the collisions
+ * @param group1 the first group
+ * @param group2 the second group
+ */
+void create_group_physics_collision(
+    Scene *scene, double elasticity, size_t group1, size_t group2
+);
+
 #endif // #ifndef __FORCES_H__
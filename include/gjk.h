@@ -0,0 +1,101 @@
+#ifndef __GJK_H__
+#define __GJK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "vector.h"
+#include "shape.h"
+
+/**
+ * The Gilbert-Johnson-Keerthi (GJK) intersection test for convex shapes,
+ * and the expanding polytope algorithm (EPA) for their penetration depth.
+ * Both only see a shape through its support function, so each test costs
+ * a few support queries instead of projecting every vertex onto every axis.
+ * See https://en.wikipedia.org/wiki/Gilbert%E2%80%93Johnson%E2%80%93Keerthi_distance_algorithm.
+ */
+
+/**
+ * A function that finds the point of a convex shape farthest along a direction.
+ *
+ * @param shape the shape's data, e.g. a ShapeView *
+ * @param direction the direction to search in (not necessarily a unit vector)
+ * @param hint where the previous search on the shape ended, which the
+ *   function may start from and update; 0 if there is no previous search
+ * @return a point of the shape with the largest dot product with direction
+ */
+typedef Vector (*SupportFunc)(const void *shape, Vector direction, size_t *hint);
+
+/**
+ * A convex shape as seen by GJK: its data and its support function.
+ * Defined here instead of gjk.c because it is passed *by value*.
+ */
+typedef struct {
+    SupportFunc support;
+    const void *shape;
+} ConvexShape;
+
+/**
+ * What GJK remembers about a pair of shapes between tests.
+ * Shapes move little from one tick to the next, so starting from the last
+ * search direction usually finds a separating axis on the first query,
+ * and starting each support search where the last one ended makes it
+ * walk only a few vertices.
+ * A zeroed cache is valid and means nothing is known yet.
+ * Defined here instead of gjk.c because it is stored *by value* in ColAux.
+ */
+typedef struct {
+    /** The last search direction, from the first shape towards the second */
+    Vector direction;
+    /** The support hint of each shape */
+    size_t hints[2];
+} GjkCache;
+
+/**
+ * The support function of a convex polygon.
+ * It walks from the hinted vertex to the farthest one along direction,
+ * which only visits a few vertices when direction changes slowly.
+ *
+ * @param polygon a ShapeView * whose vertices are in counterclockwise order
+ * @param direction the direction to search in
+ * @param hint the vertex to start from, set to the vertex found
+ * @return the vertex farthest along direction
+ */
+Vector gjk_polygon_support(const void *polygon, Vector direction, size_t *hint);
+
+/**
+ * Makes the convex shape for a polygon, using gjk_polygon_support().
+ *
+ * @param polygon a view of the polygon's vertices,
+ *   which must stay valid while the shape is used
+ * @return the convex shape
+ */
+ConvexShape gjk_polygon(const ShapeView *polygon);
+
+/**
+ * Determines whether two convex shapes intersect.
+ * Shapes that only touch may be reported either way.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @param cache the pair's cache, which is read and updated
+ * @return whether the shapes intersect
+ */
+bool gjk_intersect(ConvexShape shape1, ConvexShape shape2, GjkCache *cache);
+
+/**
+ * Determines whether two convex shapes intersect, and if so,
+ * finds the shortest translation of the second shape that separates them.
+ *
+ * @param shape1 the first shape
+ * @param shape2 the second shape
+ * @param cache the pair's cache, which is read and updated
+ * @param axis set to a unit vector pointing from shape1 towards shape2,
+ *   if the shapes intersect
+ * @param depth set to how far shape2 must move along axis,
+ *   if the shapes intersect
+ * @return whether the shapes intersect with a positive depth
+ */
+bool gjk_penetration(ConvexShape shape1, ConvexShape shape2, GjkCache *cache,
+                     Vector *axis, double *depth);
+
+#endif // #ifndef __GJK_H__
@@ -3,6 +3,7 @@
 
 #include "list.h"
 #include "vector.h"
+#include "shape.h"
 
 /**
  * Computes the area of a polygon.
@@ -26,6 +27,34 @@ double polygon_area(List *polygon);
  */
 Vector polygon_centroid(List *polygon);
 
+/**
+ * Computes the area of a polygon given as a borrowed view of its vertices.
+ * Acts like polygon_area(), without reading the vertices through a List.
+ *
+ * @param polygon a view of at least 3 vertices, in counterclockwise order
+ * @return the area of the polygon
+ */
+double polygon_view_area(ShapeView polygon);
+
+/**
+ * Computes the center of mass of a polygon given as a borrowed view.
+ * Acts like polygon_centroid(), without reading the vertices through a List.
+ *
+ * @param polygon a view of at least 3 vertices, in counterclockwise order
+ * @return the centroid of the polygon
+ */
+Vector polygon_view_centroid(ShapeView polygon);
+
+/**
+ * Computes the outward unit normal of each edge of a polygon.
+ * normals[i] is the normal of the edge from vertex i to vertex i + 1,
+ * and the last one is the normal of the edge from the last vertex to the first.
+ *
+ * @param polygon a view of at least 3 vertices, in counterclockwise order
+ * @param normals an array with space for polygon.size normals
+ */
+void polygon_view_edge_normals(ShapeView polygon, Vector *normals);
+
 /**
  * Translates all vertices in a polygon by a given vector.
  * Note: mutates the original polygon.
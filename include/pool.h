@@ -0,0 +1,68 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * An allocator for many blocks of the same size.
+ * Blocks are carved out of large chunks and released blocks are reused,
+ * so allocating and releasing a block never calls malloc() or free()
+ * once the pool has grown to its high-water mark.
+ * Freeing the pool releases every block at once.
+ */
+typedef struct pool Pool;
+
+/**
+ * Allocates memory for an empty pool.
+ * Asserts that the required memory was allocated.
+ *
+ * @param block_size the size in bytes of each block
+ * @param chunk_blocks the number of blocks to allocate at a time
+ * @param fixed if true, the pool allocates chunk_blocks blocks now and never grows
+ * @return the new pool
+ */
+Pool *pool_init(size_t block_size, size_t chunk_blocks, bool fixed);
+
+/**
+ * Releases the memory allocated for a pool, including every block in it.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ */
+void pool_free(Pool *pool);
+
+/**
+ * Gets a block from a pool.
+ * The block is aligned for any type and its contents are undefined.
+ * Asserts that a fixed pool still has a free block.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return a block of the pool's block size
+ */
+void *pool_alloc(Pool *pool);
+
+/**
+ * Gives a block back to the pool it came from.
+ * This is a FreeFunc, so pooled values can be freed like malloc()ed ones.
+ *
+ * @param block a block returned from pool_alloc(), or NULL
+ */
+void pool_release(void *block);
+
+/**
+ * Gets the number of blocks allocated from a pool and not yet released.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the number of blocks in use
+ */
+size_t pool_used(Pool *pool);
+
+/**
+ * Gets the size of the blocks in a pool.
+ *
+ * @param pool a pointer to a pool returned from pool_init()
+ * @return the block size passed to pool_init()
+ */
+size_t pool_block_size(Pool *pool);
+
+#endif // #ifndef __POOL_H__
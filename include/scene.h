@@ -7,6 +7,10 @@
 #include "body.h"
 #include "list.h"
 #include "camera.h"
+#include "collision.h"
+#include "contact.h"
+#include "solver.h"
+#include "pool.h"
 
 /**
  * A collection of bodies and force creators.
@@ -23,32 +27,57 @@ typedef struct scene Scene;
 typedef void (*ForceCreator)(void *aux);
 
 /**
- * A struct that packages a force creator and its associated bodies.
- * Contains a force creator and two associated bodies, which may be
- * null if the force creator acts on <2 bodies.
+ * A function called when two bodies in groups with a contact listener
+ * start touching, keep touching, or stop touching.
+ * The contact may be read, and its normal_impulse set, until the listener returns.
+ * Like a CollisionHandler, a listener may mark either body for removal.
+ *
+ * @param event what happened to the contact this tick
+ * @param body1 the body in the listener's first group
+ * @param body2 the body in the listener's second group
+ * @param contact the scene's record of the pair; its axis points
+ *   from contact->body1 to contact->body2, which may be body2 and body1
+ * @param aux the auxiliary value passed to scene_add_group_contact_listener()
  */
-typedef struct force_object ForceObj;
+typedef void (*ContactListener)(ContactEvent event, Body *body1, Body *body2,
+                                ContactPair *contact, void *aux);
 
 /**
- * Initializes a ForceObj with the given force creator and bodies.
- *
- * @param f the force creators
- * @param b1 one body to which the force creator is applied
- * @param b2 the second body (may be null)
- * @return the force object
+ * The schemes a scene can move its bodies by in each tick (or substep).
+ * Each runs the force creators once per substep except where noted.
  */
-ForceObj *forceobj_init(ForceCreator f, Body *b1, Body *b2);
+typedef enum {
+    /** Adds the force to the velocity, then moves by the average of the old
+        and new velocities. The default; it is not symplectic, so orbits
+        and springs gain or lose energy unless dt is tiny. */
+    INTEGRATOR_TRAPEZOID,
+    /** Adds the force to the velocity, then moves by the new velocity.
+        Symplectic, so energy stays bounded, but only first-order accurate. */
+    INTEGRATOR_SEMI_IMPLICIT_EULER,
+    /** Velocity Verlet (leapfrog): half a kick, a move, then half a kick
+        with the forces at the new positions. Symplectic and second-order,
+        so it suits gravity; it runs the force creators once more per tick. */
+    INTEGRATOR_VERLET,
+    /** Classical fourth-order Runge-Kutta, which runs the force creators
+        four times per substep. The most accurate for smooth forces of
+        position, but not symplectic. */
+    INTEGRATOR_RK4
+} IntegratorType;
+
+/* The number of constants a ForceParams can hold */
+#define FORCE_PARAMS_CONSTANTS 6
 
 /**
- * Sets either assoc_body1 or assoc_body2 of a force creator to
- * be a given body. Which body is set is given in bodynum.
- *
- * @param f the force creator to be changed
- * @param b the body to be added to the force creator
- * @param bodynum which body the new body will replace. 1 for
- *        assoc_body1, 2 for assoc_body2
+ * The parameters of a force creator, stored inline in the scene's record
+ * of the force creator instead of behind a separately allocated aux.
+ * The bodies and constants fit in one 64-byte cache line.
+ * Defined here instead of scene.c because it is passed *by value*.
  */
-void forceobj_setbody(ForceObj *f, Body *b, size_t bodynum);
+typedef struct {
+    /** The bodies the force acts on; unused bodies are NULL */
+    Body *bodies[2];
+    double constants[FORCE_PARAMS_CONSTANTS];
+} ForceParams;
 
 /**
  * Allocates memory for an empty scene.
@@ -59,6 +88,32 @@ void forceobj_setbody(ForceObj *f, Body *b, size_t bodynum);
  */
 Scene *scene_init(void);
 
+/**
+ * Allocates memory for an empty scene with a fixed capacity.
+ * The storage that scales with its bodies and forces is allocated up front:
+ * the slots of its moving and static bodies, its force creators, the pools
+ * for scene_alloc_aux(), the scratch space for scene_scratch(), and the
+ * integrator's and sleep's per-body arrays once they are enabled.
+ * Instead of growing, the scene asserts that each limit is not exceeded,
+ * so its force creators and per-body bookkeeping make no heap calls
+ * during a tick.
+ * Bodies removed during a tick give up their slots at once, but are only
+ * freed, which calls free() on their shapes and themselves, once the rest
+ * of the tick is done.
+ * The number of touching pairs is not bounded by the number of bodies,
+ * so the broadphase, its candidate pairs and the contact table can still
+ * grow; the pairs and contacts start with room for max_bodies of each.
+ * All of them keep their memory, so they stop allocating once the scene
+ * has seen its most crowded tick.
+ *
+ * @param max_bodies the most bodies the scene can hold at once
+ * @param max_forces the most force creators the scene can hold at once,
+ *   and the most values of each size scene_alloc_aux() can hand out
+ * @param scratch_size the bytes of scratch space each thread gets per tick
+ * @return the new scene
+ */
+Scene *scene_init_fixed(size_t max_bodies, size_t max_forces, size_t scratch_size);
+
 /**
  * Releases memory allocated for a given scene
  * and all the bodies and force creators it contains.
@@ -108,6 +163,7 @@ List *scene_textures_list(Scene *scene);
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @return the number of bodies added with scene_add_body()
+ *   or scene_add_static_body()
  */
 size_t scene_bodies(Scene *scene);
 
@@ -139,10 +195,25 @@ Camera *scene_get_camera(Scene *scene);
  */
 void scene_add_body(Scene *scene, Body *body);
 
+/**
+ * Adds a static body, such as a wall or a peg, to a scene.
+ * Static bodies are never integrated and ignore forces and impulses,
+ * so they stay where they are put. They are kept in their own broadphase,
+ * which is rebuilt only when a static body is moved or removed, and which
+ * is only searched for the moving bodies touching them; two static bodies
+ * are never tested against each other.
+ * Asserts that the body has infinite mass.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body a pointer to the body to add to the scene
+ */
+void scene_add_static_body(Scene *scene, Body *body);
+
 /**
  * @deprecated Use body_remove() instead
  *
- * Removes and frees the body at a given index from a scene.
+ * Removes and frees the body at a given index from a scene,
+ * along with the force creators that depend on it.
  * Asserts that the index is valid.
  *
  * @param scene a pointer to a scene returned from scene_init()
@@ -164,11 +235,14 @@ void scene_add_force_creator(
  * The auxiliary value is passed to the force creator each time it is called.
  * The force creator is registered with a list of bodies it applies to,
  * so it can be removed when any one of the bodies is removed.
+ * Each body remembers the force creators registered with it,
+ * so removing a body only costs as much as its own force creators.
+ * The scene does not keep the list of bodies, so it can be freed afterwards.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param forcer a force creator function
  * @param aux an auxiliary value to pass to forcer when it is called
- * @param bodies the list of bodies affected by the force creator.
+ * @param bodies the list of at most 2 bodies affected by the force creator.
  *   The force creator will be removed if any of these bodies are removed.
  *   This list does not own the bodies, so its freer should be NULL.
  * @param freer if non-NULL, a function to call in order to free aux
@@ -177,10 +251,346 @@ void scene_add_bodies_force_creator(
     Scene *scene, ForceCreator forcer, void *aux, List *bodies, FreeFunc freer
 );
 
+/**
+ * Adds a force creator whose parameters are stored inline in the scene.
+ * Each time the force creator is invoked, its aux is a pointer to a
+ * ForceParams holding the given parameters. The pointer is only valid
+ * during that call, since the scene moves its records as forces are removed.
+ * The force creator is removed when any of the non-NULL bodies is removed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function
+ * @param params the bodies the force acts on and its constants
+ */
+void scene_add_force_params(Scene *scene, ForceCreator forcer, ForceParams params);
+
+/**
+ * Applies a batch of forces of the same kind in one pass,
+ * instead of calling a force creator once per force.
+ * Like a force creator, it may only add forces and impulses to bodies.
+ *
+ * @param params the bodies and constants of each force
+ * @param auxes the auxiliary value of each force, which may be NULL
+ * @param count the number of forces in the batch
+ */
+typedef void (*ForceKernel)(const ForceParams *params, void *const *auxes, size_t count);
+
+/**
+ * Adds a force that is applied together with all the scene's other forces
+ * that use the same kernel. Forces are grouped by kernel and stored packed,
+ * so a scene with thousands of springs runs one loop over their parameters.
+ * A scene can use up to 15 different kernels.
+ * The force is removed when any of the non-NULL bodies is removed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param kernel the function that applies every force of this kind
+ * @param params the bodies the force acts on and its constants
+ * @param aux an auxiliary value passed to the kernel with the force, or NULL
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_batched_force(Scene *scene, ForceKernel kernel, ForceParams params,
+                             void *aux, FreeFunc freer);
+
+/**
+ * Like scene_add_batched_force(), but for a kernel that only adds impulses
+ * or otherwise acts once per event, such as one that calls collision handlers.
+ * Its forces run once per tick, before the first substep, and are skipped
+ * when the integrator evaluates the forces again (see scene_set_integrator()).
+ * A kernel must always be added the same way.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param kernel the function that applies every force of this kind
+ * @param params the bodies the force acts on and its constants
+ * @param aux an auxiliary value passed to the kernel with the force, or NULL
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_batched_impulse(Scene *scene, ForceKernel kernel, ForceParams params,
+                               void *aux, FreeFunc freer);
+
+/**
+ * Where a slot kernel finds one of a force's bodies.
+ */
+typedef struct {
+    /** 0 for the scene's moving bodies, 1 for its static bodies */
+    size_t store;
+    /** The body's slot in that store (see BodyStore) */
+    size_t slot;
+} BodySlot;
+
+/**
+ * The arrays of one of a scene's body stores that a slot kernel uses,
+ * indexed by slot.
+ */
+typedef struct {
+    const Vector *position;
+    const Vector *velocity;
+    /** 1 / mass, or 0 for infinite mass */
+    const double *inv_mass;
+    /**
+     * Where the kernel adds forces: the store's own forces, or a buffer
+     * of the thread running it. Forces added to static bodies are discarded.
+     */
+    Vector *force;
+} ForceStore;
+
+/**
+ * Applies a batch of forces of the same kind by reading and writing
+ * the scene's body stores by slot, instead of going through each Body.
+ * The scene looks up the slots of each batch's bodies beforehand, so the
+ * kernel's loop is only arithmetic on packed parameters and indexed loads,
+ * which the compiler can vectorize. It may only add forces.
+ *
+ * @param params the bodies and constants of each force
+ * @param slots where each force's bodies are: slots[2 * i + k] for
+ *   params[i].bodies[k], left unspecified when that body is NULL
+ * @param count the number of forces in the batch
+ * @param stores the scene's moving bodies, then its static bodies
+ */
+typedef void (*SlotKernel)(const ForceParams *params, const BodySlot *slots, size_t count,
+                           const ForceStore *stores);
+
+/**
+ * Adds a force that is applied together with all the scene's other forces
+ * that use the same slot kernel (see scene_add_batched_force()).
+ * Slot kernels count towards the same limit of 15 kernels.
+ * The force is removed when any of the non-NULL bodies is removed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param kernel the function that applies every force of this kind
+ * @param params the bodies the force acts on and its constants
+ */
+void scene_add_slot_force(Scene *scene, SlotKernel kernel, ForceParams params);
+
+/**
+ * Gets the number of force creators and batched forces in a scene.
+ * Forces are not kept in the order they were added.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of force creators that have not been removed
+ */
+size_t scene_forces(Scene *scene);
+
+/**
+ * Allocates an auxiliary value for a force creator or collision rule
+ * from one of the scene's fixed-size pools, instead of with malloc().
+ * The value is released with pool_release(), which is a FreeFunc and so can be
+ * the value's freer. The pools are freed at once after the scene's
+ * force creators and collision rules.
+ * Asserts that the size is at most 128 bytes.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param size the size of the value in bytes
+ * @return the uninitialized value
+ */
+void *scene_alloc_aux(Scene *scene, size_t size);
+
+/**
+ * Allocates temporary memory for a force creator from the scratch arena
+ * of the thread running it. The memory is valid until the next tick starts,
+ * and does not need to be freed. Memory taken while the integrator evaluates
+ * the forces again partway through a tick is only valid until that
+ * evaluation ends, so a tick needs at most two evaluations' worth.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param size the number of bytes to allocate
+ * @return the uninitialized memory
+ */
+void *scene_scratch(Scene *scene, size_t size);
+
+/**
+ * Adds a rule that checks every body in one collision group for collisions
+ * with every body in another, or with the others in the same group.
+ * Instead of one force creator per pair, the scene finds the pairs that
+ * may be touching each tick with a broadphase and only runs
+ * the collision test (see collide_bodies()) on those.
+ * Bodies are put in groups with body_set_collision_group().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param group1 the group of the bodies passed as body1 to the handler
+ * @param group2 the group of the bodies passed as body2 to the handler
+ * @param handler the function to call when two such bodies collide
+ * @param aux the auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_group_collision(
+    Scene *scene, size_t group1, size_t group2,
+    CollisionHandler handler, void *aux, FreeFunc freer
+);
+
+/**
+ * Adds a listener for contacts between bodies in two collision groups.
+ * The scene remembers which pairs of grouped bodies are touching between ticks,
+ * so each pair is tested once per tick however many rules apply to it,
+ * and the test starts from what the last one found.
+ * The listener gets CONTACT_BEGIN on the first tick a pair touches,
+ * CONTACT_PERSIST on each later tick it still touches,
+ * and CONTACT_END on the first tick it doesn't, or when either body is removed.
+ * Unlike a CollisionHandler, it is called whichever way the bodies are moving.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param group1 the group of the bodies passed as body1 to the listener
+ * @param group2 the group of the bodies passed as body2 to the listener
+ * @param listener the function to call on each contact event
+ * @param aux the auxiliary value to pass to the listener
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_group_contact_listener(
+    Scene *scene, size_t group1, size_t group2,
+    ContactListener listener, void *aux, FreeFunc freer
+);
+
+/**
+ * Makes bodies in two collision groups push each other apart
+ * through the scene's contact solver. Each tick, after the group
+ * collisions are found, the solver gathers every such contact and
+ * finds the impulses that separate them all at once (see solver.h),
+ * starting from the impulses it found for them the tick before.
+ * This keeps piles of bodies from sinking into each other,
+ * which handling each contact on its own cannot do.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param group1 one group
+ * @param group2 the other group, which may be the same
+ * @param elasticity the "coefficient of restitution" of the contacts;
+ *   0 is perfectly inelastic and 1 is perfectly elastic
+ */
+void scene_add_group_solver(Scene *scene, size_t group1, size_t group2, double elasticity);
+
+/**
+ * Sets how many times the contact solver sweeps over the contacts
+ * each tick. More sweeps settle taller piles. Scenes start with
+ * SOLVER_ITERATIONS.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param iterations the number of sweeps
+ */
+void scene_set_solver_iterations(Scene *scene, size_t iterations);
+
+/**
+ * Gets the number of pairs of grouped bodies that were touching
+ * at the end of the last tick.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of contacts
+ */
+size_t scene_contacts(Scene *scene);
+
+/**
+ * Gets one of the contacts from the last tick.
+ * Asserts that the index is valid.
+ * The pointer is valid until the next tick, or until a body is removed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index an index less than scene_contacts()
+ * @return the contact
+ */
+ContactPair *scene_get_contact(Scene *scene, size_t index);
+
+/**
+ * Finds the contact between two bodies, in either order, from the last tick.
+ * The pointer is valid until the next tick, or until a body is removed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 one body
+ * @param body2 the other body
+ * @return the contact, or NULL if the bodies were not touching
+ */
+ContactPair *scene_find_contact(Scene *scene, Body *body1, Body *body2);
+
+/**
+ * Chooses how the scene finds the pairs of bodies that may be colliding
+ * for the rules added with scene_add_group_collision().
+ * Scenes use BROADPHASE_GRID by default. Which is faster depends on the scene;
+ * BROADPHASE_SWEEP suits scenes where bodies move slowly relative to their size,
+ * and BROADPHASE_TREE suits scenes with bodies of very different sizes.
+ * Every broadphase finds the same pairs, in the same order.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param type the broadphase to use from the next tick on
+ */
+void scene_set_broadphase(Scene *scene, BroadphaseType type);
+
+/**
+ * Chooses how the scene moves its bodies, and into how many substeps
+ * each tick is split. Collisions are handled once per tick, before the first
+ * substep; the force creators are run again for each later force evaluation,
+ * and the impulses they add then are discarded so that they act once per tick.
+ * Kernels added with scene_add_batched_impulse(), such as create_collision()'s,
+ * are not run again.
+ * Scenes use INTEGRATOR_TRAPEZOID with 1 substep by default.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param type the integrator
+ * @param substeps the number of equal substeps per tick, at least 1
+ */
+void scene_set_integrator(Scene *scene, IntegratorType type, size_t substeps);
+
+/**
+ * Lets bodies in the scene fall asleep once they have been still for a while.
+ * A body is still while its speed is below a threshold, and so is
+ * the net force on it, counting impulses as force over the tick.
+ * Bodies that touch or share a force creator form an island, which falls
+ * asleep once every body in it has been still for the given time.
+ * Sleeping bodies are not integrated, are not tested for collisions against
+ * other bodies that cannot move them, and have their forces discarded.
+ * A sleeping body's island wakes when an awake body touches it, when an
+ * impulse is applied to it, or when body_wake() or body_set_velocity() is called.
+ * Bodies with infinite mass sleep on their own and are only woken explicitly.
+ * Sleep is disabled by default.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param velocity the speed below which a body is still
+ * @param force the net force below which a body is still
+ * @param time the seconds a whole island must be still before it sleeps,
+ *   or INFINITY to disable sleep and wake every body
+ */
+void scene_set_sleep(Scene *scene, double velocity, double force, double time);
+
+/**
+ * Gets the number of bodies in the scene that are awake.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of awake bodies
+ */
+size_t scene_awake_bodies(Scene *scene);
+
+/**
+ * Sets how many threads the scene ticks on. Scenes use 1 thread by default.
+ * With more threads, the force creators are split into contiguous runs,
+ * one per thread, and the bodies are integrated in parallel.
+ * Each thread's forces and impulses are summed into the bodies in thread order,
+ * so a tick gives bitwise identical results for the same number of threads.
+ *
+ * While running on several threads, a force creator may only read bodies
+ * and call body_add_force(), body_add_impulse(), and body_remove() on them;
+ * it must not add or remove forces or bodies, or set a body's state.
+ * body_get_force() and body_get_impulse() do not see forces added by
+ * other force creators during the tick.
+ * Group collisions always run on the calling thread.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param num_threads the number of threads to use, including the caller
+ */
+void scene_set_threads(Scene *scene, size_t num_threads);
+
+/**
+ * Gets how many threads the scene ticks on.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of threads, including the caller
+ */
+size_t scene_get_threads(Scene *scene);
+
 /**
  * Executes a tick of a given scene over a small time interval.
- * This requires executing all the force creators
+ * This requires executing all the force creators and group collisions
  * and then ticking each body (see body_tick()).
+ * Contacts between groups with a solver rule are solved together
+ * before the bodies are ticked (see scene_add_group_solver()).
+ * Bullets (see body_set_bullet()) are then swept against the bodies
+ * they have group collisions with, and stopped at the first they hit.
+ * A bullet that hits a body is swept again over the rest of the tick,
+ * so it can stop at up to a few bodies per tick.
  * If any bodies are marked for removal, they should be removed from the scene
  * and freed, along with any force creators acting on them.
  *
@@ -189,4 +599,39 @@ void scene_add_bodies_force_creator(
  */
 void scene_tick(Scene *scene, double dt);
 
+/**
+ * Sets the fixed timestep that scene_step_fixed() ticks the scene with.
+ * Scenes step at 1/60 of a second, at most 8 times per frame, by default.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param dt the length of each tick, in seconds
+ * @param max_steps the most ticks to run per frame; time beyond that is
+ *   dropped, so a slow frame cannot make the next frame slower still
+ */
+void scene_set_fixed_step(Scene *scene, double dt, size_t max_steps);
+
+/**
+ * Advances a scene by the time a frame took, in ticks of the fixed timestep.
+ * The time left over, less than one tick, is kept for the next frame,
+ * so the scene is ticked at the same rate whatever the frame rate is.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param frame_dt the time elapsed since the last frame, in seconds
+ * @return the number of ticks run
+ */
+size_t scene_step_fixed(Scene *scene, double frame_dt);
+
+/**
+ * Gets how far the time kept by scene_step_fixed() is into the next tick,
+ * as a fraction of the fixed timestep. Drawing each body at
+ * body_get_interpolated_centroid() with this fraction makes motion smooth
+ * even when the scene ticks less often than it is drawn.
+ * Is 1 for a scene that has not been stepped with scene_step_fixed(),
+ * so that bodies are drawn where they are.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the fraction, from 0 to 1
+ */
+double scene_step_alpha(Scene *scene);
+
 #endif // #ifndef __SCENE_H__
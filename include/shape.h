@@ -0,0 +1,169 @@
+#ifndef __SHAPE_H__
+#define __SHAPE_H__
+
+#include <stddef.h>
+#include "list.h"
+#include "vector.h"
+
+/**
+ * A polygon whose vertices are stored by value in one contiguous array.
+ * Unlike a List of Vector pointers, a Shape can be translated and rotated
+ * in place without allocating, and its vertices can be read as a Vector[].
+ * The array automatically grows when more capacity is needed.
+ */
+typedef struct shape Shape;
+
+/**
+ * A read-only view of a polygon's vertices that borrows them from their owner.
+ * Taking a view does not allocate or copy, and a view is never freed.
+ * It is only valid until its owner's vertices change or are freed.
+ */
+typedef struct {
+    /** The first of size contiguous vertices, in counterclockwise order */
+    const Vector *vertices;
+    size_t size;
+} ShapeView;
+
+/**
+ * Allocates memory for a new shape with space for the given number of vertices.
+ * The shape is initially empty.
+ * Asserts that the required memory was allocated.
+ *
+ * @param initial_size the number of vertices to allocate space for
+ * @return a pointer to the newly allocated shape
+ */
+Shape *shape_init(size_t initial_size);
+
+/**
+ * Creates a shape with the same vertices as a list of vectors.
+ * The list is not modified and must still be list_free()d.
+ *
+ * @param polygon a list of Vector pointers
+ * @return a pointer to the newly allocated shape
+ */
+Shape *shape_from_list(List *polygon);
+
+/**
+ * Creates a list of newly allocated vectors with the vertices of a shape.
+ * The list must be list_free()d.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @return a list of Vector pointers
+ */
+List *shape_to_list(Shape *shape);
+
+/**
+ * Creates a copy of a shape.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @return a pointer to the newly allocated copy
+ */
+Shape *shape_copy(Shape *shape);
+
+/**
+ * Releases the memory allocated for a shape.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ */
+void shape_free(Shape *shape);
+
+/**
+ * Gets the number of vertices in a shape.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @return the number of vertices
+ */
+size_t shape_size(Shape *shape);
+
+/**
+ * Gets the number of vertices a shape has space for.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @return the capacity of the shape
+ */
+size_t shape_capacity(Shape *shape);
+
+/**
+ * Gets the vertex at a given index in a shape.
+ * Asserts that the index is valid.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @param index an index in the shape (the first vertex is at 0)
+ * @return the vertex at the given index
+ */
+Vector shape_get(Shape *shape, size_t index);
+
+/**
+ * Changes the vertex at a given index.
+ * Asserts that the index is valid.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @param index the index at which to set the vertex
+ * @param vertex the new vertex
+ */
+void shape_set(Shape *shape, size_t index, Vector vertex);
+
+/**
+ * Appends a vertex to the end of a shape, growing it if it is full.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @param vertex the vertex to add
+ */
+void shape_add(Shape *shape, Vector vertex);
+
+/**
+ * Gets the array of vertices of a shape.
+ * The pointer is invalidated if vertices are added to the shape.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @return the first of shape_size() contiguous vertices
+ */
+Vector *shape_vertices(Shape *shape);
+
+/**
+ * Gets a borrowed view of the vertices of a shape.
+ * The view is invalidated if vertices are added to the shape.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @return a view of the shape's vertices
+ */
+ShapeView shape_view(Shape *shape);
+
+/**
+ * Computes the area of a shape.
+ * See https://en.wikipedia.org/wiki/Shoelace_formula#Statement.
+ *
+ * @param shape a shape with at least 3 vertices, in counterclockwise order
+ * @return the area of the shape
+ */
+double shape_area(Shape *shape);
+
+/**
+ * Computes the center of mass of a shape.
+ * See https://en.wikipedia.org/wiki/Centroid#Of_a_polygon.
+ *
+ * @param shape a shape with at least 3 vertices, in counterclockwise order
+ * @return the centroid of the shape
+ */
+Vector shape_centroid(Shape *shape);
+
+/**
+ * Translates all vertices in a shape by a given vector, in place.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @param translation the vector to add to each vertex's position
+ */
+void shape_translate(Shape *shape, Vector translation);
+
+/**
+ * Rotates all vertices in a shape by a given angle about a given point,
+ * in place.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ * @param angle the angle to rotate the shape, in radians.
+ * A positive angle means counterclockwise.
+ * @param point the point to rotate around
+ */
+void shape_rotate(Shape *shape, double angle, Vector point);
+
+#endif // #ifndef __SHAPE_H__
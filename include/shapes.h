@@ -6,6 +6,7 @@
 #include <stddef.h>
 #include "list.h"
 #include "polygon.h"
+#include "shape.h"
 
 /**
  *  Makes a pacman-esque shape which is basically a 360-gon with a chunk cut out
@@ -53,4 +54,31 @@ List *make_n_star(int points, double radius);
 /* Makes a section of a circle. */
 List *make_rounded_paddle(int sides, double radius, double angle);
 
+/*
+ * The shape_* constructors build the same polygons as the make_* functions
+ * above, but return a Shape with contiguous vertex storage.
+ * The make_* functions are thin wrappers that copy these into a List.
+ */
+Shape *shape_square(double side);
+
+Shape *shape_rectangle(double height, double length);
+
+Shape *shape_pacman(double radius);
+
+Shape *shape_ship(int detail, double height, double width);
+
+Shape *shape_ngon(int sides, double radius);
+
+Shape *shape_n_star(int points, double radius);
+
+Shape *shape_rounded_paddle(int sides, double radius, double angle);
+
+/**
+ * Copies a shape into a newly allocated list of vectors and frees the shape.
+ *
+ * @param shape the shape to convert
+ * @return a List representing the shape
+ */
+List *shape_into_list(Shape *shape);
+
 #endif
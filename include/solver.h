@@ -0,0 +1,108 @@
+#ifndef __SOLVER_H__
+#define __SOLVER_H__
+
+#include <stddef.h>
+#include "vector.h"
+
+/**
+ * A sequential-impulse contact solver. Instead of resolving each contact
+ * on its own with one impulse, it sweeps over all of them several times,
+ * each time correcting every contact's impulse for what the others did
+ * to its bodies. The impulse each contact has pushed with so far is kept
+ * and clamped to never pull, so the sweeps converge on the impulses
+ * that keep the whole pile apart.
+ * See Erin Catto, "Iterative Dynamics with Temporal Coherence" (2005).
+ */
+
+/** The number of sweeps over the contacts a scene makes by default */
+#define SOLVER_ITERATIONS 8
+
+/**
+ * The fraction of the overlap of each contact that Baumgarte stabilization
+ * pushes its bodies apart by per tick. Larger values remove overlap faster,
+ * but make resting bodies jitter.
+ */
+#define SOLVER_BAUMGARTE 0.2
+
+/**
+ * How far bodies may overlap before Baumgarte stabilization pushes them
+ * apart, so that resting contacts stay touching from one tick to the next.
+ */
+#define SOLVER_SLOP 0.01
+
+/**
+ * A body as the solver sees it.
+ */
+typedef struct {
+    /**
+     * The velocity the body will end the tick with, counting its forces
+     * and impulses, which the solver changes by the contacts' impulses
+     */
+    Vector velocity;
+    /** The velocity the body started the tick with, which restitution reflects */
+    Vector incoming;
+    /** 1 / mass, or 0 for bodies that cannot be moved */
+    double inv_mass;
+} SolverBody;
+
+/**
+ * A contact between two bodies, pushing them apart along its normal.
+ */
+typedef struct {
+    /** The indices of the bodies in the solver's body array */
+    size_t body1;
+    size_t body2;
+    /** The unit collision axis, from body1 towards body2 */
+    Vector normal;
+    /** How far the bodies overlap along the normal */
+    double depth;
+    /** The coefficient of restitution, from 0 (inelastic) to 1 (elastic) */
+    double elasticity;
+    /**
+     * The normal impulse pushing the bodies apart so far. It starts at
+     * the contact's impulse from the last tick, which warm-starts the solver,
+     * and is the contact's total impulse once the solver is done.
+     */
+    double impulse;
+    /** The separating velocity the contact aims for, set by solver_prepare() */
+    double target;
+    /** The contact's effective mass along its normal, set by solver_prepare() */
+    double mass;
+} SolverContact;
+
+/**
+ * Sets up contacts for solver_iterate(): finds the separating velocity
+ * each aims for, from restitution and Baumgarte stabilization,
+ * and applies each one's warm-start impulse to its bodies.
+ *
+ * @param bodies the bodies the contacts refer to
+ * @param contacts the contacts
+ * @param count the number of contacts
+ * @param dt the length of the tick, in seconds
+ */
+void solver_prepare(SolverBody *bodies, SolverContact *contacts, size_t count, double dt);
+
+/**
+ * Sweeps over the contacts once, in order, changing each one's impulse
+ * (and its bodies' velocities) so that its bodies separate at its target
+ * velocity, unless that would need the contact to pull them together.
+ *
+ * @param bodies the bodies the contacts refer to
+ * @param contacts the contacts, as set up by solver_prepare()
+ * @param count the number of contacts
+ */
+void solver_iterate(SolverBody *bodies, SolverContact *contacts, size_t count);
+
+/**
+ * Prepares contacts and sweeps over them a given number of times.
+ *
+ * @param bodies the bodies the contacts refer to
+ * @param contacts the contacts
+ * @param count the number of contacts
+ * @param dt the length of the tick, in seconds
+ * @param iterations the number of sweeps
+ */
+void solver_solve(SolverBody *bodies, SolverContact *contacts, size_t count, double dt,
+                  size_t iterations);
+
+#endif // #ifndef __SOLVER_H__
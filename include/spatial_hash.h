@@ -0,0 +1,85 @@
+#ifndef __SPATIAL_HASH_H__
+#define __SPATIAL_HASH_H__
+
+#include <stddef.h>
+#include "aabb.h"
+#include "broadphase.h"
+
+/**
+ * A broadphase that buckets boxes by the uniform grid cells they cover.
+ * Cells are keyed by their integer coordinates through a hash table,
+ * so the grid is unbounded and empty cells cost nothing.
+ * Only boxes that share a cell are tested against each other.
+ *
+ * The hash is rebuilt from scratch each time pairs are found:
+ * insert every box, call spatial_hash_find_pairs(), then spatial_hash_clear().
+ * Its arrays are kept between rebuilds, so steady-state use does not allocate.
+ */
+typedef struct spatial_hash SpatialHash;
+
+/**
+ * Allocates memory for an empty spatial hash.
+ * Asserts that the required memory was allocated.
+ *
+ * @param cell_size the side length of a grid cell.
+ *   If not positive, the cell size is chosen on each rebuild
+ *   from the average size of the inserted boxes.
+ * @return a pointer to the newly allocated spatial hash
+ */
+SpatialHash *spatial_hash_init(double cell_size);
+
+/**
+ * Releases the memory allocated for a spatial hash.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ */
+void spatial_hash_free(SpatialHash *hash);
+
+/**
+ * Changes the side length of a grid cell.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param cell_size the new cell size, or a non-positive value to choose it
+ *   automatically
+ */
+void spatial_hash_set_cell_size(SpatialHash *hash, double cell_size);
+
+/**
+ * Removes all boxes from a spatial hash without releasing its memory.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ */
+void spatial_hash_clear(SpatialHash *hash);
+
+/**
+ * Adds a box to a spatial hash.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param id the id to report the box by in pairs; each box needs a unique id
+ * @param box the box
+ */
+void spatial_hash_insert(SpatialHash *hash, size_t id, AABB box);
+
+/**
+ * Finds every pair of inserted boxes that overlap.
+ * Each pair is added to the buffer exactly once, in no particular order.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param pairs the buffer to add the overlapping pairs to
+ */
+void spatial_hash_find_pairs(SpatialHash *hash, PairBuffer *pairs);
+
+/**
+ * Calls a function on every inserted box that overlaps a given box.
+ * The grid built by the last spatial_hash_find_pairs() is searched,
+ * so only the cells the box covers are visited. If no boxes were
+ * inserted since, every box is tested instead.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param box the box to search
+ * @param handler the function to call with the id of each box found
+ * @param aux the auxiliary value to pass to the handler
+ */
+void spatial_hash_query(SpatialHash *hash, AABB box, BroadphaseQueryHandler handler, void *aux);
+
+#endif // #ifndef __SPATIAL_HASH_H__
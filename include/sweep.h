@@ -0,0 +1,87 @@
+#ifndef __SWEEP_H__
+#define __SWEEP_H__
+
+#include <stddef.h>
+#include "aabb.h"
+#include "broadphase.h"
+
+/**
+ * A sort-and-sweep (sweep-and-prune) broadphase.
+ * The endpoints of every box along the x-axis are kept sorted between calls.
+ * Since boxes barely move from one tick to the next, the order is repaired
+ * with an insertion sort that does close to one pass over the endpoints.
+ * A sweep over the sorted endpoints then finds the boxes that overlap
+ * along x, and those are checked along y.
+ *
+ * Each box is added once as a proxy and then moved with sweep_update().
+ */
+typedef struct sweep SweepAndPrune;
+
+/**
+ * Allocates memory for an empty sweep-and-prune broadphase.
+ * Asserts that the required memory was allocated.
+ *
+ * @return a pointer to the newly allocated broadphase
+ */
+SweepAndPrune *sweep_init(void);
+
+/**
+ * Releases the memory allocated for a sweep-and-prune broadphase.
+ *
+ * @param sweep a pointer to a broadphase returned from sweep_init()
+ */
+void sweep_free(SweepAndPrune *sweep);
+
+/**
+ * Adds a box to the broadphase.
+ *
+ * @param sweep a pointer to a broadphase returned from sweep_init()
+ * @param id the id to report the box by in pairs
+ * @param box the box
+ * @return a proxy to pass to sweep_update() and sweep_remove()
+ */
+size_t sweep_insert(SweepAndPrune *sweep, size_t id, AABB box);
+
+/**
+ * Moves a box and changes the id it is reported by.
+ * The endpoints are re-sorted in the next sweep_find_pairs().
+ *
+ * @param sweep a pointer to a broadphase returned from sweep_init()
+ * @param proxy a proxy returned from sweep_insert()
+ * @param id the id to report the box by in pairs
+ * @param box the new box
+ */
+void sweep_update(SweepAndPrune *sweep, size_t proxy, size_t id, AABB box);
+
+/**
+ * Removes a box from the broadphase. The proxy may be reused afterwards.
+ *
+ * @param sweep a pointer to a broadphase returned from sweep_init()
+ * @param proxy a proxy returned from sweep_insert()
+ */
+void sweep_remove(SweepAndPrune *sweep, size_t proxy);
+
+/**
+ * Finds every pair of boxes in the broadphase that overlap.
+ * Each pair is added to the buffer exactly once, in no particular order.
+ *
+ * @param sweep a pointer to a broadphase returned from sweep_init()
+ * @param pairs the buffer to add the overlapping pairs to
+ */
+void sweep_find_pairs(SweepAndPrune *sweep, PairBuffer *pairs);
+
+/**
+ * Calls a function on every box in the broadphase that overlaps a given box.
+ * The endpoints sorted by the last sweep_find_pairs() are searched from
+ * the given box's left edge, less the width of the widest box then,
+ * up to its right edge. Boxes added since are all tested,
+ * but boxes moved since may be missed.
+ *
+ * @param sweep a pointer to a broadphase returned from sweep_init()
+ * @param box the box to search
+ * @param handler the function to call with the id of each box found
+ * @param aux the auxiliary value to pass to the handler
+ */
+void sweep_query(SweepAndPrune *sweep, AABB box, BroadphaseQueryHandler handler, void *aux);
+
+#endif // #ifndef __SWEEP_H__
@@ -42,6 +42,11 @@ bool within(double epsilon, double d1, double d2);
  */
 bool vec_within(double epsilon, Vector v1, Vector v2);
 
+/**
+ * Returns a random double between min and max, using rand().
+ */
+double rand_range(double min, double max);
+
 /**
  * Open the file 'filename', read one word into 'testname', and close the file.
  * If the file cannot be found, exit with error.
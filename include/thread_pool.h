@@ -0,0 +1,68 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <stddef.h>
+
+/**
+ * A fixed set of worker threads that run the same task together.
+ * The thread calling thread_pool_run() acts as worker 0,
+ * so a pool with one thread runs tasks without any synchronization.
+ * Workers are started once and sleep between tasks.
+ */
+typedef struct thread_pool ThreadPool;
+
+/**
+ * A task run by every worker in a pool.
+ *
+ * @param worker the index of the worker, from 0 to the number of threads - 1
+ * @param num_workers the number of threads in the pool
+ * @param aux the auxiliary value passed to thread_pool_run()
+ */
+typedef void (*ThreadTask)(size_t worker, size_t num_workers, void *aux);
+
+/**
+ * Starts a pool of worker threads.
+ * Asserts that the threads were started.
+ *
+ * @param num_threads the number of threads to run tasks on, including the caller
+ * @return a pointer to the newly allocated pool
+ */
+ThreadPool *thread_pool_init(size_t num_threads);
+
+/**
+ * Stops the workers in a pool and releases its memory.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ */
+void thread_pool_free(ThreadPool *pool);
+
+/**
+ * Gets the number of threads in a pool.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ * @return the number of threads, including the caller
+ */
+size_t thread_pool_size(ThreadPool *pool);
+
+/**
+ * Runs a task on every worker and waits for all of them to finish.
+ *
+ * @param pool a pointer to a pool returned from thread_pool_init()
+ * @param task the function each worker calls
+ * @param aux the auxiliary value to pass to the task
+ */
+void thread_pool_run(ThreadPool *pool, ThreadTask task, void *aux);
+
+/**
+ * Splits the range [0, n) into contiguous parts, one per worker.
+ * The parts only depend on n and the number of workers.
+ *
+ * @param worker the index of the worker
+ * @param num_workers the number of workers
+ * @param n the size of the range
+ * @param start set to the first index of the worker's part
+ * @param end set to one past the last index of the worker's part
+ */
+void thread_pool_split(size_t worker, size_t num_workers, size_t n, size_t *start, size_t *end);
+
+#endif // #ifndef __THREAD_POOL_H__
@@ -0,0 +1,100 @@
+#ifndef __VECTOR_BATCH_H__
+#define __VECTOR_BATCH_H__
+
+#include <stddef.h>
+#include "vector.h"
+
+/**
+ * Operations on whole arrays of vectors, such as the vertices of a shape.
+ * Each operation has SSE2 and AVX2 versions, which work on 1 or 2 vectors
+ * per instruction, and a portable scalar version.
+ * The version is chosen when the library is built: AVX2 if the compiler
+ * targets it (e.g. with -mavx2), otherwise SSE2 if available (as on every
+ * x86-64 compiler), otherwise scalar. Defining VEC_BATCH_SCALAR forces scalar.
+ * Every version performs the same arithmetic in the same order,
+ * so all of them give bitwise identical results
+ * (except that a minimum or maximum of 0 and -0 may have either sign,
+ * and that compiling with -mfma lets the scalar code fuse multiplies and adds).
+ * "make test-simd" runs the tests against the AVX2 and scalar versions,
+ * which a normal build does not use.
+ *
+ * The arrays are of Vector, with each x next to its y, because shapes,
+ * normals and the screen points are already stored that way; separate
+ * x and y arrays would mean copying every shape in and out of them.
+ * A Vector is two doubles, so one fills an SSE2 register and two fill
+ * an AVX2 one, and only the projection has to regroup lanes.
+ */
+
+/**
+ * A linear map followed by a translation, taking (x, y) to
+ * (xx * x + xy * y + offset.x, yx * x + yy * y + offset.y).
+ * Defined here instead of vector_batch.c because it is passed *by value*.
+ */
+typedef struct {
+    double xx;
+    double xy;
+    double yx;
+    double yy;
+    Vector offset;
+} BatchTransform;
+
+/**
+ * Gets the name of the version of the operations the library was built with.
+ *
+ * @return "avx2", "sse2", or "scalar"
+ */
+const char *vec_batch_backend(void);
+
+/**
+ * Makes the transform that rotates by a given angle about a given point.
+ *
+ * @param angle the angle to rotate by, in radians. Positive is counterclockwise.
+ * @param point the point to rotate around
+ * @return the rotation
+ */
+BatchTransform vec_batch_rotation(double angle, Vector point);
+
+/**
+ * Translates each vector in an array, in place.
+ *
+ * @param vectors the first of n contiguous vectors
+ * @param n the number of vectors
+ * @param translation the vector to add to each one
+ */
+void vec_batch_translate(Vector *vectors, size_t n, Vector translation);
+
+/**
+ * Applies a transform to each vector in an array.
+ * The output may be the same array as the input.
+ *
+ * @param out the first of n contiguous vectors to write the results to
+ * @param in the first of n contiguous vectors to transform
+ * @param n the number of vectors
+ * @param transform the transform to apply
+ */
+void vec_batch_transform(Vector *out, const Vector *in, size_t n, BatchTransform transform);
+
+/**
+ * Projects each vector in an array onto an axis,
+ * and finds the smallest and largest projections.
+ *
+ * @param vectors the first of n contiguous vectors, with n > 0
+ * @param n the number of vectors
+ * @param axis the axis to take the dot product with
+ * @param min set to the smallest dot product
+ * @param max set to the largest dot product
+ */
+void vec_batch_project(const Vector *vectors, size_t n, Vector axis, double *min, double *max);
+
+/**
+ * Finds the componentwise minimum and maximum of an array of vectors,
+ * i.e. the corners of their bounding box.
+ *
+ * @param vectors the first of n contiguous vectors, with n > 0
+ * @param n the number of vectors
+ * @param min set to the smallest x and y
+ * @param max set to the largest x and y
+ */
+void vec_batch_bounds(const Vector *vectors, size_t n, Vector *min, Vector *max);
+
+#endif // #ifndef __VECTOR_BATCH_H__
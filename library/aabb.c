@@ -0,0 +1,49 @@
+#include <math.h>
+#include <assert.h>
+#include "aabb.h"
+#include "vector_batch.h"
+
+AABB aabb_of_circle(Vector center, double radius) {
+    AABB box = {
+        .min = {center.x - radius, center.y - radius},
+        .max = {center.x + radius, center.y + radius}
+    };
+    return box;
+}
+
+AABB aabb_of_view(ShapeView shape) {
+    assert(shape.size > 0);
+    AABB box;
+    vec_batch_bounds(shape.vertices, shape.size, &box.min, &box.max);
+    return box;
+}
+
+bool aabb_overlap(AABB a, AABB b) {
+    return a.min.x < b.max.x && b.min.x < a.max.x
+        && a.min.y < b.max.y && b.min.y < a.max.y;
+}
+
+bool aabb_contains(AABB outer, AABB inner) {
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y
+        && inner.max.x <= outer.max.x && inner.max.y <= outer.max.y;
+}
+
+AABB aabb_union(AABB a, AABB b) {
+    AABB box = {
+        .min = {fmin(a.min.x, b.min.x), fmin(a.min.y, b.min.y)},
+        .max = {fmax(a.max.x, b.max.x), fmax(a.max.y, b.max.y)}
+    };
+    return box;
+}
+
+AABB aabb_fatten(AABB box, double margin) {
+    box.min.x -= margin;
+    box.min.y -= margin;
+    box.max.x += margin;
+    box.max.y += margin;
+    return box;
+}
+
+double aabb_perimeter(AABB box) {
+    return 2 * ((box.max.x - box.min.x) + (box.max.y - box.min.y));
+}
@@ -0,0 +1,355 @@
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "aabb_tree.h"
+
+/* When the arrays need to grow */
+#define GROWTH_FACTOR 2
+/* The index of a missing node */
+#define NULL_NODE ((size_t) -1)
+
+typedef struct {
+    /* For a leaf, the fat box; otherwise the union of the children's boxes */
+    AABB box;
+    /* For a leaf, the box it was given */
+    AABB tight;
+    size_t id;
+    size_t parent;
+    size_t child1;
+    size_t child2;
+    /* 1 for a leaf, 0 for a node that is not in use */
+    size_t height;
+} TreeNode;
+
+typedef struct aabb_tree {
+    double margin;
+    size_t root;
+    TreeNode *nodes;
+    size_t num_nodes;
+    size_t capacity;
+    /* Nodes that are not in use, linked through their parent field */
+    size_t free_list;
+    /* Scratch space for traversals */
+    size_t *stack;
+    size_t stack_capacity;
+} AABBTree;
+
+AABBTree *aabb_tree_init(double margin) {
+    AABBTree *tree = malloc(sizeof(AABBTree));
+    assert(tree != NULL);
+    tree->margin = margin;
+    tree->root = NULL_NODE;
+    tree->nodes = NULL;
+    tree->num_nodes = 0;
+    tree->capacity = 0;
+    tree->free_list = NULL_NODE;
+    tree->stack = NULL;
+    tree->stack_capacity = 0;
+    return tree;
+}
+
+void aabb_tree_free(AABBTree *tree) {
+    free(tree->nodes);
+    free(tree->stack);
+    free(tree);
+}
+
+size_t aabb_tree_allocate_node(AABBTree *tree) {
+    size_t node;
+    if (tree->free_list != NULL_NODE) {
+        node = tree->free_list;
+        tree->free_list = tree->nodes[node].parent;
+    } else {
+        if (tree->num_nodes == tree->capacity) {
+            tree->capacity = tree->capacity > 0 ? tree->capacity * GROWTH_FACTOR : 16;
+            tree->nodes = realloc(tree->nodes, tree->capacity * sizeof(TreeNode));
+            assert(tree->nodes != NULL);
+        }
+        node = tree->num_nodes++;
+    }
+    tree->nodes[node].parent = NULL_NODE;
+    tree->nodes[node].child1 = NULL_NODE;
+    tree->nodes[node].child2 = NULL_NODE;
+    tree->nodes[node].height = 1;
+    return node;
+}
+
+void aabb_tree_free_node(AABBTree *tree, size_t node) {
+    tree->nodes[node].height = 0;
+    tree->nodes[node].parent = tree->free_list;
+    tree->free_list = node;
+}
+
+bool aabb_tree_is_leaf(TreeNode *node) {
+    return node->child1 == NULL_NODE;
+}
+
+void aabb_tree_push(AABBTree *tree, size_t *size, size_t node) {
+    if (*size == tree->stack_capacity) {
+        tree->stack_capacity = tree->stack_capacity > 0 ? tree->stack_capacity * GROWTH_FACTOR : 64;
+        tree->stack = realloc(tree->stack, tree->stack_capacity * sizeof(size_t));
+        assert(tree->stack != NULL);
+    }
+    tree->stack[(*size)++] = node;
+}
+
+/* Replaces child old with child new in the parent of old, or at the root */
+void aabb_tree_replace_child(AABBTree *tree, size_t parent, size_t old, size_t new) {
+    if (parent == NULL_NODE) {
+        tree->root = new;
+    } else if (tree->nodes[parent].child1 == old) {
+        tree->nodes[parent].child1 = new;
+    } else {
+        tree->nodes[parent].child2 = new;
+    }
+}
+
+/* Recomputes the box and height of an internal node from its children */
+void aabb_tree_refit(AABBTree *tree, size_t index) {
+    TreeNode *node = &tree->nodes[index];
+    TreeNode *child1 = &tree->nodes[node->child1];
+    TreeNode *child2 = &tree->nodes[node->child2];
+    node->box = aabb_union(child1->box, child2->box);
+    node->height = 1 + (child1->height > child2->height ? child1->height : child2->height);
+}
+
+/* If one child of node a is more than one level taller than the other,
+   rotates the taller child up to take a's place.
+   Returns the index of the node now in a's place. */
+size_t aabb_tree_balance(AABBTree *tree, size_t a) {
+    TreeNode *nodes = tree->nodes;
+    if (aabb_tree_is_leaf(&nodes[a]) || nodes[a].height < 3) {
+        return a;
+    }
+    size_t b = nodes[a].child1, c = nodes[a].child2;
+    size_t up;
+    if (nodes[c].height > nodes[b].height + 1) {
+        up = c;
+    } else if (nodes[b].height > nodes[c].height + 1) {
+        up = b;
+    } else {
+        return a;
+    }
+
+    // up takes a's place, and a becomes a child of up
+    size_t f = nodes[up].child1, g = nodes[up].child2;
+    nodes[up].child1 = a;
+    nodes[up].parent = nodes[a].parent;
+    nodes[a].parent = up;
+    aabb_tree_replace_child(tree, nodes[up].parent, a, up);
+
+    // The taller grandchild stays under up; the shorter one replaces up under a
+    size_t keep = nodes[f].height > nodes[g].height ? f : g;
+    size_t move = keep == f ? g : f;
+    nodes[up].child2 = keep;
+    if (nodes[a].child1 == up) {
+        nodes[a].child1 = move;
+    } else {
+        nodes[a].child2 = move;
+    }
+    nodes[move].parent = a;
+    aabb_tree_refit(tree, a);
+    aabb_tree_refit(tree, up);
+    return up;
+}
+
+/* Refits and rebalances every node from index up to the root */
+void aabb_tree_fix_upwards(AABBTree *tree, size_t index) {
+    while (index != NULL_NODE) {
+        index = aabb_tree_balance(tree, index);
+        aabb_tree_refit(tree, index);
+        index = tree->nodes[index].parent;
+    }
+}
+
+/* The increase in perimeter from adding box to node, plus, for an internal
+   node, the perimeter it already has, as a lower bound on going deeper */
+double aabb_tree_descend_cost(TreeNode *node, AABB box) {
+    double perimeter = aabb_perimeter(aabb_union(node->box, box));
+    if (aabb_tree_is_leaf(node)) {
+        return perimeter;
+    }
+    return perimeter - aabb_perimeter(node->box);
+}
+
+void aabb_tree_insert_leaf(AABBTree *tree, size_t leaf) {
+    if (tree->root == NULL_NODE) {
+        tree->root = leaf;
+        tree->nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Find the best sibling by the surface area heuristic (in 2D, perimeter)
+    AABB box = tree->nodes[leaf].box;
+    size_t index = tree->root;
+    while (!aabb_tree_is_leaf(&tree->nodes[index])) {
+        TreeNode *node = &tree->nodes[index];
+        double perimeter = aabb_perimeter(node->box);
+        double combined = aabb_perimeter(aabb_union(node->box, box));
+        // The cost of making a new parent for this node and the leaf
+        double cost = 2 * combined;
+        // The cost every deeper choice pays for growing this node
+        double inheritance = 2 * (combined - perimeter);
+        double cost1 = aabb_tree_descend_cost(&tree->nodes[node->child1], box) + inheritance;
+        double cost2 = aabb_tree_descend_cost(&tree->nodes[node->child2], box) + inheritance;
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = cost1 < cost2 ? node->child1 : node->child2;
+    }
+
+    size_t sibling = index;
+    size_t old_parent = tree->nodes[sibling].parent;
+    size_t new_parent = aabb_tree_allocate_node(tree);
+    TreeNode *nodes = tree->nodes;
+    nodes[new_parent].parent = old_parent;
+    nodes[new_parent].child1 = sibling;
+    nodes[new_parent].child2 = leaf;
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+    aabb_tree_replace_child(tree, old_parent, sibling, new_parent);
+    aabb_tree_fix_upwards(tree, new_parent);
+}
+
+void aabb_tree_remove_leaf(AABBTree *tree, size_t leaf) {
+    TreeNode *nodes = tree->nodes;
+    if (leaf == tree->root) {
+        tree->root = NULL_NODE;
+        return;
+    }
+    size_t parent = nodes[leaf].parent;
+    size_t grandparent = nodes[parent].parent;
+    size_t sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+    aabb_tree_replace_child(tree, grandparent, parent, sibling);
+    nodes[sibling].parent = grandparent;
+    aabb_tree_free_node(tree, parent);
+    aabb_tree_fix_upwards(tree, grandparent);
+}
+
+AABB aabb_tree_fatten(AABBTree *tree, AABB box) {
+    double side = fmax(box.max.x - box.min.x, box.max.y - box.min.y);
+    return aabb_fatten(box, tree->margin * side);
+}
+
+size_t aabb_tree_insert(AABBTree *tree, size_t id, AABB box) {
+    size_t leaf = aabb_tree_allocate_node(tree);
+    tree->nodes[leaf].tight = box;
+    tree->nodes[leaf].box = aabb_tree_fatten(tree, box);
+    tree->nodes[leaf].id = id;
+    aabb_tree_insert_leaf(tree, leaf);
+    return leaf;
+}
+
+void aabb_tree_remove(AABBTree *tree, size_t proxy) {
+    assert(proxy < tree->num_nodes && aabb_tree_is_leaf(&tree->nodes[proxy]));
+    aabb_tree_remove_leaf(tree, proxy);
+    aabb_tree_free_node(tree, proxy);
+}
+
+bool aabb_tree_move(AABBTree *tree, size_t proxy, size_t id, AABB box) {
+    assert(proxy < tree->num_nodes && aabb_tree_is_leaf(&tree->nodes[proxy]));
+    TreeNode *leaf = &tree->nodes[proxy];
+    leaf->tight = box;
+    leaf->id = id;
+    if (aabb_contains(leaf->box, box)) {
+        return false;
+    }
+    aabb_tree_remove_leaf(tree, proxy);
+    tree->nodes[proxy].box = aabb_tree_fatten(tree, box);
+    aabb_tree_insert_leaf(tree, proxy);
+    return true;
+}
+
+/* Calls handler on the leaves overlapping box, skipping leaves with index
+   at most after. Leaves are reported by index rather than id. */
+void aabb_tree_query_leaves(AABBTree *tree, AABB box, size_t after,
+                            void (*handler)(AABBTree *, size_t, void *), void *aux) {
+    if (tree->root == NULL_NODE) {
+        return;
+    }
+    size_t size = 0;
+    aabb_tree_push(tree, &size, tree->root);
+    while (size > 0) {
+        size_t index = tree->stack[--size];
+        TreeNode *node = &tree->nodes[index];
+        if (!aabb_overlap(node->box, box)) {
+            continue;
+        }
+        if (aabb_tree_is_leaf(node)) {
+            if ((after == NULL_NODE || index > after) && aabb_overlap(node->tight, box)) {
+                handler(tree, index, aux);
+            }
+        } else {
+            aabb_tree_push(tree, &size, node->child1);
+            aabb_tree_push(tree, &size, node->child2);
+        }
+    }
+}
+
+typedef struct {
+    AABBTreeQueryHandler handler;
+    void *aux;
+} TreeQuery;
+
+void aabb_tree_report_id(AABBTree *tree, size_t leaf, void *aux) {
+    TreeQuery *query = aux;
+    query->handler(tree->nodes[leaf].id, query->aux);
+}
+
+void aabb_tree_query(AABBTree *tree, AABB box, AABBTreeQueryHandler handler, void *aux) {
+    TreeQuery query = {handler, aux};
+    aabb_tree_query_leaves(tree, box, NULL_NODE, aabb_tree_report_id, &query);
+}
+
+typedef struct {
+    size_t leaf;
+    PairBuffer *pairs;
+} TreePairQuery;
+
+void aabb_tree_report_pair(AABBTree *tree, size_t leaf, void *aux) {
+    TreePairQuery *query = aux;
+    pair_buffer_add(query->pairs, tree->nodes[query->leaf].id, tree->nodes[leaf].id);
+}
+
+void aabb_tree_find_pairs(AABBTree *tree, PairBuffer *pairs) {
+    for (size_t i = 0; i < tree->num_nodes; i++) {
+        TreeNode *node = &tree->nodes[i];
+        if (node->height != 1) {
+            continue;
+        }
+        // Each pair is found from both leaves; only report it from the first
+        TreePairQuery query = {i, pairs};
+        aabb_tree_query_leaves(tree, node->tight, i, aabb_tree_report_pair, &query);
+    }
+}
+
+size_t aabb_tree_height(AABBTree *tree) {
+    return tree->root == NULL_NODE ? 0 : tree->nodes[tree->root].height;
+}
+
+void aabb_tree_validate(AABBTree *tree) {
+    if (tree->root == NULL_NODE) {
+        return;
+    }
+    assert(tree->nodes[tree->root].parent == NULL_NODE);
+    size_t size = 0;
+    aabb_tree_push(tree, &size, tree->root);
+    while (size > 0) {
+        size_t index = tree->stack[--size];
+        TreeNode *node = &tree->nodes[index];
+        if (aabb_tree_is_leaf(node)) {
+            assert(node->height == 1);
+            assert(aabb_contains(node->box, node->tight));
+            continue;
+        }
+        TreeNode *child1 = &tree->nodes[node->child1];
+        TreeNode *child2 = &tree->nodes[node->child2];
+        assert(child1->parent == index && child2->parent == index);
+        size_t height = 1 + (child1->height > child2->height ? child1->height : child2->height);
+        assert(node->height == height);
+        assert(aabb_contains(node->box, child1->box));
+        assert(aabb_contains(node->box, child2->box));
+        aabb_tree_push(tree, &size, node->child1);
+        aabb_tree_push(tree, &size, node->child2);
+    }
+}
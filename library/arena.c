@@ -0,0 +1,103 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "arena.h"
+
+/* When the arena needs to grow */
+#define GROWTH_FACTOR 2
+
+typedef struct arena_block {
+    struct arena_block *next;
+    size_t capacity;
+    size_t used;
+    max_align_t data[];
+} ArenaBlock;
+
+typedef struct arena {
+    /* The block being allocated from; older blocks follow it */
+    ArenaBlock *blocks;
+    bool fixed;
+    /* The total capacity of all blocks, including those freed by arena_rewind() */
+    size_t capacity;
+} Arena;
+
+ArenaBlock *arena_block_init(size_t capacity, ArenaBlock *next) {
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + capacity);
+    assert(block != NULL);
+    block->next = next;
+    block->capacity = capacity;
+    block->used = 0;
+    return block;
+}
+
+Arena *arena_init(size_t capacity, bool fixed) {
+    Arena *arena = malloc(sizeof(Arena));
+    assert(arena != NULL);
+    capacity = capacity > 0 ? capacity : _Alignof(max_align_t);
+    arena->blocks = arena_block_init(capacity, NULL);
+    arena->fixed = fixed;
+    arena->capacity = capacity;
+    return arena;
+}
+
+void arena_free_blocks(ArenaBlock *block) {
+    while (block != NULL) {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+void arena_free(Arena *arena) {
+    arena_free_blocks(arena->blocks);
+    free(arena);
+}
+
+void *arena_alloc(Arena *arena, size_t size) {
+    size_t align = _Alignof(max_align_t);
+    size = (size + align - 1) / align * align;
+    ArenaBlock *block = arena->blocks;
+    if (block->used + size > block->capacity) {
+        assert(!arena->fixed);
+        size_t capacity = block->capacity * GROWTH_FACTOR;
+        while (capacity < size) {
+            capacity *= GROWTH_FACTOR;
+        }
+        block = arena_block_init(capacity, block);
+        arena->blocks = block;
+        arena->capacity += capacity;
+    }
+    void *memory = (char *) block->data + block->used;
+    block->used += size;
+    return memory;
+}
+
+void arena_reset(Arena *arena) {
+    if (arena->blocks->next != NULL) {
+        arena_free_blocks(arena->blocks);
+        arena->blocks = arena_block_init(arena->capacity, NULL);
+    }
+    arena->blocks->used = 0;
+}
+
+size_t arena_used(Arena *arena) {
+    size_t used = 0;
+    for (ArenaBlock *block = arena->blocks; block != NULL; block = block->next) {
+        used += block->used;
+    }
+    return used;
+}
+
+void arena_rewind(Arena *arena, size_t used) {
+    size_t total = arena_used(arena);
+    assert(used <= total);
+    ArenaBlock *block = arena->blocks;
+    // blocks holding only later allocations are freed
+    while (block->next != NULL && total - block->used >= used) {
+        ArenaBlock *next = block->next;
+        total -= block->used;
+        free(block);
+        block = next;
+    }
+    block->used -= total - used;
+    arena->blocks = block;
+}
@@ -2,22 +2,32 @@
 #include "aux.h"
 #include "list.h"
 
+/* When the array of constants needs to grow */
+#define GROWTH_FACTOR 2
+
 typedef struct aux {
   List *bodies;
-  List *constants;
+  /* Stored by value, instead of one malloc()ed double each */
+  double *constants;
+  size_t num_constants;
+  size_t constants_capacity;
 } Aux;
 
 Aux *aux_init(size_t num_bodies, size_t num_constants){
   Aux *new_aux = malloc(sizeof(Aux));
   assert(new_aux != NULL);
   new_aux->bodies = list_init(num_bodies, NULL);
-  new_aux->constants = list_init(num_constants, free);
+  new_aux->constants_capacity = num_constants > 0 ? num_constants : 1;
+  new_aux->constants = malloc(new_aux->constants_capacity * sizeof(double));
+  assert(new_aux->constants != NULL);
+  new_aux->num_constants = 0;
   return new_aux;
 }
 
 void aux_free(Aux *aux){
   list_free(aux->bodies);
-  list_free(aux->constants);
+  free(aux->constants);
+  free(aux);
 }
 
 size_t aux_num_bodies(Aux *aux) {
@@ -25,7 +35,7 @@ size_t aux_num_bodies(Aux *aux) {
 }
 
 size_t aux_num_constants(Aux *aux) {
-  return list_size(aux->constants);
+  return aux->num_constants;
 }
 
 void aux_body_add(Aux *aux, Body *body) {
@@ -33,9 +43,12 @@ void aux_body_add(Aux *aux, Body *body) {
 }
 
 void aux_constant_add(Aux *aux, double constant) {
-  double *temp = malloc(sizeof(double));
-  *temp = constant;
-  list_add(aux->constants, temp);
+  if (aux->num_constants == aux->constants_capacity) {
+    aux->constants_capacity *= GROWTH_FACTOR;
+    aux->constants = realloc(aux->constants, aux->constants_capacity * sizeof(double));
+    assert(aux->constants != NULL);
+  }
+  aux->constants[aux->num_constants++] = constant;
 }
 
 Body *aux_get_body(Aux *aux, size_t index) {
@@ -43,5 +56,6 @@ Body *aux_get_body(Aux *aux, size_t index) {
 }
 
 double aux_get_constant(Aux *aux, size_t index) {
-  return *(double *)list_get(aux->constants, index);
+  assert(index < aux->num_constants);
+  return aux->constants[index];
 }
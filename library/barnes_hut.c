@@ -0,0 +1,235 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <math.h>
+#include <assert.h>
+#include "barnes_hut.h"
+
+/* When the arrays need to grow */
+#define GROWTH_FACTOR 2
+/* The index of a missing node or mass */
+#define NONE ((size_t) -1)
+/* Cells are not split below this depth, so that masses at the same position
+   do not split cells forever; they share a leaf instead */
+#define MAX_DEPTH 48
+
+typedef struct {
+    /* The square covered by the cell */
+    Vector center;
+    double half_size;
+    /* The total mass in the cell, and the mass-weighted sum of positions
+       (the center of mass once the build finishes) */
+    double mass;
+    Vector center_of_mass;
+    /* The children, indexed by quadrant, or NONE */
+    size_t children[4];
+    /* For a leaf, the first of its masses, linked through next; else NONE */
+    size_t first;
+    bool leaf;
+} QuadNode;
+
+typedef struct barnes_hut {
+    double theta;
+    double min_distance;
+    const Vector *positions;
+    const double *masses;
+    size_t n;
+    /* The next mass in the same leaf, or NONE */
+    size_t *next;
+    size_t next_capacity;
+    QuadNode *nodes;
+    size_t num_nodes;
+    size_t nodes_capacity;
+    /* Scratch space for traversals */
+    size_t *stack;
+    size_t stack_capacity;
+} BarnesHut;
+
+BarnesHut *barnes_hut_init(double theta, double min_distance) {
+    BarnesHut *tree = malloc(sizeof(BarnesHut));
+    assert(tree != NULL);
+    tree->theta = theta;
+    tree->min_distance = min_distance;
+    tree->positions = NULL;
+    tree->masses = NULL;
+    tree->n = 0;
+    tree->next = NULL;
+    tree->next_capacity = 0;
+    tree->nodes = NULL;
+    tree->num_nodes = 0;
+    tree->nodes_capacity = 0;
+    tree->stack = NULL;
+    tree->stack_capacity = 0;
+    return tree;
+}
+
+void barnes_hut_free(BarnesHut *tree) {
+    free(tree->next);
+    free(tree->nodes);
+    free(tree->stack);
+    free(tree);
+}
+
+size_t barnes_hut_add_node(BarnesHut *tree, Vector center, double half_size) {
+    if (tree->num_nodes == tree->nodes_capacity) {
+        tree->nodes_capacity = tree->nodes_capacity > 0 ? tree->nodes_capacity * GROWTH_FACTOR : 64;
+        tree->nodes = realloc(tree->nodes, tree->nodes_capacity * sizeof(QuadNode));
+        assert(tree->nodes != NULL);
+    }
+    QuadNode *node = &tree->nodes[tree->num_nodes];
+    node->center = center;
+    node->half_size = half_size;
+    node->mass = 0;
+    node->center_of_mass = VEC_ZERO;
+    for (size_t q = 0; q < 4; q++) {
+        node->children[q] = NONE;
+    }
+    node->first = NONE;
+    node->leaf = true;
+    return tree->num_nodes++;
+}
+
+size_t barnes_hut_quadrant(QuadNode *node, Vector position) {
+    return (position.x >= node->center.x ? 1 : 0) + (position.y >= node->center.y ? 2 : 0);
+}
+
+/* Gets the child of node in a quadrant, creating it if needed */
+size_t barnes_hut_child(BarnesHut *tree, size_t node, size_t quadrant) {
+    if (tree->nodes[node].children[quadrant] == NONE) {
+        double half = tree->nodes[node].half_size / 2;
+        Vector center = tree->nodes[node].center;
+        center.x += quadrant & 1 ? half : -half;
+        center.y += quadrant & 2 ? half : -half;
+        size_t child = barnes_hut_add_node(tree, center, half);
+        tree->nodes[node].children[quadrant] = child;
+    }
+    return tree->nodes[node].children[quadrant];
+}
+
+/* Adds mass i to the totals of a node */
+void barnes_hut_accumulate(BarnesHut *tree, size_t node, size_t i) {
+    double m = tree->masses[i];
+    Vector x = tree->positions[i];
+    tree->nodes[node].mass += m;
+    tree->nodes[node].center_of_mass.x += m * x.x;
+    tree->nodes[node].center_of_mass.y += m * x.y;
+}
+
+void barnes_hut_insert(BarnesHut *tree, size_t i) {
+    Vector x = tree->positions[i];
+    size_t node = 0;
+    for (size_t depth = 0; ; depth++) {
+        barnes_hut_accumulate(tree, node, i);
+        QuadNode *current = &tree->nodes[node];
+        if (current->leaf) {
+            if (current->first == NONE || depth == MAX_DEPTH) {
+                tree->next[i] = current->first;
+                current->first = i;
+                return;
+            }
+            // Split the leaf: its one mass moves down into a new child
+            size_t other = current->first;
+            current->first = NONE;
+            current->leaf = false;
+            size_t child = barnes_hut_child(tree, node, barnes_hut_quadrant(current, tree->positions[other]));
+            barnes_hut_accumulate(tree, child, other);
+            tree->next[other] = NONE;
+            tree->nodes[child].first = other;
+        }
+        node = barnes_hut_child(tree, node, barnes_hut_quadrant(&tree->nodes[node], x));
+    }
+}
+
+void barnes_hut_build(BarnesHut *tree, const Vector *positions, const double *masses, size_t n) {
+    tree->positions = positions;
+    tree->masses = masses;
+    tree->n = n;
+    tree->num_nodes = 0;
+    if (n == 0) {
+        return;
+    }
+    if (n > tree->next_capacity) {
+        tree->next_capacity = n;
+        tree->next = realloc(tree->next, n * sizeof(size_t));
+        assert(tree->next != NULL);
+    }
+
+    // The root is the smallest square around every mass
+    Vector min = positions[0], max = positions[0];
+    for (size_t i = 1; i < n; i++) {
+        min.x = fmin(min.x, positions[i].x);
+        min.y = fmin(min.y, positions[i].y);
+        max.x = fmax(max.x, positions[i].x);
+        max.y = fmax(max.y, positions[i].y);
+    }
+    Vector center = {(min.x + max.x) / 2, (min.y + max.y) / 2};
+    double half_size = fmax(max.x - min.x, max.y - min.y) / 2;
+    // Grow slightly so masses on the boundary are strictly inside
+    barnes_hut_add_node(tree, center, half_size * 1.0001 + 1e-9);
+
+    for (size_t i = 0; i < n; i++) {
+        barnes_hut_insert(tree, i);
+    }
+    for (size_t k = 0; k < tree->num_nodes; k++) {
+        QuadNode *node = &tree->nodes[k];
+        if (node->mass != 0) {
+            node->center_of_mass = vec_multiply(1 / node->mass, node->center_of_mass);
+        }
+    }
+}
+
+/* The field at x due to a mass m at y */
+Vector barnes_hut_pull(BarnesHut *tree, Vector x, Vector y, double m) {
+    Vector r = vec_subtract(y, x);
+    double distance = sqrt(r.x * r.x + r.y * r.y);
+    if (distance == 0) {
+        return VEC_ZERO;
+    }
+    double clamped = distance < tree->min_distance ? tree->min_distance : distance;
+    return vec_multiply(m / (distance * clamped * clamped), r);
+}
+
+void barnes_hut_push(BarnesHut *tree, size_t *size, size_t node) {
+    if (*size == tree->stack_capacity) {
+        tree->stack_capacity = tree->stack_capacity > 0 ? tree->stack_capacity * GROWTH_FACTOR : 64;
+        tree->stack = realloc(tree->stack, tree->stack_capacity * sizeof(size_t));
+        assert(tree->stack != NULL);
+    }
+    tree->stack[(*size)++] = node;
+}
+
+Vector barnes_hut_field(BarnesHut *tree, size_t index) {
+    assert(index < tree->n);
+    Vector x = tree->positions[index];
+    Vector field = VEC_ZERO;
+    size_t size = 0;
+    barnes_hut_push(tree, &size, 0);
+    while (size > 0) {
+        QuadNode *node = &tree->nodes[tree->stack[--size]];
+        if (node->mass == 0) {
+            continue;
+        }
+        if (node->leaf) {
+            for (size_t j = node->first; j != NONE; j = tree->next[j]) {
+                if (j != index) {
+                    field = vec_add(field, barnes_hut_pull(tree, x, tree->positions[j], tree->masses[j]));
+                }
+            }
+            continue;
+        }
+        // A cell containing x also contains the mass at x, so it is always opened
+        bool contains = fabs(x.x - node->center.x) <= node->half_size
+                     && fabs(x.y - node->center.y) <= node->half_size;
+        Vector r = vec_subtract(node->center_of_mass, x);
+        double distance = sqrt(r.x * r.x + r.y * r.y);
+        if (!contains && 2 * node->half_size < tree->theta * distance) {
+            field = vec_add(field, barnes_hut_pull(tree, x, node->center_of_mass, node->mass));
+            continue;
+        }
+        for (size_t q = 0; q < 4; q++) {
+            if (node->children[q] != NONE) {
+                barnes_hut_push(tree, &size, node->children[q]);
+            }
+        }
+    }
+    return field;
+}
@@ -1,62 +1,152 @@
 #include "body.h"
 #include <stdio.h>
+#include <math.h>
+#include <assert.h>
+#include "vector_batch.h"
+
+/* When the list of force handles needs to grow */
+#define GROWTH_FACTOR 2
 
 typedef struct body {
-    List *points;
+    BodyStore *store;
+    size_t index;
+    bool owns_store;
+    BodyKind kind;
+    /** The vertices relative to the centroid, with no rotation applied */
+    Shape *model;
+    /** The vertices in world space, valid while world_dirty is false */
+    Shape *world;
+    /** The centroid the world vertices were computed at */
+    Vector world_centroid;
+    bool world_dirty;
+    /** The outward edge normals with no rotation applied */
+    Vector *model_normals;
+    /** The edge normals in world space, valid while normals_dirty is false */
+    Vector *world_normals;
+    bool normals_dirty;
+    /** The distance from the centroid to the farthest vertex */
+    double bounding_radius;
+    size_t collision_group;
+    size_t broadphase_proxy;
+    /** The scene force creators that depend on the body */
+    size_t *force_handles;
+    size_t num_force_handles;
+    size_t force_handles_capacity;
+    bool gravitating;
+    bool bullet;
     double mass;
     double direction;
+    double cos_direction;
+    double sin_direction;
     double radius;
     RGBColor color;
-    Vector velocity;
-    Vector force;
-    Vector impulse;
     double elasticity;
     double angular_velocity;
-    Vector centroid;
     void *info;
     SDL_Surface *image;
     FreeFunc info_freer;
-    bool remove;
     int depth;
     SDL_Texture *texture;
 } Body;
 
+/* The store and accumulator this thread redirects accumulation for */
+_Thread_local BodyStore *redirected_store = NULL;
+_Thread_local BodyAccumulator *redirected_accumulator = NULL;
+
 Body *body_init(List *shape, double mass, RGBColor color) {
     return body_init_with_info(shape, mass, color, NULL, NULL);
 }
 
 Body *body_init_with_info(List *shape, double mass, RGBColor color,
                           void *info, FreeFunc info_freer) {
+    Shape *points = shape_from_list(shape);
+    list_free(shape);
+    return body_init_shape(points, mass, color, info, info_freer);
+}
+
+Body *body_init_shape(Shape *shape, double mass, RGBColor color,
+                      void *info, FreeFunc info_freer) {
 
     Body *body = malloc(sizeof(Body));
     assert(body);
 
-    body->points = shape;
+    body->store = body_store_init(1);
+    body->index = body_store_add(body->store, body);
+    body->owns_store = true;
+
+    // A shape with no vertices (i.e. a circle) is already around its centroid
+    Vector centroid = shape_size(shape) > 0 ? shape_centroid(shape) : VEC_ZERO;
+    shape_translate(shape, vec_negate(centroid));
+    body->kind = BODY_POLYGON;
+    body->model = shape;
+    body->bounding_radius = 0;
+    for (size_t i = 0; i < shape_size(shape); i++) {
+        double r = vec_len(shape_get(shape, i));
+        if (r > body->bounding_radius) {
+            body->bounding_radius = r;
+        }
+    }
+    body->collision_group = 0;
+    body->broadphase_proxy = NO_PROXY;
+    body->force_handles = NULL;
+    body->num_force_handles = 0;
+    body->force_handles_capacity = 0;
+    body->gravitating = false;
+    body->bullet = false;
+    body->world = shape_copy(shape);
+    body->world_dirty = true;
+    body->model_normals = malloc(sizeof(Vector) * shape_size(shape));
+    body->world_normals = malloc(sizeof(Vector) * shape_size(shape));
+    assert(shape_size(shape) == 0 || (body->model_normals != NULL && body->world_normals != NULL));
+    polygon_view_edge_normals(shape_view(shape), body->model_normals);
+    body->normals_dirty = true;
     body->mass = mass;
     body->color = color;
     body->direction = 0;
+    body->cos_direction = 1;
+    body->sin_direction = 0;
     body->radius = 0;
     body->elasticity = 1;
     body->angular_velocity = 0;
-    body->remove = 0;
     body->depth = 0;
 
     body->info = info;
     body->info_freer = info_freer;
 
-    body->velocity = VEC_ZERO;
-    body->force = VEC_ZERO;
-    body->impulse = VEC_ZERO;
-
-    body->centroid = polygon_centroid(body->points);
+    body->store->position[body->index] = centroid;
+    body->store->previous[body->index] = centroid;
+    body->store->inv_mass[body->index] = 1.0 / mass;
     body->image = NULL;
     body->texture = NULL;
 
     return body;
 }
 
+Body *body_init_circle(double radius, double mass, RGBColor color,
+                       void *info, FreeFunc info_freer) {
+    Body *body = body_init_shape(shape_init(0), mass, color, info, info_freer);
+    body->kind = BODY_CIRCLE;
+    body->radius = radius;
+    body->bounding_radius = radius;
+    return body;
+}
+
+BodyKind body_get_kind(Body *body) {
+    return body->kind;
+}
+
 void body_free(Body *body) {
-    list_free(body->points);
+    if (body->store != NULL) {
+        body_store_remove(body->store, body->index);
+    }
+    if (body->owns_store) {
+        body_store_free(body->store);
+    }
+    shape_free(body->model);
+    shape_free(body->world);
+    free(body->model_normals);
+    free(body->world_normals);
+    free(body->force_handles);
     SDL_FreeSurface(body->image);
     if (body->info_freer) { body->info_freer(body->info); }
     free(body);
@@ -79,16 +169,143 @@ SDL_Texture *body_get_texture(Body *body) {
   return body->texture;
 }
 
+void body_set_store(Body *body, BodyStore *store) {
+    BodyStore *old_store = body->store;
+    body->index = body_store_move(store, old_store, body->index);
+    body->store = store;
+    if (body->owns_store) {
+        body_store_free(old_store);
+    }
+    body->owns_store = false;
+}
+
+void body_attach(Body *body, BodyStore *store, size_t index) {
+    body->store = store;
+    body->index = index;
+}
+
+void body_detach(Body *body) {
+    assert(!body->owns_store);
+    body_store_remove(body->store, body->index);
+    body->store = NULL;
+}
+
+/* Recomputes the world-space vertices if the body has been rotated or its
+   centroid has moved in the store since they were last used,
+   and the world-space normals if it has been rotated. */
+void body_update_world(Body *body) {
+    Vector centroid = body_get_centroid(body);
+    if (!body->world_dirty && centroid.x == body->world_centroid.x
+            && centroid.y == body->world_centroid.y) {
+        return;
+    }
+    double c = body->cos_direction, s = body->sin_direction;
+    size_t size = shape_size(body->model);
+    vec_batch_transform(shape_vertices(body->world), shape_vertices(body->model),
+                        size, (BatchTransform) {c, -s, s, c, centroid});
+    body->world_centroid = centroid;
+    body->world_dirty = false;
+    if (body->normals_dirty) {
+        vec_batch_transform(body->world_normals, body->model_normals,
+                            size, (BatchTransform) {c, -s, s, c, VEC_ZERO});
+        body->normals_dirty = false;
+    }
+}
+
 List *body_get_shape(Body *body) {
-    List *copy = list_init(list_size(body->points), free);
-    for (size_t i = 0; i < list_size(body->points); i++) {
-        list_add(copy, vmalloc(*((Vector *)list_get(body->points, i))));
+    body_update_world(body);
+    return shape_to_list(body->world);
+}
+
+ShapeView body_get_shape_view(Body *body) {
+    body_update_world(body);
+    return shape_view(body->world);
+}
+
+const Vector *body_get_normals(Body *body) {
+    body_update_world(body);
+    return body->world_normals;
+}
+
+AABB body_get_aabb(Body *body) {
+    return aabb_of_circle(body_get_centroid(body), body->bounding_radius);
+}
+
+double body_get_bounding_radius(Body *body) {
+    return body->bounding_radius;
+}
+
+void body_set_collision_group(Body *body, size_t group) {
+    body->collision_group = group;
+}
+
+size_t body_get_collision_group(Body *body) {
+    return body->collision_group;
+}
+
+void body_set_broadphase_proxy(Body *body, size_t proxy) {
+    body->broadphase_proxy = proxy;
+}
+
+size_t body_get_broadphase_proxy(Body *body) {
+    return body->broadphase_proxy;
+}
+
+size_t body_add_force_handle(Body *body, size_t handle) {
+    if (body->num_force_handles == body->force_handles_capacity) {
+        body->force_handles_capacity = body->force_handles_capacity > 0
+            ? body->force_handles_capacity * GROWTH_FACTOR : 1;
+        body->force_handles = realloc(body->force_handles,
+                                      body->force_handles_capacity * sizeof(size_t));
+        assert(body->force_handles != NULL);
     }
-    return copy;
+    body->force_handles[body->num_force_handles] = handle;
+    return body->num_force_handles++;
+}
+
+void body_remove_force_handle(Body *body, size_t slot) {
+    assert(slot < body->num_force_handles);
+    body->force_handles[slot] = body->force_handles[--body->num_force_handles];
+}
+
+void body_set_force_handle(Body *body, size_t slot, size_t handle) {
+    assert(slot < body->num_force_handles);
+    body->force_handles[slot] = handle;
+}
+
+size_t body_get_force_handle(Body *body, size_t slot) {
+    assert(slot < body->num_force_handles);
+    return body->force_handles[slot];
+}
+
+size_t body_force_handles(Body *body) {
+    return body->num_force_handles;
+}
+
+void body_set_gravitating(Body *body, bool gravitating) {
+    body->gravitating = gravitating;
+}
+
+bool body_is_gravitating(Body *body) {
+    return body->gravitating;
+}
+
+void body_set_bullet(Body *body, bool bullet) {
+    body->bullet = bullet;
+}
+
+bool body_is_bullet(Body *body) {
+    return body->bullet;
 }
 
 Vector body_get_centroid(Body *body) {
-    return body->centroid;
+    return body->store->position[body->index];
+}
+
+Vector body_get_interpolated_centroid(Body *body, double alpha) {
+    Vector previous = body->store->previous[body->index];
+    Vector current = body->store->position[body->index];
+    return vec_add(previous, vec_multiply(alpha, vec_subtract(current, previous)));
 }
 
 double body_get_direction(Body *body) {
@@ -104,7 +321,7 @@ double body_get_radius(Body *body) {
 }
 
 Vector body_get_velocity(Body *body) {
-    return body->velocity;
+    return body->store->velocity[body->index];
 }
 
 RGBColor body_get_color(Body *body) {
@@ -126,11 +343,18 @@ void body_set_color(Body *body, RGBColor color) {
 
 void body_set_radius(Body *body, double radius) {
   body->radius = radius;
+  if (body->kind == BODY_CIRCLE) {
+    body->bounding_radius = radius;
+    if (body->store->is_static) {
+      body->store->changed = true;
+    }
+  }
 }
 
 void body_vec_accelerate(Body *body, Vector v){
-  body->velocity.x = body->velocity.x + v.x;
-  body->velocity.y = body->velocity.y + v.y;
+  Vector *velocity = &body->store->velocity[body->index];
+  velocity->x = velocity->x + v.x;
+  velocity->y = velocity->y + v.y;
 }
 
 void body_double_accelerate(Body *body, double d){
@@ -138,24 +362,39 @@ void body_double_accelerate(Body *body, double d){
 }
 
 void body_set_centroid(Body *body, Vector x) {
-  polygon_translate(body->points, vec_subtract(x, body_get_centroid(body)));
-  body->centroid = x;
+  body->store->position[body->index] = x;
+  body->store->previous[body->index] = x;
+  if (body->store->is_static) {
+    body->store->changed = true;
+  }
 }
 
 void body_set_velocity(Body *body, Vector v) {
-    body->velocity = v;
+    if (body->store->is_static) {
+        return;
+    }
+    if (body_is_asleep(body) && (v.x != 0 || v.y != 0)) {
+        body_wake(body);
+    }
+    body->store->velocity[body->index] = v;
 }
 
 void body_add_force(Body *body, Vector force){
-  body->force = vec_add(body->force, force);
+  if (body->store->is_static) {
+    return;
+  }
+  Vector *total = body->store == redirected_store
+      ? &redirected_accumulator->force[body->index]
+      : &body->store->force[body->index];
+  *total = vec_add(*total, force);
 }
 
 void body_set_force(Body *body, Vector force){
-  body->force = force;
+  body->store->force[body->index] = force;
 }
 
 Vector body_get_force(Body *body) {
-  return body->force;
+  return body->store->force[body->index];
 }
 
 void body_set_depth(Body *body, int depth){
@@ -167,36 +406,67 @@ int body_get_depth(Body *body) {
 }
 
 Vector body_get_impulse(Body *body) {
-  return body->impulse;
+  return body->store->impulse[body->index];
 }
 
 void body_add_impulse(Body *body, Vector impulse) {
-    body->impulse = vec_add(body->impulse, impulse);
+    if (body->store->is_static) {
+        return;
+    }
+    Vector *total = body->store == redirected_store
+        ? &redirected_accumulator->impulse[body->index]
+        : &body->store->impulse[body->index];
+    *total = vec_add(*total, impulse);
 }
 
 void body_set_rotation(Body *body, double angle) {
-  polygon_rotate(body->points, angle - body->direction, polygon_centroid(body->points));
   body->direction = angle;
+  body->cos_direction = cos(angle);
+  body->sin_direction = sin(angle);
+  body->world_dirty = true;
+  body->normals_dirty = true;
 }
 
 void body_tick(Body *body, double dt) {
-    Vector old_vel = body->velocity;
-    body_vec_accelerate(body, vec_multiply(1.0 / body->mass, body->impulse));
-    body_vec_accelerate(body, vec_multiply(dt / body->mass, body->force));
-    Vector ave_vel = vec_multiply(0.5, vec_add(old_vel, body->velocity));
-    body_set_centroid(body, vec_add(body->centroid, vec_multiply(dt, ave_vel)));
-    body->impulse = VEC_ZERO;
-    body->force = VEC_ZERO;
+    body_store_save_previous(body->store, body->index, body->index + 1);
+    body_store_integrate(body->store, body->index, body->index + 1, dt);
 }
 
 void body_remove(Body *body) {
-    body->remove = 1;
+    if (body->store == redirected_store) {
+        redirected_accumulator->removed[body->index] = true;
+        return;
+    }
+    body->store->removed[body->index] = true;
 }
 
 bool body_is_removed(Body *body) {
-    return body->remove;
+    return body->store->removed[body->index];
+}
+
+bool body_is_asleep(Body *body) {
+    return body->index >= body->store->awake;
+}
+
+void body_wake(Body *body) {
+    if (body_is_asleep(body)) {
+        body_store_wake_island(body->store, body->store->island[body->index]);
+    }
+}
+
+bool body_is_static(Body *body) {
+    return body->store->is_static;
+}
+
+size_t body_get_slot(Body *body) {
+    return body->index;
 }
 
 double body_distance(Body *b1, Body * b2){
   return vec_len(vec_subtract(body_get_centroid(b1), body_get_centroid(b2)));
 }
+
+void body_redirect_accumulation(BodyStore *store, BodyAccumulator *accumulator) {
+    redirected_store = store;
+    redirected_accumulator = accumulator;
+}
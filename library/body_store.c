@@ -0,0 +1,341 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "body_store.h"
+#include "body.h"
+
+/* When the store needs to grow */
+#define GROWTH_FACTOR 2
+
+void *body_store_grow_array(void *array, size_t element_size, size_t capacity) {
+    array = realloc(array, element_size * capacity);
+    assert(array != NULL);
+    return array;
+}
+
+void body_store_reserve(BodyStore *store, size_t capacity) {
+    store->position = body_store_grow_array(store->position, sizeof(Vector), capacity);
+    store->previous = body_store_grow_array(store->previous, sizeof(Vector), capacity);
+    store->velocity = body_store_grow_array(store->velocity, sizeof(Vector), capacity);
+    store->force = body_store_grow_array(store->force, sizeof(Vector), capacity);
+    store->impulse = body_store_grow_array(store->impulse, sizeof(Vector), capacity);
+    store->inv_mass = body_store_grow_array(store->inv_mass, sizeof(double), capacity);
+    store->removed = body_store_grow_array(store->removed, sizeof(bool), capacity);
+    store->idle_time = body_store_grow_array(store->idle_time, sizeof(double), capacity);
+    store->island = body_store_grow_array(store->island, sizeof(size_t), capacity);
+    store->handles = body_store_grow_array(store->handles, sizeof(Body *), capacity);
+    store->capacity = capacity;
+}
+
+BodyStore *body_store_init(size_t initial_size) {
+    BodyStore *store = malloc(sizeof(BodyStore));
+    assert(store != NULL);
+    store->size = 0;
+    store->capacity = 0;
+    store->awake = 0;
+    store->is_static = false;
+    store->changed = false;
+    store->position = NULL;
+    store->previous = NULL;
+    store->velocity = NULL;
+    store->force = NULL;
+    store->impulse = NULL;
+    store->inv_mass = NULL;
+    store->removed = NULL;
+    store->idle_time = NULL;
+    store->island = NULL;
+    store->handles = NULL;
+    body_store_reserve(store, initial_size > 0 ? initial_size : 1);
+    return store;
+}
+
+void body_store_free(BodyStore *store) {
+    free(store->position);
+    free(store->previous);
+    free(store->velocity);
+    free(store->force);
+    free(store->impulse);
+    free(store->inv_mass);
+    free(store->removed);
+    free(store->idle_time);
+    free(store->island);
+    free(store->handles);
+    free(store);
+}
+
+size_t body_store_add(BodyStore *store, Body *handle) {
+    if (store->size == store->capacity) {
+        body_store_reserve(store, store->capacity * GROWTH_FACTOR);
+    }
+    size_t index = store->size++;
+    store->position[index] = VEC_ZERO;
+    store->previous[index] = VEC_ZERO;
+    store->velocity[index] = VEC_ZERO;
+    store->force[index] = VEC_ZERO;
+    store->impulse[index] = VEC_ZERO;
+    store->inv_mass[index] = 0;
+    store->removed[index] = false;
+    store->idle_time[index] = 0;
+    store->island[index] = 0;
+    store->handles[index] = handle;
+    // the first sleeping slot moves to the end to make room
+    if (index != store->awake) {
+        body_store_swap(store, index, store->awake);
+        index = store->awake;
+    }
+    store->awake++;
+    return index;
+}
+
+void body_store_remove(BodyStore *store, size_t index) {
+    assert(index < store->size);
+    store->changed = true;
+    if (index < store->awake) {
+        // make the slot the first sleeping one, so the awake slots stay together
+        store->awake--;
+        body_store_swap(store, index, store->awake);
+        index = store->awake;
+    }
+    size_t last = --store->size;
+    if (index == last) {
+        return;
+    }
+    store->position[index] = store->position[last];
+    store->previous[index] = store->previous[last];
+    store->velocity[index] = store->velocity[last];
+    store->force[index] = store->force[last];
+    store->impulse[index] = store->impulse[last];
+    store->inv_mass[index] = store->inv_mass[last];
+    store->removed[index] = store->removed[last];
+    store->idle_time[index] = store->idle_time[last];
+    store->island[index] = store->island[last];
+    store->handles[index] = store->handles[last];
+    body_attach(store->handles[index], store, index);
+}
+
+void body_store_swap(BodyStore *store, size_t i, size_t j) {
+    assert(i < store->size && j < store->size);
+    if (i == j) {
+        return;
+    }
+    Vector position = store->position[i];
+    store->position[i] = store->position[j];
+    store->position[j] = position;
+    Vector previous = store->previous[i];
+    store->previous[i] = store->previous[j];
+    store->previous[j] = previous;
+    Vector velocity = store->velocity[i];
+    store->velocity[i] = store->velocity[j];
+    store->velocity[j] = velocity;
+    Vector force = store->force[i];
+    store->force[i] = store->force[j];
+    store->force[j] = force;
+    Vector impulse = store->impulse[i];
+    store->impulse[i] = store->impulse[j];
+    store->impulse[j] = impulse;
+    double inv_mass = store->inv_mass[i];
+    store->inv_mass[i] = store->inv_mass[j];
+    store->inv_mass[j] = inv_mass;
+    bool removed = store->removed[i];
+    store->removed[i] = store->removed[j];
+    store->removed[j] = removed;
+    double idle_time = store->idle_time[i];
+    store->idle_time[i] = store->idle_time[j];
+    store->idle_time[j] = idle_time;
+    size_t island = store->island[i];
+    store->island[i] = store->island[j];
+    store->island[j] = island;
+    Body *handle = store->handles[i];
+    store->handles[i] = store->handles[j];
+    store->handles[j] = handle;
+    body_attach(store->handles[i], store, i);
+    body_attach(store->handles[j], store, j);
+}
+
+size_t body_store_sleep(BodyStore *store, size_t index, size_t island) {
+    assert(index < store->awake);
+    store->awake--;
+    body_store_swap(store, index, store->awake);
+    index = store->awake;
+    store->velocity[index] = VEC_ZERO;
+    store->previous[index] = store->position[index];
+    store->island[index] = island;
+    return index;
+}
+
+void body_store_wake_island(BodyStore *store, size_t island) {
+    // each slot moved into i comes from the already checked front of the sleeping slots
+    for (size_t i = store->awake; i < store->size; i++) {
+        if (store->island[i] == island) {
+            body_store_swap(store, i, store->awake);
+            store->idle_time[store->awake] = 0;
+            store->awake++;
+        }
+    }
+}
+
+size_t body_store_move(BodyStore *store, BodyStore *from, size_t index) {
+    assert(index < from->size);
+    size_t new_index = body_store_add(store, from->handles[index]);
+    store->position[new_index] = from->position[index];
+    store->previous[new_index] = from->previous[index];
+    store->velocity[new_index] = from->velocity[index];
+    store->force[new_index] = from->force[index];
+    store->impulse[new_index] = from->impulse[index];
+    store->inv_mass[new_index] = from->inv_mass[index];
+    store->removed[new_index] = from->removed[index];
+    store->idle_time[new_index] = from->idle_time[index];
+    body_store_remove(from, index);
+    return new_index;
+}
+
+void body_store_integrate(BodyStore *store, size_t start, size_t end, double dt) {
+    assert(end <= store->size);
+    Vector *position = store->position;
+    Vector *velocity = store->velocity;
+    Vector *force = store->force;
+    Vector *impulse = store->impulse;
+    const double *inv_mass = store->inv_mass;
+    for (size_t i = start; i < end; i++) {
+        Vector old_velocity = velocity[i];
+        Vector new_velocity = {
+            .x = old_velocity.x + inv_mass[i] * (impulse[i].x + dt * force[i].x),
+            .y = old_velocity.y + inv_mass[i] * (impulse[i].y + dt * force[i].y)
+        };
+        position[i].x += dt * 0.5 * (old_velocity.x + new_velocity.x);
+        position[i].y += dt * 0.5 * (old_velocity.y + new_velocity.y);
+        velocity[i] = new_velocity;
+        force[i] = VEC_ZERO;
+        impulse[i] = VEC_ZERO;
+    }
+}
+
+void body_store_save_previous(BodyStore *store, size_t start, size_t end) {
+    assert(end <= store->size);
+    for (size_t i = start; i < end; i++) {
+        store->previous[i] = store->position[i];
+    }
+}
+
+void body_store_apply_impulses(BodyStore *store, size_t start, size_t end) {
+    assert(end <= store->size);
+    Vector *velocity = store->velocity;
+    Vector *impulse = store->impulse;
+    const double *inv_mass = store->inv_mass;
+    for (size_t i = start; i < end; i++) {
+        velocity[i].x += inv_mass[i] * impulse[i].x;
+        velocity[i].y += inv_mass[i] * impulse[i].y;
+        impulse[i] = VEC_ZERO;
+    }
+}
+
+void body_store_kick(BodyStore *store, size_t start, size_t end, double dt) {
+    assert(end <= store->size);
+    Vector *velocity = store->velocity;
+    const Vector *force = store->force;
+    const double *inv_mass = store->inv_mass;
+    for (size_t i = start; i < end; i++) {
+        velocity[i].x += inv_mass[i] * dt * force[i].x;
+        velocity[i].y += inv_mass[i] * dt * force[i].y;
+    }
+}
+
+void body_store_drift(BodyStore *store, size_t start, size_t end, double dt) {
+    assert(end <= store->size);
+    Vector *position = store->position;
+    const Vector *velocity = store->velocity;
+    for (size_t i = start; i < end; i++) {
+        position[i].x += dt * velocity[i].x;
+        position[i].y += dt * velocity[i].y;
+        store->force[i] = VEC_ZERO;
+    }
+}
+
+void body_store_rk4_stage(BodyStore *store, size_t start, size_t end, double dt,
+                          size_t stage, Vector *scratch) {
+    assert(end <= store->size && stage < RK4_STAGES);
+    // how much each stage's derivatives count, and how far into the step
+    // the next stage's forces are accumulated at
+    static const double WEIGHTS[RK4_STAGES] = {1, 2, 2, 1};
+    static const double NEXT[RK4_STAGES] = {0.5, 0.5, 1, 0};
+    Vector *position = store->position;
+    Vector *velocity = store->velocity;
+    Vector *force = store->force;
+    const double *inv_mass = store->inv_mass;
+    for (size_t i = start; i < end; i++) {
+        // the position and velocity at the start of the step,
+        // and the weighted sums of their derivatives so far
+        Vector *start_position = &scratch[RK4_STAGES * i];
+        Vector *start_velocity = &scratch[RK4_STAGES * i + 1];
+        Vector *sum_velocity = &scratch[RK4_STAGES * i + 2];
+        Vector *sum_acceleration = &scratch[RK4_STAGES * i + 3];
+        if (stage == 0) {
+            *start_position = position[i];
+            *start_velocity = velocity[i];
+            *sum_velocity = VEC_ZERO;
+            *sum_acceleration = VEC_ZERO;
+        }
+        Vector acceleration = vec_multiply(inv_mass[i], force[i]);
+        *sum_velocity = vec_add(*sum_velocity, vec_multiply(WEIGHTS[stage], velocity[i]));
+        *sum_acceleration = vec_add(*sum_acceleration, vec_multiply(WEIGHTS[stage], acceleration));
+        if (stage == RK4_STAGES - 1) {
+            position[i] = vec_add(*start_position, vec_multiply(dt / 6, *sum_velocity));
+            velocity[i] = vec_add(*start_velocity, vec_multiply(dt / 6, *sum_acceleration));
+        } else {
+            Vector stage_velocity = velocity[i];
+            position[i] = vec_add(*start_position, vec_multiply(NEXT[stage] * dt, stage_velocity));
+            velocity[i] = vec_add(*start_velocity, vec_multiply(NEXT[stage] * dt, acceleration));
+        }
+        force[i] = VEC_ZERO;
+    }
+}
+
+BodyAccumulator *body_accumulator_init(void) {
+    BodyAccumulator *accumulator = malloc(sizeof(BodyAccumulator));
+    assert(accumulator != NULL);
+    accumulator->capacity = 0;
+    accumulator->force = NULL;
+    accumulator->impulse = NULL;
+    accumulator->removed = NULL;
+    return accumulator;
+}
+
+void body_accumulator_free(BodyAccumulator *accumulator) {
+    free(accumulator->force);
+    free(accumulator->impulse);
+    free(accumulator->removed);
+    free(accumulator);
+}
+
+void body_accumulator_reset(BodyAccumulator *accumulator, size_t size) {
+    if (size > accumulator->capacity) {
+        size_t capacity = accumulator->capacity > 0 ? accumulator->capacity : 1;
+        while (capacity < size) {
+            capacity *= GROWTH_FACTOR;
+        }
+        accumulator->force = body_store_grow_array(accumulator->force, sizeof(Vector), capacity);
+        accumulator->impulse = body_store_grow_array(accumulator->impulse, sizeof(Vector), capacity);
+        accumulator->removed = body_store_grow_array(accumulator->removed, sizeof(bool), capacity);
+        accumulator->capacity = capacity;
+    }
+    for (size_t i = 0; i < size; i++) {
+        accumulator->force[i] = VEC_ZERO;
+        accumulator->impulse[i] = VEC_ZERO;
+        accumulator->removed[i] = false;
+    }
+}
+
+void body_store_reduce(BodyStore *store, BodyAccumulator **accumulators, size_t count,
+                       size_t start, size_t end) {
+    assert(end <= store->size);
+    for (size_t a = 0; a < count; a++) {
+        BodyAccumulator *accumulator = accumulators[a];
+        assert(end <= accumulator->capacity);
+        for (size_t i = start; i < end; i++) {
+            store->force[i].x += accumulator->force[i].x;
+            store->force[i].y += accumulator->force[i].y;
+            store->impulse[i].x += accumulator->impulse[i].x;
+            store->impulse[i].y += accumulator->impulse[i].y;
+            store->removed[i] = store->removed[i] || accumulator->removed[i];
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "broadphase.h"
+
+/* When the buffer needs to grow */
+#define GROWTH_FACTOR 2
+
+PairBuffer *pair_buffer_init(size_t initial_size) {
+    PairBuffer *buffer = malloc(sizeof(PairBuffer));
+    assert(buffer != NULL);
+    buffer->size = 0;
+    buffer->capacity = initial_size > 0 ? initial_size : 1;
+    buffer->pairs = malloc(buffer->capacity * sizeof(BodyPair));
+    assert(buffer->pairs != NULL);
+    return buffer;
+}
+
+void pair_buffer_free(PairBuffer *buffer) {
+    free(buffer->pairs);
+    free(buffer);
+}
+
+void pair_buffer_clear(PairBuffer *buffer) {
+    buffer->size = 0;
+}
+
+void pair_buffer_add(PairBuffer *buffer, size_t id1, size_t id2) {
+    assert(id1 != id2);
+    if (buffer->size == buffer->capacity) {
+        buffer->capacity *= GROWTH_FACTOR;
+        buffer->pairs = realloc(buffer->pairs, buffer->capacity * sizeof(BodyPair));
+        assert(buffer->pairs != NULL);
+    }
+    BodyPair pair = {
+        .first = id1 < id2 ? id1 : id2,
+        .second = id1 < id2 ? id2 : id1
+    };
+    buffer->pairs[buffer->size++] = pair;
+}
+
+int pair_buffer_compare(const void *a, const void *b) {
+    const BodyPair *p1 = a, *p2 = b;
+    if (p1->first != p2->first) {
+        return p1->first < p2->first ? -1 : 1;
+    }
+    if (p1->second != p2->second) {
+        return p1->second < p2->second ? -1 : 1;
+    }
+    return 0;
+}
+
+void pair_buffer_sort(PairBuffer *buffer) {
+    qsort(buffer->pairs, buffer->size, sizeof(BodyPair), pair_buffer_compare);
+}
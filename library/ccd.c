@@ -0,0 +1,203 @@
+#include <math.h>
+#include "ccd.h"
+#include "collision.h"
+
+/* The outward unit normal of edge i of a counterclockwise polygon. */
+Vector ccd_edge_normal(ShapeView polygon, const Vector *normals, size_t i) {
+    if (normals != NULL) {
+        return normals[i];
+    }
+    Vector edge = vec_subtract(polygon.vertices[i + 1 < polygon.size ? i + 1 : 0],
+                               polygon.vertices[i]);
+    return vec_unit((Vector) {edge.y, -edge.x});
+}
+
+CcdShape ccd_body_shape(Body *body) {
+    if (body_get_kind(body) == BODY_CIRCLE) {
+        return (CcdShape) {{NULL, 0}, NULL, body_get_centroid(body), body_get_radius(body)};
+    }
+    return (CcdShape) {body_get_shape_view(body), body_get_normals(body), VEC_ZERO, 0};
+}
+
+/*
+Finds the first time in [0, *toi] at which start + t * motion is within
+radius of point, lowering *toi to it. The start must be farther away.
+*/
+bool ccd_cast_point(Vector start, Vector motion, Vector point, double radius, double *toi) {
+    Vector offset = vec_subtract(start, point);
+    double a = vec_dot(motion, motion);
+    double b = 2 * vec_dot(offset, motion);
+    double c = vec_dot(offset, offset) - radius * radius;
+    double discriminant = b * b - 4 * a * c;
+    if (b >= 0 || discriminant < 0) {
+        return false;
+    }
+    double t = (-b - sqrt(discriminant)) / (2 * a);
+    if (t > *toi) {
+        return false;
+    }
+    *toi = t;
+    return true;
+}
+
+bool ccd_circle_polygon_toi(Vector center, double radius, ShapeView polygon,
+                            const Vector *normals, Vector motion, double *toi, Vector *axis) {
+    Vector start = vec_subtract(center, motion);
+    if (vec_dot(motion, motion) == 0
+        || find_circle_polygon_collision(start, radius, polygon, normals).collided) {
+        return false;
+    }
+    /*
+    The polygon grown by the radius is bounded by its edges pushed out
+    along their normals and by circles around its vertices.
+    The center enters it where it first crosses one of those.
+    */
+    size_t n = polygon.size;
+    const Vector *v = polygon.vertices;
+    double best = 1;
+    bool hit = false;
+    for (size_t i = 0; i < n; i++) {
+        Vector normal = ccd_edge_normal(polygon, normals, i);
+        double closing = vec_dot(motion, normal);
+        if (closing >= 0) {
+            continue;
+        }
+        double t = (radius - vec_dot(vec_subtract(start, v[i]), normal)) / closing;
+        if (t < 0 || t > best) {
+            continue;
+        }
+        // Where the circle touches the edge's line, which must be on the edge
+        Vector touch = vec_subtract(vec_add(start, vec_multiply(t, motion)),
+                                    vec_multiply(radius, normal));
+        Vector along = vec_subtract(v[i + 1 < n ? i + 1 : 0], v[i]);
+        double s = vec_dot(vec_subtract(touch, v[i]), along);
+        if (s >= 0 && s <= vec_dot(along, along)) {
+            best = t;
+            *axis = vec_negate(normal);
+            hit = true;
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (ccd_cast_point(start, motion, v[i], radius, &best)) {
+            *axis = vec_unit(vec_subtract(v[i], vec_add(start, vec_multiply(best, motion))));
+            hit = true;
+        }
+    }
+    if (hit) {
+        *toi = best;
+    }
+    return hit;
+}
+
+bool ccd_circle_circle_toi(Vector center1, double radius1, Vector center2, double radius2,
+                           Vector motion, double *toi, Vector *axis) {
+    Vector start = vec_subtract(center1, motion);
+    double best = 1;
+    if (find_circle_collision(start, radius1, center2, radius2).collided
+        || !ccd_cast_point(start, motion, center2, radius1 + radius2, &best)) {
+        return false;
+    }
+    *toi = best;
+    *axis = vec_unit(vec_subtract(center2, vec_add(start, vec_multiply(best, motion))));
+    return true;
+}
+
+/*
+Finds the largest gap between two polygons along an edge normal of either,
+with shape1 moved by offset. Sets *axis to that normal, oriented from shape1
+towards shape2. The gap is at most the distance between the polygons,
+and is negative exactly when they overlap.
+*/
+double ccd_separation(ShapeView shape1, const Vector *normals1,
+                      ShapeView shape2, const Vector *normals2,
+                      Vector offset, Vector *axis) {
+    double best = -INFINITY;
+    for (size_t i = 0; i < shape1.size; i++) {
+        Vector normal = ccd_edge_normal(shape1, normals1, i);
+        double face = vec_dot(vec_add(shape1.vertices[i], offset), normal);
+        double gap = INFINITY;
+        for (size_t j = 0; j < shape2.size; j++) {
+            gap = fmin(gap, vec_dot(shape2.vertices[j], normal) - face);
+        }
+        if (gap > best) {
+            best = gap;
+            *axis = normal;
+        }
+    }
+    for (size_t i = 0; i < shape2.size; i++) {
+        Vector normal = ccd_edge_normal(shape2, normals2, i);
+        double face = vec_dot(shape2.vertices[i], normal);
+        double gap = INFINITY;
+        for (size_t j = 0; j < shape1.size; j++) {
+            gap = fmin(gap, vec_dot(vec_add(shape1.vertices[j], offset), normal) - face);
+        }
+        if (gap > best) {
+            best = gap;
+            *axis = vec_negate(normal);
+        }
+    }
+    return best;
+}
+
+bool ccd_conservative_advancement(ShapeView shape1, const Vector *normals1,
+                                  ShapeView shape2, const Vector *normals2,
+                                  Vector motion, double *toi, Vector *axis) {
+    double tolerance = CCD_TOLERANCE * vec_len(motion);
+    if (tolerance == 0) {
+        return false;
+    }
+    /*
+    The gap along a fixed normal shrinks by exactly the motion's component
+    along it, and the distance between the polygons is never less than it,
+    so advancing by the gap over that component never passes the impact.
+    If the component is not positive, that normal separates them for good.
+    */
+    double t = 0;
+    Vector normal = VEC_ZERO;
+    for (size_t i = 0; i < CCD_MAX_ITERATIONS; i++) {
+        double gap = ccd_separation(shape1, normals1, shape2, normals2,
+                                    vec_multiply(t - 1, motion), &normal);
+        if (i == 0 && gap <= 0) {
+            return false;
+        }
+        double closing = vec_dot(motion, normal);
+        if (closing <= 0) {
+            return false;
+        }
+        if (gap <= tolerance) {
+            break;
+        }
+        t += gap / closing;
+        if (t > 1) {
+            return false;
+        }
+    }
+    *toi = t;
+    *axis = normal;
+    return true;
+}
+
+bool ccd_time_of_impact(CcdShape shape1, CcdShape shape2, Vector motion,
+                        double *toi, Vector *axis) {
+    bool circle1 = shape1.polygon.size == 0;
+    bool circle2 = shape2.polygon.size == 0;
+    if (circle1 && circle2) {
+        return ccd_circle_circle_toi(shape1.center, shape1.radius, shape2.center, shape2.radius,
+                                     motion, toi, axis);
+    }
+    if (circle1) {
+        return ccd_circle_polygon_toi(shape1.center, shape1.radius, shape2.polygon,
+                                      shape2.normals, motion, toi, axis);
+    }
+    if (circle2) {
+        // Seen from the circle, the polygon moves the other way
+        bool hit = ccd_circle_polygon_toi(shape2.center, shape2.radius, shape1.polygon,
+                                          shape1.normals, vec_negate(motion), toi, axis);
+        if (hit) {
+            *axis = vec_negate(*axis);
+        }
+        return hit;
+    }
+    return ccd_conservative_advancement(shape1.polygon, shape1.normals, shape2.polygon,
+                                        shape2.normals, motion, toi, axis);
+}
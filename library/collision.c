@@ -1,5 +1,6 @@
 #include <math.h>
 #include "collision.h"
+#include "vector_batch.h"
 
 #define SMALL -1e20
 #define LARGE 1e20
@@ -22,127 +23,329 @@
    free(colaux);
  }
 
- CollisionInfo find_circle_body_collision(Body *body1, Body *body2){
-     if(body_distance(body1, body2) < body_get_radius(body1) + body_get_radius(body2)){
-         return (CollisionInfo){true, vec_subtract(body_get_centroid(body2), body_get_centroid(body1))};
+ /* Projects a polygon onto an axis, storing the extent in *min and *max. */
+ void collision_project(ShapeView shape, Vector axis, double *min, double *max) {
+     if (shape.size == 0) {
+         *min = LARGE;
+         *max = SMALL;
+         return;
      }
-     return (CollisionInfo){false};
+     vec_batch_project(shape.vertices, shape.size, axis, min, max);
  }
 
+ /* The unit normal of the edge from p1 to p2. */
+ Vector collision_edge_normal(Vector p1, Vector p2) {
+     Vector unit_vec = vec_subtract(p1, p2);
+     unit_vec = (Vector) {-unit_vec.y, unit_vec.x};
+     return vec_multiply(1 / vec_len(unit_vec), unit_vec);
+ }
 
- CollisionInfo find_collision(List *shape1, List *shape2) {
+ /*
+ Projects both shapes onto each edge normal of one of them.
+ Returns false as soon as some axis separates them. Otherwise, lowers *depth
+ to the smallest overlap found, with *axis oriented from shape1 to shape2.
+ If normals is NULL, they are computed from the edges of the shape.
+ */
+ bool collision_test_axes(ShapeView shape, const Vector *normals,
+                          ShapeView shape1, ShapeView shape2, double *depth, Vector *axis) {
+     for (size_t i = 0; i < shape.size; i++) {
+         Vector normal = normals != NULL ? normals[i]
+             : collision_edge_normal(shape.vertices[i], shape.vertices[i + 1 < shape.size ? i + 1 : 0]);
+         double min1, max1, min2, max2;
+         collision_project(shape1, normal, &min1, &max1);
+         collision_project(shape2, normal, &min2, &max2);
+         // shape1 is pushed down the axis by forward, or up it by backward
+         double forward = max1 - min2;
+         double backward = max2 - min1;
+         if (forward <= 0 || backward <= 0) {
+             return false;
+         }
+         if (forward < *depth) {
+             *depth = forward;
+             *axis = normal;
+         }
+         if (backward < *depth) {
+             *depth = backward;
+             *axis = vec_negate(normal);
+         }
+     }
+     return true;
+ }
+
+ CollisionInfo find_collision_normals(ShapeView shape1, const Vector *normals1,
+                                      ShapeView shape2, const Vector *normals2) {
+    // Shapes whose bounding boxes are apart cannot intersect
+    if (!aabb_overlap(aabb_of_view(shape1), aabb_of_view(shape2))) {
+        return (CollisionInfo){false};
+    }
 
-    /* How to find axes:
-    For each polygon:
-    For each adjacent pair of point, subtract the vectors,
-    Rotate by 90 degrees, and then divide it by its length
-    (to make it a unit vector).
+    /*
+    For each edge normal of either polygon, project both polygons by dotting
+    each vertex with it. If the projections do not overlap on some axis,
+    then the polygons do not intersect. Otherwise they are separated fastest
+    along the axis with the smallest overlap.
     */
+    CollisionInfo info = {.collided = false, .axis = VEC_ZERO, .depth = LARGE};
+    if (!collision_test_axes(shape1, normals1, shape1, shape2, &info.depth, &info.axis)
+        || !collision_test_axes(shape2, normals2, shape1, shape2, &info.depth, &info.axis)) {
+        return (CollisionInfo){false};
+    }
+    info.collided = true;
+    return info;
+}
 
+ CollisionInfo find_collision_view(ShapeView shape1, ShapeView shape2) {
+    return find_collision_normals(shape1, NULL, shape2, NULL);
+}
 
-    double corners1[4] = {0, 0, 0, 0};
-    double corners2[4] = {0, 0, 0, 0};
-    for (size_t i = 0; i < list_size(shape1); i++) {
-        Vector vec = *(Vector *)list_get(shape1, i);
-        corners1[0] = (corners1[0] < vec.x) ? corners1[0] : vec.x;
-        corners1[1] = (corners1[1] < vec.y) ? corners1[1] : vec.y;
-        corners1[2] = (corners1[2] > vec.x) ? corners1[2] : vec.x;
-        corners1[3] = (corners1[3] > vec.y) ? corners1[3] : vec.y;
-    }
-    for (size_t i = 0; i < list_size(shape2); i++) {
-        Vector vec = *(Vector *)list_get(shape2, i);
-        corners2[0] = (corners2[0] < vec.x) ? corners2[0] : vec.x;
-        corners2[1] = (corners2[1] < vec.y) ? corners2[1] : vec.y;
-        corners2[2] = (corners2[2] > vec.x) ? corners2[2] : vec.x;
-        corners2[3] = (corners2[3] > vec.y) ? corners2[3] : vec.y;
-    }
-    if(((corners1[0]<corners2[2] && corners1[1]<corners2[3])
-      && (corners1[2]>corners2[0] && corners1[3]>corners2[1]))){
-        List *axes = list_init(list_size(shape1) + list_size(shape2), NULL);
-        for (size_t i = 0; i < list_size(shape1) - 1; i ++) {
-            Vector p1 = *((Vector *) list_get(shape1, i));
-            Vector p2 = *((Vector *) list_get(shape1, i + 1));
-            Vector unit_vec = vec_subtract(p1, p2);
-            unit_vec = vec_rotate(unit_vec, M_PI / 2);
-            unit_vec = vec_multiply(1 / vec_len(unit_vec), unit_vec);
-            list_add(axes, vmalloc(unit_vec));
-        }
+ CollisionInfo find_circle_collision(Vector center1, double radius1, Vector center2, double radius2) {
+     Vector offset = vec_subtract(center2, center1);
+     double distance = vec_len(offset);
+     if (distance >= radius1 + radius2) {
+         return (CollisionInfo){false};
+     }
+     // Concentric circles can be pushed apart in any direction
+     Vector axis = distance > 0 ? vec_multiply(1 / distance, offset) : (Vector) {1, 0};
+     return (CollisionInfo){true, axis, radius1 + radius2 - distance};
+ }
 
-        for (size_t i = 0; i < list_size(shape2) - 1; i ++) {
-            Vector p1 = *((Vector *) list_get(shape2, i));
-            Vector p2 = *((Vector *) list_get(shape2, i + 1));
-            Vector unit_vec = vec_subtract(p1, p2);
-            unit_vec = vec_rotate(unit_vec, M_PI / 2);
-            unit_vec = vec_multiply(1 / vec_len(unit_vec), unit_vec);
-            list_add(axes, vmalloc(unit_vec));
-        }
+ CollisionInfo find_circle_polygon_collision(Vector center, double radius,
+                                             ShapeView polygon, const Vector *normals) {
+     /*
+     Find the edge the center is farthest outside of. If the center is
+     inside every edge, the circle leaves through that edge. Otherwise the
+     closest point of the polygon is on that edge or at one of its ends.
+     */
+     size_t n = polygon.size;
+     const Vector *v = polygon.vertices;
+     size_t edge = 0;
+     Vector edge_normal = VEC_ZERO;
+     double separation = SMALL;
+     for (size_t i = 0; i < n; i++) {
+         Vector normal = normals != NULL ? normals[i]
+             : collision_edge_normal(v[i], v[i + 1 < n ? i + 1 : 0]);
+         double s = vec_dot(normal, vec_subtract(center, v[i]));
+         if (s > radius) {
+             return (CollisionInfo){false};
+         }
+         if (s > separation) {
+             separation = s;
+             edge = i;
+             edge_normal = normal;
+         }
+     }
+     if (separation <= 0) {
+         return (CollisionInfo){true, vec_negate(edge_normal), radius - separation};
+     }
+     Vector start = v[edge], end = v[edge + 1 < n ? edge + 1 : 0];
+     Vector along = vec_subtract(end, start);
+     double t = vec_dot(vec_subtract(center, start), along) / vec_dot(along, along);
+     Vector closest = t <= 0 ? start : t >= 1 ? end : vec_add(start, vec_multiply(t, along));
+     Vector offset = vec_subtract(center, closest);
+     double distance = vec_len(offset);
+     if (distance >= radius) {
+         return (CollisionInfo){false};
+     }
+     // The axis points from the circle towards the polygon
+     return (CollisionInfo){true, vec_multiply(-1 / distance, offset), radius - distance};
+ }
 
-        Vector collision_axis = VEC_ZERO;
-        double min_overlap = LARGE;
-        for (size_t i = 0; i < list_size(axes); i ++) {
-            double min1 = LARGE, min2 = LARGE;
-            double max1 = SMALL, max2 = SMALL;
-            for (size_t j = 0; j < list_size(shape1); j ++) {
-                Vector p1 = *((Vector *) list_get(axes, i));
-                Vector p2 = *((Vector *) list_get(shape1, j));
-                double dot = vec_dot(p1, p2);
-                if (dot < min1) {
-                  min1 = dot;
-                }
-                if (dot > max1) {
-                  max1 = dot;
-                }
-            }
-            for (size_t j = 0; j < list_size(shape2); j ++) {
-                Vector p1 = *((Vector *) list_get(axes, i));
-                Vector p2 = *((Vector *) list_get(shape2, j));
-                double dot = vec_dot(p1, p2);
-                if (dot < min2) {
-                  min2 = dot;
-                }
-                if (dot > max2) {
-                   max2 = dot;
-                }
-            }
-            if (!(min1 < max2 && min2 < max1)) {
-                return (CollisionInfo){false};
-            }
-            double temp1 = max1 - min2;
-            double temp2 = max2 - min1;
-            if (temp1 > 0 && temp1 < min_overlap){
-                min_overlap = temp1;
-                collision_axis = *((Vector *) list_get(axes, i));
-            } else if (temp2 > 0 && temp2 < min_overlap){
-                min_overlap = temp2;
-                collision_axis = *((Vector *) list_get(axes, i));
-            }
-        }
+ CollisionInfo find_circle_body_collision(Body *body1, Body *body2){
+     return find_circle_collision(body_get_centroid(body1), body_get_radius(body1),
+                                  body_get_centroid(body2), body_get_radius(body2));
+ }
 
-        return (CollisionInfo){true, collision_axis};
 
-        /* To find the projections:
-        Dot the positions vectors of each vertex with the unit vector.
-        Record the smallest and largest.
-        */
+ CollisionInfo find_gjk_collision(ShapeView shape1, ShapeView shape2, GjkCache *cache) {
+    CollisionInfo info = {false};
+    info.collided = gjk_penetration(gjk_polygon(&shape1), gjk_polygon(&shape2), cache,
+                                    &info.axis, &info.depth);
+    return info;
+}
 
-        /*
-        To check whether the projections intersect:
-        Smallest1 < Largest2 AND Largest1 > Smallest2
-        */
+ CollisionInfo find_body_collision(Body *body1, Body *body2, GjkCache *cache) {
+    if (!aabb_overlap(body_get_aabb(body1), body_get_aabb(body2))) {
+        return (CollisionInfo){false};
+    }
+    bool circle1 = body_get_kind(body1) == BODY_CIRCLE;
+    bool circle2 = body_get_kind(body2) == BODY_CIRCLE;
+    if (circle1 && circle2) {
+        return find_circle_collision(body_get_centroid(body1), body_get_radius(body1),
+                                     body_get_centroid(body2), body_get_radius(body2));
+    }
+    if (circle1) {
+        return find_circle_polygon_collision(body_get_centroid(body1), body_get_radius(body1),
+                                             body_get_shape_view(body2), body_get_normals(body2));
+    }
+    if (circle2) {
+        CollisionInfo info = find_circle_polygon_collision(
+            body_get_centroid(body2), body_get_radius(body2),
+            body_get_shape_view(body1), body_get_normals(body1));
+        info.axis = vec_negate(info.axis);
+        return info;
+    }
+    ShapeView shape1 = body_get_shape_view(body1);
+    ShapeView shape2 = body_get_shape_view(body2);
+    if (shape1.size + shape2.size <= GJK_VERTEX_THRESHOLD) {
+        return find_collision_normals(shape1, body_get_normals(body1), shape2, body_get_normals(body2));
+    }
+    GjkCache cold = {VEC_ZERO, {0, 0}};
+    if (cache == NULL) {
+        cache = &cold;
+    }
+    if (cache->direction.x == 0 && cache->direction.y == 0) {
+        // Start by looking for a gap between the centroids
+        cache->direction = vec_subtract(body_get_centroid(body2), body_get_centroid(body1));
+    }
+    return find_gjk_collision(shape1, shape2, cache);
+}
 
-        /*
-        For each axis, check whether the projections intersect.
-        If at any point it does not intersect, then the polygons
-        do not intersect.
-        */
+ void collide_bodies_cached(Body *body1, Body *body2, CollisionHandler handler, void *aux,
+                            GjkCache *cache) {
+   // Only bodies moving towards each other can start colliding
+   if(vec_dot(vec_subtract(body_get_velocity(body1), body_get_velocity(body2)),
+              vec_subtract(body_get_centroid(body2), body_get_centroid(body1))) > 0){
+     CollisionInfo info = find_body_collision(body1, body2, cache);
+     if(info.collided){
+       handler(body1, body2, info.axis, aux);
+     }
+   }
+ }
 
-      }
-      return (CollisionInfo){false};
+ void collide_bodies(Body *body1, Body *body2, CollisionHandler handler, void *aux) {
+   collide_bodies_cached(body1, body2, handler, aux, NULL);
+ }
 
+ CollisionInfo find_collision(List *shape1, List *shape2) {
+    Shape *s1 = shape_from_list(shape1);
+    Shape *s2 = shape_from_list(shape2);
+    CollisionInfo info = find_collision_view(shape_view(s1), shape_view(s2));
+    shape_free(s1);
+    shape_free(s2);
+    return info;
+}
 
+/* The edge of a polygon whose outward normal is closest to a direction,
+   storing how close in *alignment */
+size_t collision_facing_edge(ShapeView shape, const Vector *normals, Vector direction,
+                             double *alignment) {
+    size_t best = 0;
+    *alignment = SMALL;
+    for (size_t i = 0; i < shape.size; i++) {
+        Vector normal = normals != NULL ? normals[i]
+            : collision_edge_normal(shape.vertices[i], shape.vertices[i + 1 < shape.size ? i + 1 : 0]);
+        double dot = vec_dot(normal, direction);
+        if (dot > *alignment) {
+            *alignment = dot;
+            best = i;
+        }
+    }
+    return best;
+}
 
+/* The id of a contact point made by a reference edge and either
+   an incident vertex or, if clipped, a reference vertex */
+uint32_t collision_feature_id(bool flipped, size_t reference_edge, size_t vertex, bool clipped) {
+    return (uint32_t) flipped << 31 | (uint32_t) clipped << 30
+        | (uint32_t) (reference_edge & 0x7fff) << 15 | (uint32_t) (vertex & 0x7fff);
+}
 
+/* Keeps the points of a segment where dot(normal, point) <= offset,
+   cutting it where it crosses the line with the given id.
+   Returns the number of points kept, at most 2. */
+size_t collision_clip_segment(ContactPoint *out, const ContactPoint *in, size_t count,
+                              Vector normal, double offset, uint32_t id) {
+    if (count < 2) {
+        return 0;
+    }
+    size_t kept = 0;
+    double distance0 = vec_dot(normal, in[0].point) - offset;
+    double distance1 = vec_dot(normal, in[1].point) - offset;
+    if (distance0 <= 0) {
+        out[kept++] = in[0];
+    }
+    if (distance1 <= 0) {
+        out[kept++] = in[1];
+    }
+    if (distance0 * distance1 < 0) {
+        double t = distance0 / (distance0 - distance1);
+        out[kept++] = (ContactPoint) {
+            vec_add(in[0].point, vec_multiply(t, vec_subtract(in[1].point, in[0].point))), 0, id, 0
+        };
+    }
+    return kept;
+}
 
+/* Finds the contact points of two polygons known to collide */
+ContactManifold collision_clip(ShapeView shape1, const Vector *normals1,
+                               ShapeView shape2, const Vector *normals2, CollisionInfo info) {
+    ContactManifold manifold = {info.collided, info.axis, info.depth, 0};
+    if (!info.collided) {
+        return manifold;
+    }
+    double alignment1, alignment2;
+    size_t edge1 = collision_facing_edge(shape1, normals1, info.axis, &alignment1);
+    size_t edge2 = collision_facing_edge(shape2, normals2, vec_negate(info.axis), &alignment2);
+    bool flipped = alignment2 > alignment1 + REFERENCE_EDGE_TOLERANCE;
+    ShapeView reference = flipped ? shape2 : shape1, incident = flipped ? shape1 : shape2;
+    const Vector *incident_normals = flipped ? normals1 : normals2;
+    size_t edge = flipped ? edge2 : edge1;
+    size_t n = reference.size, m = incident.size;
+    Vector start = reference.vertices[edge], end = reference.vertices[edge + 1 < n ? edge + 1 : 0];
+    Vector normal = collision_edge_normal(start, end);
+    Vector tangent = vec_unit(vec_subtract(end, start));
 
+    double unused;
+    size_t incident_edge = collision_facing_edge(incident, incident_normals, vec_negate(normal), &unused);
+    size_t next = incident_edge + 1 < m ? incident_edge + 1 : 0;
+    ContactPoint segment[2] = {
+        {incident.vertices[incident_edge], 0, collision_feature_id(flipped, edge, incident_edge, false), 0},
+        {incident.vertices[next], 0, collision_feature_id(flipped, edge, next, false), 0}
+    };
+    // Clips the incident edge to the sides of the reference edge
+    ContactPoint clipped[2], points[2];
+    size_t count = collision_clip_segment(clipped, segment, 2, vec_negate(tangent),
+                                          -vec_dot(tangent, start),
+                                          collision_feature_id(flipped, edge, edge, true));
+    count = collision_clip_segment(points, clipped, count, tangent, vec_dot(tangent, end),
+                                   collision_feature_id(flipped, edge, edge + 1 < n ? edge + 1 : 0, true));
 
+    // Keeps the points below the reference edge
+    for (size_t i = 0; i < count; i++) {
+        double depth = vec_dot(normal, vec_subtract(start, points[i].point));
+        if (depth >= 0) {
+            points[i].depth = depth;
+            manifold.points[manifold.count++] = points[i];
+        }
+    }
+    if (manifold.count == 0) {
+        // The axis came from GJK and no edge quite matches it,
+        // so the shapes touch at the incident vertex deepest along it
+        ContactPoint deepest = vec_dot(segment[0].point, normal) < vec_dot(segment[1].point, normal)
+            ? segment[0] : segment[1];
+        deepest.depth = info.depth;
+        manifold.points[manifold.count++] = deepest;
+    }
+    return manifold;
+}
+
+ContactManifold find_collision_manifold(ShapeView shape1, const Vector *normals1,
+                                        ShapeView shape2, const Vector *normals2) {
+    return collision_clip(shape1, normals1, shape2, normals2,
+                          find_collision_normals(shape1, normals1, shape2, normals2));
+}
+
+ContactManifold find_body_manifold(Body *body1, Body *body2, GjkCache *cache) {
+    CollisionInfo info = find_body_collision(body1, body2, cache);
+    bool circle1 = body_get_kind(body1) == BODY_CIRCLE;
+    bool circle2 = body_get_kind(body2) == BODY_CIRCLE;
+    if (!info.collided || (!circle1 && !circle2)) {
+        return collision_clip(body_get_shape_view(body1), body_get_normals(body1),
+                              body_get_shape_view(body2), body_get_normals(body2), info);
+    }
+    // A circle's deepest point is on it, along the axis towards the other shape
+    Vector point = circle1
+        ? vec_add(body_get_centroid(body1), vec_multiply(body_get_radius(body1), info.axis))
+        : vec_subtract(body_get_centroid(body2), vec_multiply(body_get_radius(body2), info.axis));
+    return (ContactManifold) {true, info.axis, info.depth, 1, {{point, info.depth, 0, 0}}};
 }
@@ -0,0 +1,141 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "contact.h"
+
+/* When the table needs to grow */
+#define GROWTH_FACTOR 2
+/* The hash index has this many slots per pair of capacity,
+   so it is never more than half full */
+#define INDEX_SLOTS_PER_PAIR 2
+
+typedef struct contact_table {
+    size_t size;
+    size_t capacity;
+    ContactPair *pairs;
+    /* Open addressing with linear probing.
+       Each slot holds 1 + the index of a pair in pairs, or 0 if empty. */
+    size_t *slots;
+    /* A power of 2 */
+    size_t num_slots;
+} ContactTable;
+
+/* Hashes the two bodies of a pair the same way in either order */
+size_t contact_hash(Body *body1, Body *body2) {
+    uint64_t a = (uintptr_t) body1, b = (uintptr_t) body2;
+    if (a > b) {
+        uint64_t temp = a;
+        a = b;
+        b = temp;
+    }
+    uint64_t h = (a >> 4) * 0x9E3779B97F4A7C15u ^ (b >> 4) * 0xC2B2AE3D27D4EB4Fu;
+    return (size_t) (h ^ (h >> 32));
+}
+
+bool contact_matches(const ContactPair *pair, Body *body1, Body *body2) {
+    return (pair->body1 == body1 && pair->body2 == body2)
+        || (pair->body1 == body2 && pair->body2 == body1);
+}
+
+/* The slot holding the pair of two bodies, or the empty slot it would go in */
+size_t contact_table_slot(ContactTable *table, Body *body1, Body *body2) {
+    size_t mask = table->num_slots - 1;
+    size_t slot = contact_hash(body1, body2) & mask;
+    while (table->slots[slot] != 0
+           && !contact_matches(&table->pairs[table->slots[slot] - 1], body1, body2)) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void contact_table_reserve(ContactTable *table, size_t capacity) {
+    table->pairs = realloc(table->pairs, capacity * sizeof(ContactPair));
+    assert(table->pairs != NULL);
+    table->capacity = capacity;
+    size_t num_slots = 1;
+    while (num_slots < capacity * INDEX_SLOTS_PER_PAIR) {
+        num_slots *= 2;
+    }
+    free(table->slots);
+    table->slots = calloc(num_slots, sizeof(size_t));
+    assert(table->slots != NULL);
+    table->num_slots = num_slots;
+    for (size_t i = 0; i < table->size; i++) {
+        ContactPair *pair = &table->pairs[i];
+        table->slots[contact_table_slot(table, pair->body1, pair->body2)] = i + 1;
+    }
+}
+
+ContactTable *contact_table_init(size_t initial_size) {
+    ContactTable *table = malloc(sizeof(ContactTable));
+    assert(table != NULL);
+    table->size = 0;
+    table->pairs = NULL;
+    table->slots = NULL;
+    contact_table_reserve(table, initial_size > 0 ? initial_size : 1);
+    return table;
+}
+
+void contact_table_free(ContactTable *table) {
+    free(table->pairs);
+    free(table->slots);
+    free(table);
+}
+
+size_t contact_table_size(ContactTable *table) {
+    return table->size;
+}
+
+ContactPair *contact_table_get(ContactTable *table, size_t index) {
+    assert(index < table->size);
+    return &table->pairs[index];
+}
+
+ContactPair *contact_table_find(ContactTable *table, Body *body1, Body *body2) {
+    size_t index = table->slots[contact_table_slot(table, body1, body2)];
+    return index == 0 ? NULL : &table->pairs[index - 1];
+}
+
+ContactPair *contact_table_add(ContactTable *table, Body *body1, Body *body2) {
+    assert(contact_table_find(table, body1, body2) == NULL);
+    if (table->size == table->capacity) {
+        contact_table_reserve(table, table->capacity * GROWTH_FACTOR);
+    }
+    size_t index = table->size++;
+    table->pairs[index] = (ContactPair) {
+        .body1 = body1,
+        .body2 = body2,
+        .axis = VEC_ZERO,
+        .depth = 0,
+        .normal_impulse = 0,
+        .num_points = 0,
+        .cache = {VEC_ZERO, {0, 0}},
+        .tick = 0
+    };
+    table->slots[contact_table_slot(table, body1, body2)] = index + 1;
+    return &table->pairs[index];
+}
+
+void contact_table_remove(ContactTable *table, size_t index) {
+    assert(index < table->size);
+    ContactPair *pair = &table->pairs[index];
+    // Empty the pair's slot, shifting back later pairs so no probe chain breaks
+    size_t mask = table->num_slots - 1;
+    size_t hole = contact_table_slot(table, pair->body1, pair->body2);
+    for (size_t j = (hole + 1) & mask; table->slots[j] != 0; j = (j + 1) & mask) {
+        ContactPair *other = &table->pairs[table->slots[j] - 1];
+        size_t home = contact_hash(other->body1, other->body2) & mask;
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            table->slots[hole] = table->slots[j];
+            hole = j;
+        }
+    }
+    table->slots[hole] = 0;
+
+    size_t last = --table->size;
+    if (index != last) {
+        table->pairs[index] = table->pairs[last];
+        ContactPair *moved = &table->pairs[index];
+        table->slots[contact_table_slot(table, moved->body1, moved->body2)] = index + 1;
+    }
+}
@@ -1,37 +1,92 @@
 #include "forces.h"
-#include "aux.h"
 #include "collision.h"
 #include "scene.h"
 #include "body.h"
+#include "barnes_hut.h"
 #include <math.h>
 #include <stdio.h>
 
 #define MIN_DISTANCE 20.0
 
-void gravity_2_body(void *aux){
-    Body *body1 = aux_get_body((Aux *)aux, 0);
-    Body *body2 = aux_get_body((Aux *)aux, 1);
-    double G = aux_get_constant((Aux *)aux, 0);
-    double distance = body_distance(body1, body2);
+/* Adds the pull of gravity between two bodies, given the displacement
+   of the first from the second. */
+void gravity_pair(const ForceStore *store1, size_t slot1, const ForceStore *store2, size_t slot2,
+                  double G, Vector displacement){
+    double distance = vec_len(displacement);
     if (distance < MIN_DISTANCE) { /* So the force cannot approach infinity. */
         distance = MIN_DISTANCE;
     }
-    double magnitude = body_get_mass(body1) * body_get_mass(body2) * G / pow(distance, 2);
-    Vector direction = vec_unit(vec_subtract(body_get_centroid(body1), body_get_centroid(body2)));
+    // the masses are stored inverted, so that an infinite mass is 0
+    double magnitude = G / (store1->inv_mass[slot1] * store2->inv_mass[slot2] * distance * distance);
+    Vector force = vec_multiply(magnitude, vec_unit(displacement));
     //second force is negated bc its in the opposite direction
-    body_add_force(body1, vec_negate(vec_multiply(magnitude, direction)));
-    body_add_force(body2, vec_multiply(magnitude, direction));
+    store1->force[slot1] = vec_subtract(store1->force[slot1], force);
+    store2->force[slot2] = vec_add(store2->force[slot2], force);
+}
+
+void gravity_kernel(const ForceParams *params, const BodySlot *slots, size_t count,
+                    const ForceStore *stores){
+    for (size_t i = 0; i < count; i++) {
+        const ForceStore *store1 = &stores[slots[2 * i].store];
+        const ForceStore *store2 = &stores[slots[2 * i + 1].store];
+        size_t slot1 = slots[2 * i].slot, slot2 = slots[2 * i + 1].slot;
+        Vector displacement = vec_subtract(store1->position[slot1], store2->position[slot2]);
+        gravity_pair(store1, slot1, store2, slot2, params[i].constants[0], displacement);
+    }
 }
 
 void create_newtonian_gravity(Scene *scene, double G, Body *body1, Body *body2){
-    Aux *grav_aux = aux_init(2, 1);
-    aux_body_add(grav_aux, body1);
-    aux_body_add(grav_aux, body2);
-    aux_constant_add(grav_aux, G);
-    List *bodies = list_init(2, NULL);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
-    scene_add_bodies_force_creator(scene, gravity_2_body, grav_aux, bodies, (FreeFunc) aux_free);
+    ForceParams params = {{body1, body2}, {G}};
+    scene_add_slot_force(scene, gravity_kernel, params);
+}
+
+// stores the state of a gravity field between ticks
+typedef struct gravity_field {
+  Scene *scene;
+  double G;
+  BarnesHut *tree;
+} GravityField;
+
+void gravity_field_free(GravityField *field) {
+  barnes_hut_free(field->tree);
+  free(field);
+}
+
+void gravity_field_apply(void *aux) {
+  GravityField *field = aux;
+  Scene *scene = field->scene;
+  // Gather the gravitating bodies into scratch arrays that last for the tick
+  size_t num_bodies = scene_bodies(scene);
+  Body **bodies = scene_scratch(scene, num_bodies * sizeof(Body *));
+  Vector *positions = scene_scratch(scene, num_bodies * sizeof(Vector));
+  double *masses = scene_scratch(scene, num_bodies * sizeof(double));
+  size_t n = 0;
+  for (size_t i = 0; i < num_bodies; i++) {
+    Body *body = scene_get_body(scene, i);
+    if (body_is_gravitating(body) && !body_is_removed(body)) {
+      bodies[n] = body;
+      positions[n] = body_get_centroid(body);
+      masses[n] = body_get_mass(body);
+      n++;
+    }
+  }
+
+  barnes_hut_build(field->tree, positions, masses, n);
+  for (size_t i = 0; i < n; i++) {
+    Vector pull = barnes_hut_field(field->tree, i);
+    body_add_force(bodies[i], vec_multiply(field->G * masses[i], pull));
+  }
+}
+
+void create_gravity_field(Scene *scene, double G, double theta, double min_distance) {
+  GravityField *field = malloc(sizeof(GravityField));
+  assert(field != NULL);
+  field->scene = scene;
+  field->G = G;
+  field->tree = barnes_hut_init(theta, min_distance);
+  List *bodies = list_init(0, NULL);
+  scene_add_bodies_force_creator(scene, gravity_field_apply, field, bodies, (FreeFunc) gravity_field_free);
+  list_free(bodies);
 }
 
 /* Returns the vector that is the closest path from v1 to v2,
@@ -46,97 +101,83 @@ Vector displacement(Vector v1, Vector v2, double width, double height) {
     return displacement;
 }
 
-void wrapping_gravity_2_body(void *aux){
-    Body *body1 = aux_get_body((Aux *)aux, 0);
-    Body *body2 = aux_get_body((Aux *)aux, 1);
-    double G = aux_get_constant((Aux *)aux, 0);
-    double width = aux_get_constant((Aux *)aux, 1);
-    double height = aux_get_constant((Aux *)aux, 2);
-    Vector displacement_vector = displacement(body_get_centroid(body1), body_get_centroid(body2), width, height);
-    double distance = vec_len(displacement_vector);
-    if (distance < MIN_DISTANCE) { /* So the force cannot approach infinity. */
-        distance = MIN_DISTANCE;
+void wrapping_gravity_kernel(const ForceParams *params, const BodySlot *slots, size_t count,
+                             const ForceStore *stores){
+    for (size_t i = 0; i < count; i++) {
+        const ForceStore *store1 = &stores[slots[2 * i].store];
+        const ForceStore *store2 = &stores[slots[2 * i + 1].store];
+        size_t slot1 = slots[2 * i].slot, slot2 = slots[2 * i + 1].slot;
+        double width = params[i].constants[1];
+        double height = params[i].constants[2];
+        Vector displacement_vector = displacement(store1->position[slot1], store2->position[slot2],
+                                                  width, height);
+        gravity_pair(store1, slot1, store2, slot2, params[i].constants[0], displacement_vector);
     }
-    double magnitude = body_get_mass(body1) * body_get_mass(body2) * G / pow(distance, 2);
-    Vector direction = vec_unit(displacement_vector);
-    //second force is negated bc its in the opposite direction
-    body_add_force(body1, vec_negate(vec_multiply(magnitude, direction)));
-    body_add_force(body2, vec_multiply(magnitude, direction));
 }
 
 void create_wrapping_newtonian_gravity(Scene *scene, double G, Body *body1, Body *body2, Vector canvas_dimensions){
-    Aux *grav_aux = aux_init(2, 3);
-    aux_body_add(grav_aux, body1);
-    aux_body_add(grav_aux, body2);
-    aux_constant_add(grav_aux, G);
-    aux_constant_add(grav_aux, canvas_dimensions.x);
-    aux_constant_add(grav_aux, canvas_dimensions.y);
-    List *bodies = list_init(2, NULL);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
-    scene_add_bodies_force_creator(scene, wrapping_gravity_2_body, grav_aux, bodies, (FreeFunc) aux_free);
-}
-
-void spring_2_body(void *aux){
-  Body *body1 = aux_get_body((Aux *)aux, 0);
-  Body *body2 = aux_get_body((Aux *)aux, 1);
-  double k = aux_get_constant((Aux *)aux, 0);
-  double displacement = body_distance(body1, body2);
-  Vector direction = vec_unit(vec_subtract(body_get_centroid(body1), body_get_centroid(body2)));
-  body_add_force(body1, vec_negate(vec_multiply(k * displacement, direction)));
-  body_add_force(body2, vec_multiply(k * displacement, direction));
+    ForceParams params = {{body1, body2}, {G, canvas_dimensions.x, canvas_dimensions.y}};
+    scene_add_slot_force(scene, wrapping_gravity_kernel, params);
+}
+
+void spring_kernel(const ForceParams *params, const BodySlot *slots, size_t count,
+                   const ForceStore *stores){
+  for (size_t i = 0; i < count; i++) {
+    const ForceStore *store1 = &stores[slots[2 * i].store];
+    const ForceStore *store2 = &stores[slots[2 * i + 1].store];
+    size_t slot1 = slots[2 * i].slot, slot2 = slots[2 * i + 1].slot;
+    // the force is k times the distance along the direction between them
+    Vector force = vec_multiply(params[i].constants[0],
+                                vec_subtract(store1->position[slot1], store2->position[slot2]));
+    store1->force[slot1] = vec_subtract(store1->force[slot1], force);
+    store2->force[slot2] = vec_add(store2->force[slot2], force);
+  }
 }
 
 void create_spring(Scene *scene, double k, Body *body1, Body *body2){
-  Aux *spring_aux = aux_init(2, 1);
-  aux_body_add(spring_aux, body1);
-  aux_body_add(spring_aux, body2);
-  aux_constant_add(spring_aux, k);
-  List *bodies = list_init(2, NULL);
-  list_add(bodies, body1);
-  list_add(bodies, body2);
-  scene_add_bodies_force_creator(scene, spring_2_body, spring_aux, bodies, (FreeFunc) aux_free);
+  ForceParams params = {{body1, body2}, {k}};
+  scene_add_slot_force(scene, spring_kernel, params);
 }
 
-void drag_2_body(void *aux){
-  Body *body = aux_get_body((Aux *)aux, 0);
-  double gamma = aux_get_constant((Aux *)aux, 0);
-  body_add_force(body, vec_multiply(-gamma, body_get_velocity(body)));
+void drag_kernel(const ForceParams *params, const BodySlot *slots, size_t count,
+                 const ForceStore *stores){
+  for (size_t i = 0; i < count; i++) {
+    const ForceStore *store = &stores[slots[2 * i].store];
+    size_t slot = slots[2 * i].slot;
+    double gamma = params[i].constants[0];
+    store->force[slot] = vec_add(store->force[slot], vec_multiply(-gamma, store->velocity[slot]));
+  }
 }
 
 
 void create_drag(Scene *scene, double gamma, Body *body){
-  Aux *drag_aux = aux_init(1, 1);
-  aux_body_add(drag_aux, body);
-  aux_constant_add(drag_aux, gamma);
-  List *bodies = list_init(1, NULL);
-  list_add(bodies, body);
-  scene_add_bodies_force_creator(scene, drag_2_body, drag_aux, bodies, (FreeFunc) aux_free);
-}
-
-
-void generic_collision(void *aux){
-  ColAux temp = *(ColAux *)aux;
-  if((vec_dot(vec_subtract(body_get_velocity(temp.body1), body_get_velocity(temp.body2)),
-              vec_subtract(body_get_centroid(temp.body2), body_get_centroid(temp.body1))) > 0)
-  /*|| (vec_dot(vec_subtract(body_get_force(temp.body1), body_get_force(temp.body2)),
-              vec_subtract(body_get_centroid(temp.body2), body_get_centroid(temp.body1))) > 0
-      && vec_dot(vec_subtract(body_get_impulse(temp.body1), body_get_impulse(temp.body2)),
-                  vec_subtract(body_get_centroid(temp.body2), body_get_centroid(temp.body1))) >= 0)*/){
-    CollisionInfo info = find_collision(body_get_shape(temp.body1), body_get_shape(temp.body2));
-    if(info.collided){
-      temp.handler(temp.body1, temp.body2, info.axis, temp.aux);
-    }
+  ForceParams params = {{body, NULL}, {gamma}};
+  scene_add_slot_force(scene, drag_kernel, params);
+}
+
+
+void collision_kernel(const ForceParams *params, void *const *auxes, size_t count){
+  for (size_t i = 0; i < count; i++) {
+    // Each collision is handled by one worker, so it may update its own cache
+    ColAux *collision = auxes[i];
+    collide_bodies_cached(params[i].bodies[0], params[i].bodies[1],
+                          collision->handler, collision->aux, &collision->cache);
+  }
+}
+
+// frees a ColAux allocated with scene_alloc_aux()
+void pooled_col_aux_free(ColAux *colaux){
+  if(colaux->freer != NULL){
+    colaux->freer(colaux->aux);
   }
+  pool_release(colaux);
 }
 
 void create_collision(Scene *scene, Body *body1, Body *body2, CollisionHandler handler, void *aux, FreeFunc freer){
-  ColAux *collisiondata = malloc(sizeof(ColAux));
-  *collisiondata = (ColAux){body1, body2, handler, aux, freer};
-  List *bodies = list_init(2, NULL);
-  list_add(bodies, body1);
-  list_add(bodies, body2);
-  scene_add_bodies_force_creator(scene, generic_collision, (void *)collisiondata, bodies, (FreeFunc) col_aux_free);
+  ColAux *collisiondata = scene_alloc_aux(scene, sizeof(ColAux));
+  *collisiondata = (ColAux){body1, body2, handler, aux, freer, {VEC_ZERO, {0, 0}}};
+  ForceParams params = {{body1, body2}, {0}};
+  scene_add_batched_impulse(scene, collision_kernel, params, collisiondata, (FreeFunc) pooled_col_aux_free);
 }
 
 void destructive_collision_handler(Body *body1, Body *body2, Vector axis, void *aux){
@@ -172,7 +213,15 @@ void physics_collision_handler(Body *body1, Body *body2, Vector axis, void *aux)
 
 
 void create_physics_collision(Scene *scene, double elasticity, Body *body1, Body *body2){
-  double *elast = malloc(sizeof(double));
+  double *elast = scene_alloc_aux(scene, sizeof(double));
   *elast = elasticity;
-  create_collision(scene, body1, body2, physics_collision_handler, (void *)elast, free);
+  create_collision(scene, body1, body2, physics_collision_handler, (void *)elast, pool_release);
+}
+
+void create_group_destructive_collision(Scene *scene, size_t group1, size_t group2) {
+  scene_add_group_collision(scene, group1, group2, destructive_collision_handler, NULL, NULL);
+}
+
+void create_group_physics_collision(Scene *scene, double elasticity, size_t group1, size_t group2){
+  scene_add_group_solver(scene, group1, group2, elasticity);
 }
@@ -0,0 +1,190 @@
+#include <math.h>
+#include "gjk.h"
+
+/* GJK stops after this many support queries; it normally needs only a few */
+#define GJK_MAX_ITERATIONS 32
+/* EPA stops once its polytope has this many vertices */
+#define EPA_MAX_VERTICES 64
+/* EPA stops once an edge is within this distance of the true boundary */
+#define EPA_TOLERANCE 1e-9
+
+Vector gjk_polygon_support(const void *polygon, Vector direction, size_t *hint) {
+    const ShapeView *view = polygon;
+    const Vector *v = view->vertices;
+    size_t n = view->size;
+    size_t i = hint != NULL && *hint < n ? *hint : 0;
+    double best = vec_dot(v[i], direction);
+    /* The dot products rise and then fall around a convex polygon,
+       so climbing towards a larger neighbor ends at the farthest vertex. */
+    size_t next = i + 1 < n ? i + 1 : 0;
+    size_t step = vec_dot(v[next], direction) > best ? 1 : n - 1;
+    for (size_t k = 1; k < n; k++) {
+        size_t j = (i + step) % n;
+        double dot = vec_dot(v[j], direction);
+        if (dot <= best) {
+            break;
+        }
+        i = j;
+        best = dot;
+    }
+    if (hint != NULL) {
+        *hint = i;
+    }
+    return v[i];
+}
+
+ConvexShape gjk_polygon(const ShapeView *polygon) {
+    return (ConvexShape) {gjk_polygon_support, polygon};
+}
+
+/* The point of the Minkowski difference shape1 - shape2 farthest along direction */
+Vector gjk_support(ConvexShape shape1, ConvexShape shape2, Vector direction, size_t hints[2]) {
+    Vector p1 = shape1.support(shape1.shape, direction, &hints[0]);
+    Vector p2 = shape2.support(shape2.shape, vec_negate(direction), &hints[1]);
+    return vec_subtract(p1, p2);
+}
+
+/* A perpendicular of edge that points away from the point away */
+Vector gjk_edge_normal(Vector edge, Vector away) {
+    Vector normal = {-edge.y, edge.x};
+    return vec_dot(normal, away) > 0 ? vec_negate(normal) : normal;
+}
+
+/*
+Keeps the part of the simplex closest to the origin and points *direction
+from it towards the origin. simplex[*size - 1] is the newest point.
+Returns true if the simplex is a triangle containing the origin.
+*/
+bool gjk_update_simplex(Vector simplex[3], size_t *size, Vector *direction) {
+    Vector a = simplex[*size - 1];
+    Vector ao = vec_negate(a);
+    if (*size == 2) {
+        Vector ab = vec_subtract(simplex[0], a);
+        // The new point lies past the origin, so the origin is beside the segment
+        Vector normal = gjk_edge_normal(ab, a);
+        *direction = normal;
+        return false;
+    }
+    Vector b = simplex[1], c = simplex[0];
+    Vector ab = vec_subtract(b, a), ac = vec_subtract(c, a);
+    Vector ab_normal = gjk_edge_normal(ab, ac);
+    if (vec_dot(ab_normal, ao) > 0) {
+        simplex[0] = b;
+        simplex[1] = a;
+        *size = 2;
+        *direction = ab_normal;
+        return false;
+    }
+    Vector ac_normal = gjk_edge_normal(ac, ab);
+    if (vec_dot(ac_normal, ao) > 0) {
+        simplex[1] = a;
+        *size = 2;
+        *direction = ac_normal;
+        return false;
+    }
+    return true;
+}
+
+/*
+Runs GJK, storing the final triangle in simplex if the shapes intersect.
+The cached direction is updated either way.
+*/
+bool gjk_find_simplex(ConvexShape shape1, ConvexShape shape2, GjkCache *cache, Vector simplex[3]) {
+    /* If nothing in shape1 - shape2 lies past the origin along a direction,
+       then shape1 lies entirely behind shape2 along it. */
+    Vector direction = cache->direction;
+    if (direction.x == 0 && direction.y == 0) {
+        direction = (Vector) {1, 0};
+    }
+    simplex[0] = gjk_support(shape1, shape2, direction, cache->hints);
+    if (vec_dot(simplex[0], direction) <= 0) {
+        // The last separating direction still separates the shapes
+        cache->direction = direction;
+        return false;
+    }
+    size_t size = 1;
+    direction = vec_negate(simplex[0]);
+    for (size_t i = 0; i < GJK_MAX_ITERATIONS; i++) {
+        if (direction.x == 0 && direction.y == 0) {
+            // The origin is on the boundary of the difference: the shapes only touch
+            break;
+        }
+        Vector point = gjk_support(shape1, shape2, direction, cache->hints);
+        if (vec_dot(point, direction) <= 0) {
+            cache->direction = direction;
+            return false;
+        }
+        simplex[size++] = point;
+        if (gjk_update_simplex(simplex, &size, &direction)) {
+            return true;
+        }
+    }
+    cache->direction = direction;
+    return false;
+}
+
+bool gjk_intersect(ConvexShape shape1, ConvexShape shape2, GjkCache *cache) {
+    Vector simplex[3];
+    return gjk_find_simplex(shape1, shape2, cache, simplex);
+}
+
+bool gjk_penetration(ConvexShape shape1, ConvexShape shape2, GjkCache *cache,
+                     Vector *axis, double *depth) {
+    Vector polytope[EPA_MAX_VERTICES];
+    if (!gjk_find_simplex(shape1, shape2, cache, polytope)) {
+        return false;
+    }
+    // Keep the polytope counterclockwise so that edge normals point outwards
+    if (vec_cross(vec_subtract(polytope[1], polytope[0]),
+                  vec_subtract(polytope[2], polytope[0])) < 0) {
+        Vector temp = polytope[1];
+        polytope[1] = polytope[2];
+        polytope[2] = temp;
+    }
+    size_t size = 3;
+    /*
+    The edge of the polytope closest to the origin approximates the closest
+    edge of the difference. Expand the polytope past that edge until the
+    difference has nothing farther out along its normal.
+    */
+    Vector normal = VEC_ZERO;
+    double distance = INFINITY;
+    while (true) {
+        size_t closest = 0;
+        distance = INFINITY;
+        for (size_t i = 0; i < size; i++) {
+            Vector edge = vec_subtract(polytope[i + 1 < size ? i + 1 : 0], polytope[i]);
+            double length = vec_len(edge);
+            if (length == 0) {
+                continue;
+            }
+            Vector edge_normal = vec_multiply(1 / length, (Vector) {edge.y, -edge.x});
+            double edge_distance = vec_dot(edge_normal, polytope[i]);
+            if (edge_distance < distance) {
+                distance = edge_distance;
+                normal = edge_normal;
+                closest = i;
+            }
+        }
+        if (distance == INFINITY) {
+            return false;
+        }
+        Vector point = gjk_support(shape1, shape2, normal, cache->hints);
+        if (vec_dot(point, normal) - distance < EPA_TOLERANCE || size == EPA_MAX_VERTICES) {
+            break;
+        }
+        for (size_t i = size; i > closest + 1; i--) {
+            polytope[i] = polytope[i - 1];
+        }
+        polytope[closest + 1] = point;
+        size++;
+    }
+    if (distance <= 0) {
+        return false;
+    }
+    // Moving shape2 by normal * distance moves the difference by -normal * distance
+    *axis = normal;
+    *depth = distance;
+    cache->direction = *axis;
+    return true;
+}
@@ -34,22 +34,56 @@ Vector polygon_centroid(List *polygon){
     return centroid;
 }
 
+double polygon_view_area(ShapeView polygon) {
+    const Vector *v = polygon.vertices;
+    size_t n = polygon.size;
+    double area = 0;
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+        area += vec_cross(v[j], v[i]);
+    }
+    return fabs(0.5 * area);
+}
+
+Vector polygon_view_centroid(ShapeView polygon) {
+    const Vector *v = polygon.vertices;
+    size_t n = polygon.size;
+    double signed_area = 0, cx = 0, cy = 0;
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+        double cross = vec_cross(v[j], v[i]);
+        signed_area += cross;
+        cx += (v[j].x + v[i].x) * cross;
+        cy += (v[j].y + v[i].y) * cross;
+    }
+    Vector centroid = {
+        .x = cx / (3 * signed_area),
+        .y = cy / (3 * signed_area)
+    };
+    return centroid;
+}
+
+void polygon_view_edge_normals(ShapeView polygon, Vector *normals) {
+    const Vector *v = polygon.vertices;
+    size_t n = polygon.size;
+    for (size_t i = 0; i < n; i++) {
+        Vector edge = vec_subtract(v[i + 1 < n ? i + 1 : 0], v[i]);
+        // Counterclockwise edges have the outside on their right
+        normals[i] = vec_multiply(1 / vec_len(edge), (Vector) {edge.y, -edge.x});
+    }
+}
+
 void polygon_translate(List *polygon, Vector translation){
     for(size_t i = 0; i < list_size(polygon); ++i){
-        Vector *translate = malloc(sizeof(Vector));
-        *translate = vec_add((*(Vector *)list_get(polygon, i)), translation);
-        free(list_get(polygon, i));
-        list_set(polygon, i, translate);
+        Vector *vertex = list_get(polygon, i);
+        *vertex = vec_add(*vertex, translation);
     }
 }
 
 void polygon_rotate(List *polygon, double angle, Vector point){
-    polygon_translate(polygon, vec_negate(point));
+    double c = cos(angle), s = sin(angle);
     for(size_t i = 0; i < list_size(polygon); ++i){
-        Vector *rotate = malloc(sizeof(Vector));
-        *rotate = vec_rotate(*(Vector *)list_get(polygon, i), angle);
-        free(list_get(polygon, i));
-        list_set(polygon, i, rotate);
+        Vector *vertex = list_get(polygon, i);
+        Vector offset = vec_subtract(*vertex, point);
+        vertex->x = point.x + c * offset.x - s * offset.y;
+        vertex->y = point.y + s * offset.x + c * offset.y;
     }
-    polygon_translate(polygon, point);
 }
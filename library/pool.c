@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "pool.h"
+
+/* Every block starts with a header, so a released block can find its pool.
+   The header is padded to keep the block after it aligned. */
+typedef union block_header {
+    _Alignas(max_align_t) Pool *pool;
+    union block_header *next_free;
+} BlockHeader;
+
+typedef struct chunk {
+    struct chunk *next;
+    max_align_t align[];
+} Chunk;
+
+typedef struct pool {
+    /* The size of a header and block together */
+    size_t stride;
+    size_t block_size;
+    size_t chunk_blocks;
+    bool fixed;
+    Chunk *chunks;
+    BlockHeader *free_list;
+    size_t used;
+} Pool;
+
+void pool_add_chunk(Pool *pool) {
+    Chunk *chunk = malloc(sizeof(Chunk) + pool->stride * pool->chunk_blocks);
+    assert(chunk != NULL);
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    // thread the new blocks onto the free list, first block first
+    char *blocks = (char *) chunk->align;
+    for (size_t i = pool->chunk_blocks; i-- > 0;) {
+        BlockHeader *header = (BlockHeader *) (blocks + i * pool->stride);
+        header->next_free = pool->free_list;
+        pool->free_list = header;
+    }
+}
+
+Pool *pool_init(size_t block_size, size_t chunk_blocks, bool fixed) {
+    assert(chunk_blocks > 0);
+    Pool *pool = malloc(sizeof(Pool));
+    assert(pool != NULL);
+    size_t align = _Alignof(max_align_t);
+    size_t padded = (block_size + align - 1) / align * align;
+    pool->stride = sizeof(BlockHeader) + padded;
+    pool->block_size = block_size;
+    pool->chunk_blocks = chunk_blocks;
+    pool->fixed = fixed;
+    pool->chunks = NULL;
+    pool->free_list = NULL;
+    pool->used = 0;
+    if (fixed) {
+        pool_add_chunk(pool);
+    }
+    return pool;
+}
+
+void pool_free(Pool *pool) {
+    Chunk *chunk = pool->chunks;
+    while (chunk != NULL) {
+        Chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    free(pool);
+}
+
+void *pool_alloc(Pool *pool) {
+    if (pool->free_list == NULL) {
+        assert(!pool->fixed);
+        pool_add_chunk(pool);
+    }
+    BlockHeader *header = pool->free_list;
+    pool->free_list = header->next_free;
+    header->pool = pool;
+    pool->used++;
+    return header + 1;
+}
+
+void pool_release(void *block) {
+    if (block == NULL) {
+        return;
+    }
+    BlockHeader *header = (BlockHeader *) block - 1;
+    Pool *pool = header->pool;
+    header->next_free = pool->free_list;
+    pool->free_list = header;
+    pool->used--;
+}
+
+size_t pool_used(Pool *pool) {
+    return pool->used;
+}
+
+size_t pool_block_size(Pool *pool) {
+    return pool->block_size;
+}
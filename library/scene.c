@@ -3,78 +3,289 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <stdio.h>
+#include <math.h>
 #include "scene.h"
 #include "forces.h"
 #include "aux.h"
+#include "spatial_hash.h"
+#include "sweep.h"
+#include "aabb_tree.h"
+#include "thread_pool.h"
+#include "pool.h"
+#include "arena.h"
+#include "contact.h"
+#include "ccd.h"
 #define DEFAULT_NUM_BODIES 20
 #define DEFAULT_NUM_FORCES 10
+/* When the array of force creators needs to grow */
+#define GROWTH_FACTOR 2
+/* The block sizes of the pools that auxiliary values are allocated from */
+#define NUM_AUX_POOLS 4
+#define MIN_AUX_SIZE 16
+/* How many auxiliary values a growing pool allocates at a time */
+#define AUX_POOL_CHUNK 64
+/* The initial size in bytes of each thread's scratch arena */
+#define DEFAULT_SCRATCH_SIZE 4096
+/* How far the broadphase tree's fat boxes extend, relative to body size */
+#define TREE_MARGIN 0.25
+/* Static bodies never move, so their boxes need no margin */
+#define STATIC_TREE_MARGIN 0
+/* The fixed timestep of scene_step_fixed(), and the most ticks it runs per frame */
+#define DEFAULT_STEP (1.0 / 60)
+#define DEFAULT_MAX_STEPS 8
+/* The most bodies a bullet can stop at in one tick; it moves freely
+   for whatever is left of the tick after the last */
+#define MAX_BULLET_IMPACTS 4
+
+/* The most kinds of batched forces a scene can hold, plus 1 */
+#define MAX_FORCE_GROUPS 16
+/* The group of force creators that are each called on their own */
+#define INDIVIDUAL_GROUP 0
+
+/* The forces of one kind, stored as parallel arrays.
+   Removed by moving the last force into the hole. */
+typedef struct force_group {
+  /* At most one of kernel and slot_kernel is non-NULL; both are NULL
+     for INDIVIDUAL_GROUP */
+  ForceKernel kernel;
+  SlotKernel slot_kernel;
+  /* Whether the kernel only adds impulses (or handles collisions),
+     so it runs once per tick however often the forces are evaluated */
+  bool impulsive;
+  size_t size;
+  size_t capacity;
+  /* Only used in INDIVIDUAL_GROUP */
+  ForceCreator *forcers;
+  /* params[i].bodies are the bodies force i depends on, or NULL */
+  ForceParams *params;
+  /* NULL if the force is passed its params instead */
+  void **auxes;
+  FreeFunc *freers;
+  /* The slot of each force's handle in each of its bodies' lists */
+  size_t (*slots)[2];
+  /* Only used with a slot_kernel: where each force's two bodies are
+     in the stores, looked up again before each evaluation */
+  BodySlot *locations;
+} ForceGroup;
+
+size_t scene_add_force_group(Scene *scene, ForceKernel kernel, SlotKernel slot_kernel,
+                             bool impulsive);
 
 typedef struct scene {
     List *bodies;
-    List *forces;
-    List *auxes;
-    List *auxfreers;
+    /* The bodies removed during the tick, which are freed once it is done */
+    List *reaped;
+    BodyStore *store;
+    /* The static bodies, which are never integrated */
+    BodyStore *static_store;
+    /* Forces are grouped by kind; INDIVIDUAL_GROUP always exists */
+    ForceGroup groups[MAX_FORCE_GROUPS];
+    size_t num_groups;
+    size_t num_forces;
     List *textures;
     SDL_Texture *bkg;
     SDL_Surface *bkg_image;
     Camera *camera;
+    List *collision_rules;
+    BroadphaseType broadphase;
+    SpatialHash *grid;
+    SweepAndPrune *sweep;
+    AABBTree *tree;
+    /* The static bodies' boxes, identified by their slots in static_store
+       and rebuilt when static_store has changed */
+    AABBTree *static_tree;
+    PairBuffer *pairs;
+    /* The number of bodies when the pairs were found. Pairs with static
+       bodies give them the ids static_ids + slot, after every scene index. */
+    size_t static_ids;
+    /* Whether bodies were added or removed since the pairs were found,
+       so the moving broadphase's ids may no longer be scene indices */
+    bool broadphase_stale;
+    /* The pairs of grouped bodies touching at the end of the last tick */
+    ContactTable *contacts;
+    /* The number of ticks that have run group collisions */
+    size_t tick;
+    /* The number of sweeps the contact solver makes over the contacts */
+    size_t solver_iterations;
+    /* Bodies slower than sleep_velocity and pushed by less than sleep_force
+       for sleep_time seconds fall asleep; sleep_time is INFINITY when disabled */
+    double sleep_velocity;
+    double sleep_force;
+    double sleep_time;
+    /* The last island number given to bodies falling asleep */
+    size_t islands;
+    /* A union-find forest over the awake slots, and per root,
+       the island's shortest idle time and its number if it falls asleep */
+    size_t *island_parents;
+    double *island_idle;
+    size_t *island_ids;
+    size_t island_capacity;
+    /* The timestep of scene_step_fixed(), and the time it has not ticked yet */
+    double step;
+    size_t max_steps;
+    double step_time;
+    /* step_time / step after the last scene_step_fixed(), or 1 before */
+    double alpha;
+    IntegratorType integrator;
+    size_t substeps;
+    /* RK4_STAGES vectors per awake slot, for INTEGRATOR_RK4 */
+    Vector *rk4_scratch;
+    size_t rk4_capacity;
+    /* NULL when the scene ticks on the calling thread only */
+    ThreadPool *threads;
+    /* One per thread in the pool */
+    BodyAccumulator **accumulators;
+    /* Pools of MIN_AUX_SIZE, 2 * MIN_AUX_SIZE, ... bytes, created when first used */
+    Pool *aux_pools[NUM_AUX_POOLS];
+    /* One per thread, reset at the start of each tick */
+    Arena **scratch;
+    size_t scratch_size;
+    /* How much of each scratch arena was in use before the forces
+       were last evaluated again partway through a tick */
+    size_t *scratch_marks;
+    /* Whether the scene asserts instead of growing */
+    bool fixed;
+    size_t max_bodies;
+    size_t max_forces;
 } Scene;
 
-typedef struct force_object {
-  ForceCreator forcer;
-  Body *assoc_body1;
-  Body *assoc_body2;
-} ForceObj;
-
-ForceObj *forceobj_init(ForceCreator f, Body *b1, Body *b2) {
-  ForceObj *force = (ForceObj *) malloc(sizeof(ForceObj));
-  force->forcer = f;
-  force->assoc_body1 = b1;
-  if (!(b2 == NULL)) {
-    force->assoc_body2 = b2;
-  }
-  else {
-    force->assoc_body2 = NULL;
-  }
-  return force;
-}
+/* The worker of a parallel tick that the current thread is running */
+_Thread_local size_t scene_worker = 0;
 
-void forceobj_setbody(ForceObj *f, Body *b, size_t bodynum) {
-  assert(bodynum == 1 || bodynum == 2);
-  if (bodynum == 1) {
-    f->assoc_body1 = b;
-  }
-  else if (bodynum == 2) {
-    f->assoc_body2 = b;
+typedef struct collision_rule {
+  size_t group1;
+  size_t group2;
+  /* At most one of handler and listener is non-NULL;
+     if neither is, the rule's contacts are solved with elasticity */
+  CollisionHandler handler;
+  void *aux;
+  FreeFunc freer;
+  ContactListener listener;
+  double elasticity;
+} CollisionRule;
+
+void collision_rule_free(CollisionRule *rule) {
+  if (rule->freer) {
+    rule->freer(rule->aux);
   }
+  free(rule);
 }
 
-Scene *scene_init(void) {
+Scene *scene_init_capacity(size_t num_bodies, size_t num_forces, size_t scratch_size,
+                           bool fixed) {
     Scene *scene = (Scene *) malloc(sizeof(Scene));
-    scene->bodies = list_init(DEFAULT_NUM_BODIES, (FreeFunc) body_free);
-    scene->forces = list_init(DEFAULT_NUM_FORCES, NULL);
-    scene->auxes = list_init(DEFAULT_NUM_FORCES, NULL);
-    scene->auxfreers = list_init(DEFAULT_NUM_FORCES, NULL);
+    assert(scene != NULL);
+    scene->bodies = list_init(num_bodies, (FreeFunc) body_free);
+    // a tick reaps twice, so it can remove up to twice as many bodies as it holds
+    scene->reaped = list_init(2 * num_bodies + 2, (FreeFunc) body_free);
+    scene->store = body_store_init(num_bodies);
+    // any of the bodies may be static, so a fixed scene never grows either store
+    scene->static_store = body_store_init(num_bodies);
+    scene->static_store->is_static = true;
+    scene->num_groups = 0;
+    scene->num_forces = 0;
     scene->textures = list_init(DEFAULT_NUM_FORCES, NULL);
     scene->bkg = NULL;
     scene->bkg_image = NULL;
     scene->camera = init_camera();
+    scene->collision_rules = list_init(DEFAULT_NUM_FORCES, (FreeFunc) collision_rule_free);
+    scene->broadphase = BROADPHASE_GRID;
+    scene->grid = spatial_hash_init(0);
+    scene->sweep = sweep_init();
+    scene->tree = aabb_tree_init(TREE_MARGIN);
+    scene->static_tree = aabb_tree_init(STATIC_TREE_MARGIN);
+    scene->pairs = pair_buffer_init(num_bodies);
+    scene->static_ids = 0;
+    scene->broadphase_stale = false;
+    scene->contacts = contact_table_init(num_bodies);
+    scene->tick = 0;
+    scene->solver_iterations = SOLVER_ITERATIONS;
+    scene->sleep_velocity = 0;
+    scene->sleep_force = 0;
+    scene->sleep_time = INFINITY;
+    scene->islands = 0;
+    scene->island_parents = NULL;
+    scene->island_idle = NULL;
+    scene->island_ids = NULL;
+    scene->island_capacity = 0;
+    scene->step = DEFAULT_STEP;
+    scene->max_steps = DEFAULT_MAX_STEPS;
+    scene->step_time = 0;
+    scene->alpha = 1;
+    scene->integrator = INTEGRATOR_TRAPEZOID;
+    scene->substeps = 1;
+    scene->rk4_scratch = NULL;
+    scene->rk4_capacity = 0;
+    scene->threads = NULL;
+    scene->accumulators = NULL;
+    scene->fixed = fixed;
+    scene->max_bodies = num_bodies;
+    scene->max_forces = num_forces;
+    scene_add_force_group(scene, NULL, NULL, false);
+    for (size_t i = 0; i < NUM_AUX_POOLS; i++) {
+      scene->aux_pools[i] = fixed ? pool_init(MIN_AUX_SIZE << i, num_forces, true) : NULL;
+    }
+    scene->scratch_size = scratch_size;
+    scene->scratch = malloc(sizeof(Arena *));
+    assert(scene->scratch != NULL);
+    scene->scratch[0] = arena_init(scratch_size, fixed);
+    scene->scratch_marks = malloc(sizeof(size_t));
+    assert(scene->scratch_marks != NULL);
     // scene->associated_bodies = list_init(DEFAULT_NUM_FORCES, NULL);
     return scene;
 }
 
+Scene *scene_init(void) {
+    return scene_init_capacity(DEFAULT_NUM_BODIES, DEFAULT_NUM_FORCES,
+                               DEFAULT_SCRATCH_SIZE, false);
+}
+
+Scene *scene_init_fixed(size_t max_bodies, size_t max_forces, size_t scratch_size) {
+    assert(max_bodies > 0 && max_forces > 0);
+    return scene_init_capacity(max_bodies, max_forces, scratch_size, true);
+}
+
 void scene_free(Scene *scene) {
-    for (size_t i = 0; i < list_size(scene->forces); i++) {
-      free(list_get(scene->forces, i));
-    }
-    list_free(scene->forces);
-    for(size_t i = 0; i < list_size(scene->auxes); i++){
-      ((FreeFunc)list_get(scene->auxfreers, i))(list_get(scene->auxes, i));
+    for (size_t g = 0; g < scene->num_groups; g++) {
+      ForceGroup *group = &scene->groups[g];
+      for (size_t i = 0; i < group->size; i++) {
+        if (group->freers[i]) {
+          group->freers[i](group->auxes[i]);
+        }
+      }
+      free(group->forcers);
+      free(group->params);
+      free(group->auxes);
+      free(group->freers);
+      free(group->slots);
+      free(group->locations);
     }
-    list_free(scene->auxes);
-    list_free(scene->auxfreers);
     camera_free(scene->camera);
+    list_free(scene->collision_rules);
+    spatial_hash_free(scene->grid);
+    sweep_free(scene->sweep);
+    aabb_tree_free(scene->tree);
+    aabb_tree_free(scene->static_tree);
+    pair_buffer_free(scene->pairs);
+    contact_table_free(scene->contacts);
+    free(scene->island_parents);
+    free(scene->island_idle);
+    free(scene->island_ids);
+    free(scene->rk4_scratch);
+    scene_set_threads(scene, 1);
     list_free(scene->bodies);
+    list_free(scene->reaped);
+    body_store_free(scene->store);
+    body_store_free(scene->static_store);
+    arena_free(scene->scratch[0]);
+    free(scene->scratch);
+    free(scene->scratch_marks);
+    // the force creators and rules above may have released pooled values
+    for (size_t i = 0; i < NUM_AUX_POOLS; i++) {
+      if (scene->aux_pools[i] != NULL) {
+        pool_free(scene->aux_pools[i]);
+      }
+    }
     // list_free(scene->associated_bodies);
     free(scene);
 }
@@ -122,87 +333,1412 @@ Camera *scene_get_camera(Scene *scene) {
 }
 
 void scene_add_body(Scene *scene, Body *body) {
-    assert(list_size(body_get_shape(body)) >= 3);
+    assert(body_get_kind(body) == BODY_CIRCLE || body_get_shape_view(body).size >= 3);
+    assert(!scene->fixed || scene_bodies(scene) < scene->max_bodies);
+    body_set_store(body, scene->store);
+    list_add(scene->bodies, body);
+    scene->broadphase_stale = true;
+}
+
+void scene_add_static_body(Scene *scene, Body *body) {
+    assert(body_get_kind(body) == BODY_CIRCLE || body_get_shape_view(body).size >= 3);
+    assert(body_get_mass(body) == INFINITY);
+    assert(!scene->fixed || scene_bodies(scene) < scene->max_bodies);
+    body_set_velocity(body, VEC_ZERO);
+    body_set_store(body, scene->static_store);
     list_add(scene->bodies, body);
+    if (!scene->static_store->changed) {
+      // the other slots are where the tree has them, so just add this one
+      size_t slot = body_get_slot(body);
+      body_set_broadphase_proxy(body, aabb_tree_insert(scene->static_tree, slot, body_get_aabb(body)));
+    }
+}
+
+/* Takes a body out of the incremental broadphase, if it is in one. */
+void scene_release_proxy(Scene *scene, Body *body) {
+    size_t proxy = body_get_broadphase_proxy(body);
+    if (proxy == NO_PROXY) {
+      return;
+    }
+    if (body_is_static(body)) {
+      aabb_tree_remove(scene->static_tree, proxy);
+    }
+    else if (scene->broadphase == BROADPHASE_SWEEP) {
+      sweep_remove(scene->sweep, proxy);
+    }
+    else if (scene->broadphase == BROADPHASE_TREE) {
+      aabb_tree_remove(scene->tree, proxy);
+    }
+    body_set_broadphase_proxy(body, NO_PROXY);
+}
+
+/* A handle names a force by its group and its index in the group */
+size_t scene_force_handle(size_t group, size_t index) {
+    return index * MAX_FORCE_GROUPS + group;
+}
+
+/* Takes the handle of a force out of one of its bodies' lists. */
+void scene_detach_force(Scene *scene, size_t g, size_t i, size_t k) {
+    ForceGroup *group = &scene->groups[g];
+    Body *body = group->params[i].bodies[k];
+    size_t slot = group->slots[i][k];
+    size_t last = body_force_handles(body) - 1;
+    body_remove_force_handle(body, slot);
+    if (slot != last) {
+      // the body's last handle moved into the slot, so tell its force
+      size_t handle = body_get_force_handle(body, slot);
+      ForceGroup *moved_group = &scene->groups[handle % MAX_FORCE_GROUPS];
+      size_t moved = handle / MAX_FORCE_GROUPS;
+      for (size_t m = 0; m < 2; m++) {
+        if (moved_group->params[moved].bodies[m] == body && moved_group->slots[moved][m] == last) {
+          moved_group->slots[moved][m] = slot;
+          break;
+        }
+      }
+    }
+    group->params[i].bodies[k] = NULL;
+}
+
+/* Frees a force and moves the last force of its group into its place. */
+void scene_remove_force(Scene *scene, size_t handle) {
+    size_t g = handle % MAX_FORCE_GROUPS, i = handle / MAX_FORCE_GROUPS;
+    ForceGroup *group = &scene->groups[g];
+    assert(g < scene->num_groups && i < group->size);
+    for (size_t k = 0; k < 2; k++) {
+      if (group->params[i].bodies[k] != NULL) {
+        scene_detach_force(scene, g, i, k);
+      }
+    }
+    if (group->freers[i]) {
+      group->freers[i](group->auxes[i]);
+    }
+    scene->num_forces--;
+    size_t last = --group->size;
+    if (i != last) {
+      if (group->forcers != NULL) {
+        group->forcers[i] = group->forcers[last];
+      }
+      group->params[i] = group->params[last];
+      group->auxes[i] = group->auxes[last];
+      group->freers[i] = group->freers[last];
+      group->slots[i][0] = group->slots[last][0];
+      group->slots[i][1] = group->slots[last][1];
+      for (size_t k = 0; k < 2; k++) {
+        Body *body = group->params[i].bodies[k];
+        if (body != NULL) {
+          body_set_force_handle(body, group->slots[i][k], handle);
+        }
+      }
+    }
+}
+
+/* Removes the forces that depend on a body,
+   in time proportional to their number. */
+void scene_remove_body_forces(Scene *scene, Body *body) {
+    while (body_force_handles(body) > 0) {
+      scene_remove_force(scene, body_get_force_handle(body, body_force_handles(body) - 1));
+    }
+}
+
+/* Tells the contact listeners whose groups match about an event on a contact.
+   Listeners get the bodies in the order of their rule's groups. */
+void scene_notify_contact(Scene *scene, ContactEvent event, ContactPair *contact) {
+    Body *body1 = contact->body1, *body2 = contact->body2;
+    size_t group1 = body_get_collision_group(body1);
+    size_t group2 = body_get_collision_group(body2);
+    for (size_t r = 0; r < list_size(scene->collision_rules); r++) {
+      CollisionRule *rule = list_get(scene->collision_rules, r);
+      if (rule->listener == NULL) {
+        continue;
+      }
+      if (rule->group1 == group1 && rule->group2 == group2) {
+        rule->listener(event, body1, body2, contact, rule->aux);
+      } else if (rule->group1 == group2 && rule->group2 == group1) {
+        rule->listener(event, body2, body1, contact, rule->aux);
+      }
+    }
+}
+
+/* Ends and forgets every contact of a body that is leaving the scene. */
+void scene_end_body_contacts(Scene *scene, Body *body) {
+    for (size_t i = 0; i < contact_table_size(scene->contacts); i++) {
+      ContactPair *contact = contact_table_get(scene->contacts, i);
+      if (contact->body1 == body || contact->body2 == body) {
+        scene_notify_contact(scene, CONTACT_END, contact);
+        contact_table_remove(scene->contacts, i);
+        i--;
+      }
+    }
 }
 
 void scene_remove_body(Scene *scene, size_t index) {
     assert(index < scene_bodies(scene));
-    body_free(list_remove(scene->bodies, index));
+    Body *body = list_remove(scene->bodies, index);
+    scene_remove_body_forces(scene, body);
+    scene_release_proxy(scene, body);
+    scene_end_body_contacts(scene, body);
+    body_free(body);
 }
 
 // DEPRECATED DO NOT USE
 void scene_add_force_creator(Scene *scene, ForceCreator forcer, void *aux, FreeFunc freer){
     List *bodies = list_init(0, NULL);
     scene_add_bodies_force_creator(scene, forcer, aux, bodies, freer);
-    list_add(scene->forces, forcer);
-    list_add(scene->auxes, aux);
-    list_add(scene->auxfreers, freer);
+    list_free(bodies);
+}
+
+void *scene_grow_array(void *array, size_t element_size, size_t capacity) {
+    array = realloc(array, element_size * capacity);
+    assert(array != NULL);
+    return array;
+}
+
+/* Sets the number of forces a group has space for. */
+void scene_reserve_forces(ForceGroup *group, size_t capacity) {
+    if (group->kernel == NULL) {
+      group->forcers = scene_grow_array(group->forcers, sizeof(ForceCreator), capacity);
+    }
+    group->params = scene_grow_array(group->params, sizeof(ForceParams), capacity);
+    group->auxes = scene_grow_array(group->auxes, sizeof(void *), capacity);
+    group->freers = scene_grow_array(group->freers, sizeof(FreeFunc), capacity);
+    group->slots = scene_grow_array(group->slots, sizeof(size_t[2]), capacity);
+    if (group->slot_kernel != NULL) {
+      group->locations = scene_grow_array(group->locations, 2 * sizeof(BodySlot), capacity);
+    }
+    group->capacity = capacity;
+}
+
+/* Finds the group of forces applied by a kernel, creating it if needed. */
+size_t scene_add_force_group(Scene *scene, ForceKernel kernel, SlotKernel slot_kernel,
+                             bool impulsive) {
+    for (size_t g = 0; g < scene->num_groups; g++) {
+      if (scene->groups[g].kernel == kernel && scene->groups[g].slot_kernel == slot_kernel) {
+        assert(scene->groups[g].impulsive == impulsive);
+        return g;
+      }
+    }
+    assert(scene->num_groups < MAX_FORCE_GROUPS);
+    size_t g = scene->num_groups++;
+    ForceGroup *group = &scene->groups[g];
+    *group = (ForceGroup) {kernel, slot_kernel, impulsive, 0, 0, NULL, NULL, NULL, NULL, NULL, NULL};
+    scene_reserve_forces(group, scene->fixed ? scene->max_forces : DEFAULT_NUM_FORCES);
+    return g;
+}
+
+/* Appends a force to a group and indexes it by its bodies. */
+void scene_add_force(Scene *scene, size_t g, ForceCreator forcer, void *aux, FreeFunc freer,
+                     ForceParams params) {
+    ForceGroup *group = &scene->groups[g];
+    assert(!scene->fixed || scene->num_forces < scene->max_forces);
+    if (group->size == group->capacity) {
+      scene_reserve_forces(group, group->capacity * GROWTH_FACTOR);
+    }
+    size_t i = group->size++;
+    scene->num_forces++;
+    if (group->forcers != NULL) {
+      group->forcers[i] = forcer;
+    }
+    group->params[i] = params;
+    group->auxes[i] = aux;
+    group->freers[i] = freer;
+    for (size_t k = 0; k < 2; k++) {
+      Body *body = params.bodies[k];
+      group->slots[i][k] = body != NULL
+          ? body_add_force_handle(body, scene_force_handle(g, i)) : 0;
+    }
 }
 
 void scene_add_bodies_force_creator(
     Scene *scene, ForceCreator forcer, void *aux, List *bodies, FreeFunc freer) {
-    ForceObj *force = NULL;
-    if (list_size(bodies) == 2) {
-      force = forceobj_init(forcer, (Body *)list_get(bodies, 0), (Body *)list_get(bodies, 1));
+    assert(aux != NULL);
+    assert(list_size(bodies) <= 2);
+    ForceParams params = {{NULL, NULL}, {0}};
+    for (size_t k = 0; k < list_size(bodies); k++) {
+      params.bodies[k] = list_get(bodies, k);
     }
-    else if (list_size(bodies) == 1){
-      force = forceobj_init(forcer, (Body *)list_get(bodies, 0), NULL);
+    scene_add_force(scene, INDIVIDUAL_GROUP, forcer, aux, freer, params);
+}
+
+void scene_add_force_params(Scene *scene, ForceCreator forcer, ForceParams params) {
+    scene_add_force(scene, INDIVIDUAL_GROUP, forcer, NULL, NULL, params);
+}
+
+void scene_add_batched_force(Scene *scene, ForceKernel kernel, ForceParams params,
+                             void *aux, FreeFunc freer) {
+    assert(kernel != NULL);
+    size_t g = scene_add_force_group(scene, kernel, NULL, false);
+    scene_add_force(scene, g, NULL, aux, freer, params);
+}
+
+void scene_add_batched_impulse(Scene *scene, ForceKernel kernel, ForceParams params,
+                               void *aux, FreeFunc freer) {
+    assert(kernel != NULL);
+    size_t g = scene_add_force_group(scene, kernel, NULL, true);
+    scene_add_force(scene, g, NULL, aux, freer, params);
+}
+
+void scene_add_slot_force(Scene *scene, SlotKernel kernel, ForceParams params) {
+    assert(kernel != NULL);
+    size_t g = scene_add_force_group(scene, NULL, kernel, false);
+    scene_add_force(scene, g, NULL, NULL, NULL, params);
+}
+
+size_t scene_forces(Scene *scene) {
+    return scene->num_forces;
+}
+
+void *scene_alloc_aux(Scene *scene, size_t size) {
+    size_t i = 0;
+    while ((size_t) MIN_AUX_SIZE << i < size) {
+      i++;
     }
-    list_add(scene->forces, force);
-    list_add(scene->auxes, aux);
-    if (freer) {
-        list_add(scene->auxfreers, freer);
-    } else {
-        list_add(scene->auxfreers, NULL);
+    assert(i < NUM_AUX_POOLS);
+    if (scene->aux_pools[i] == NULL) {
+      scene->aux_pools[i] = pool_init(MIN_AUX_SIZE << i, AUX_POOL_CHUNK, false);
     }
+    return pool_alloc(scene->aux_pools[i]);
 }
 
-void scene_tick(Scene *scene, double dt) {
-    size_t num_bodies = scene_bodies(scene);
+void *scene_scratch(Scene *scene, size_t size) {
+    return arena_alloc(scene->scratch[scene_worker], size);
+}
+
+void scene_add_group_collision(
+    Scene *scene, size_t group1, size_t group2,
+    CollisionHandler handler, void *aux, FreeFunc freer) {
+    CollisionRule *rule = malloc(sizeof(CollisionRule));
+    assert(rule);
+    *rule = (CollisionRule) {group1, group2, handler, aux, freer, NULL};
+    list_add(scene->collision_rules, rule);
+}
 
+void scene_add_group_contact_listener(
+    Scene *scene, size_t group1, size_t group2,
+    ContactListener listener, void *aux, FreeFunc freer) {
+    CollisionRule *rule = malloc(sizeof(CollisionRule));
+    assert(rule);
+    *rule = (CollisionRule) {group1, group2, NULL, aux, freer, listener};
+    list_add(scene->collision_rules, rule);
+}
 
+void scene_add_group_solver(Scene *scene, size_t group1, size_t group2, double elasticity) {
+    CollisionRule *rule = malloc(sizeof(CollisionRule));
+    assert(rule);
+    *rule = (CollisionRule) {group1, group2, NULL, NULL, NULL, NULL, elasticity};
+    list_add(scene->collision_rules, rule);
+}
 
-    // applies all the forces, storing in the bodies
-    size_t num_forces = list_size(scene->forces);
-    if (num_forces != 0) {
-      for (size_t i = 0; i < num_forces; i ++) {
-          ForceObj *f = (ForceObj *)list_get(scene->forces, i);
-          ForceCreator force = f->forcer;
-          void *aux = list_get(scene->auxes, i);
-          assert(force != NULL);
-          assert(aux != NULL);
-          force(aux);
-      }
-    }
-    // removes ForceObj (ForceCreator), auxes, auxfreers
-    // if associated bodies are removed
-    for (size_t i = 0; i < num_bodies; i++) {
+void scene_set_solver_iterations(Scene *scene, size_t iterations) {
+    scene->solver_iterations = iterations;
+}
+
+size_t scene_contacts(Scene *scene) {
+    return contact_table_size(scene->contacts);
+}
+
+ContactPair *scene_get_contact(Scene *scene, size_t index) {
+    return contact_table_get(scene->contacts, index);
+}
+
+ContactPair *scene_find_contact(Scene *scene, Body *body1, Body *body2) {
+    return contact_table_find(scene->contacts, body1, body2);
+}
+
+void scene_set_broadphase(Scene *scene, BroadphaseType type) {
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
       Body *body = list_get(scene->bodies, i);
-      for(size_t j = 0; j < list_size(scene->forces); ++j){
-        ForceObj *f = (ForceObj *)list_get(scene->forces, j);
-        if (body_is_removed(body)) {
-          if (f->assoc_body1 == body || f->assoc_body2 == body) {
-            free(list_remove(scene->forces, j));
-            ((FreeFunc)list_get(scene->auxfreers, j))(list_remove(scene->auxes, j));
-            list_remove(scene->auxfreers, j);
-            --j;
-          }
-        }
+      if (!body_is_static(body)) {
+        scene_release_proxy(scene, body);
       }
     }
+    scene->broadphase = type;
+    scene->broadphase_stale = true;
+}
 
-    // ticks all the bodies
-    for (size_t i = 0; i < num_bodies; i++) {
+/* Rebuilds the tree of static bodies' boxes after a static body
+   was moved, or was removed and so moved another's slot. */
+void scene_build_static_tree(Scene *scene) {
+    BodyStore *store = scene->static_store;
+    aabb_tree_free(scene->static_tree);
+    scene->static_tree = aabb_tree_init(STATIC_TREE_MARGIN);
+    for (size_t slot = 0; slot < store->size; slot++) {
+      Body *body = store->handles[slot];
+      body_set_broadphase_proxy(body, aabb_tree_insert(scene->static_tree, slot, body_get_aabb(body)));
+    }
+    store->changed = false;
+}
+
+/* Gets the body a pair id from scene_find_pairs() refers to */
+Body *scene_pair_body(Scene *scene, size_t id) {
+    return id < scene->static_ids ? list_get(scene->bodies, id)
+        : scene->static_store->handles[id - scene->static_ids];
+}
+
+/* What a query of the static tree for one moving body adds pairs to */
+typedef struct {
+    PairBuffer *pairs;
+    size_t id;
+    size_t static_ids;
+} StaticQuery;
+
+void scene_add_static_pair(size_t slot, void *aux) {
+    StaticQuery *query = aux;
+    pair_buffer_add(query->pairs, query->id, query->static_ids + slot);
+}
+
+/* Finds the pairs of grouped bodies whose boxes overlap.
+   Pairs are given by the bodies' indices in the scene, except that static
+   bodies are given by their slots after static_ids (see scene_pair_body()).
+   Static bodies are only in the static tree, which only moving bodies
+   are looked up in, so no pair has two static bodies. */
+void scene_find_pairs(Scene *scene) {
+    pair_buffer_clear(scene->pairs);
+    size_t num_bodies = scene_bodies(scene);
+    scene->static_ids = num_bodies;
+    scene->broadphase_stale = false;
+    if (scene->broadphase == BROADPHASE_GRID) {
+      spatial_hash_clear(scene->grid);
+      for (size_t i = 0; i < num_bodies; i++) {
+        Body *body = list_get(scene->bodies, i);
+        if (body_get_collision_group(body) != 0 && !body_is_removed(body) && !body_is_static(body)) {
+          spatial_hash_insert(scene->grid, i, body_get_aabb(body));
+        }
+      }
+      spatial_hash_find_pairs(scene->grid, scene->pairs);
+    }
+    else if (scene->broadphase == BROADPHASE_SWEEP) {
+      for (size_t i = 0; i < num_bodies; i++) {
+        Body *body = list_get(scene->bodies, i);
+        size_t proxy = body_get_broadphase_proxy(body);
+        if (body_is_static(body)) {
+          continue;
+        } else if (body_get_collision_group(body) == 0 || body_is_removed(body)) {
+          scene_release_proxy(scene, body);
+        } else if (proxy == NO_PROXY) {
+          body_set_broadphase_proxy(body, sweep_insert(scene->sweep, i, body_get_aabb(body)));
+        } else {
+          sweep_update(scene->sweep, proxy, i, body_get_aabb(body));
+        }
+      }
+      sweep_find_pairs(scene->sweep, scene->pairs);
+    }
+    else if (scene->broadphase == BROADPHASE_TREE) {
+      for (size_t i = 0; i < num_bodies; i++) {
         Body *body = list_get(scene->bodies, i);
-        if (body_is_removed(body)) {
-            /* Modifying the list while iterating though it. */
-            body_free(list_remove(scene->bodies, i));
-            i--;
+        size_t proxy = body_get_broadphase_proxy(body);
+        if (body_is_static(body)) {
+          continue;
+        } else if (body_get_collision_group(body) == 0 || body_is_removed(body)) {
+          scene_release_proxy(scene, body);
+        } else if (proxy == NO_PROXY) {
+          body_set_broadphase_proxy(body, aabb_tree_insert(scene->tree, i, body_get_aabb(body)));
         } else {
-            body_tick(body, dt);
+          aabb_tree_move(scene->tree, proxy, i, body_get_aabb(body));
+        }
+      }
+      aabb_tree_find_pairs(scene->tree, scene->pairs);
+    }
+
+    if (scene->static_store->size > 0) {
+      if (scene->static_store->changed) {
+        scene_build_static_tree(scene);
+      }
+      for (size_t i = 0; i < num_bodies; i++) {
+        Body *body = list_get(scene->bodies, i);
+        if (body_get_collision_group(body) != 0 && !body_is_removed(body) && !body_is_static(body)) {
+          StaticQuery query = {scene->pairs, i, num_bodies};
+          aabb_tree_query(scene->static_tree, body_get_aabb(body), scene_add_static_pair, &query);
+        }
+      }
+    }
+    pair_buffer_sort(scene->pairs);
+}
+
+/* Whether any collision rule applies to bodies in two groups */
+bool scene_has_rule(Scene *scene, size_t group1, size_t group2) {
+    for (size_t r = 0; r < list_size(scene->collision_rules); r++) {
+      CollisionRule *rule = list_get(scene->collision_rules, r);
+      if ((rule->group1 == group1 && rule->group2 == group2)
+          || (rule->group1 == group2 && rule->group2 == group1)) {
+        return true;
+      }
+    }
+    return false;
+}
+
+/* The first rule that solves contacts between bodies in two groups, or NULL */
+CollisionRule *scene_solver_rule(Scene *scene, size_t group1, size_t group2) {
+    for (size_t r = 0; r < list_size(scene->collision_rules); r++) {
+      CollisionRule *rule = list_get(scene->collision_rules, r);
+      if (rule->handler == NULL && rule->listener == NULL
+          && ((rule->group1 == group1 && rule->group2 == group2)
+              || (rule->group1 == group2 && rule->group2 == group1))) {
+        return rule;
+      }
+    }
+    return NULL;
+}
+
+/* Replaces a contact's points with a manifold's, carrying over
+   the impulse of each point whose features are the same as last tick */
+void scene_update_points(ContactPair *contact, const ContactManifold *manifold) {
+    ContactPoint points[MAX_MANIFOLD_POINTS];
+    for (size_t i = 0; i < manifold->count; i++) {
+      points[i] = manifold->points[i];
+      for (size_t j = 0; j < contact->num_points; j++) {
+        if (contact->points[j].id == points[i].id) {
+          points[i].impulse = contact->points[j].impulse;
         }
-        num_bodies = scene_bodies(scene);
+      }
     }
+    for (size_t i = 0; i < manifold->count; i++) {
+      contact->points[i] = points[i];
+    }
+    contact->num_points = manifold->count;
+}
+
+/* Whether a body can move bodies it touches: it is awake and either
+   has a finite mass or is moving */
+bool scene_body_disturbs(Body *body) {
+    if (body_is_asleep(body)) {
+      return false;
+    }
+    Vector velocity = body_get_velocity(body);
+    return body_get_mass(body) < INFINITY || velocity.x != 0 || velocity.y != 0;
+}
+
+/* Wakes a sleeping body touched by one that can move it.
+   Bodies with infinite mass cannot be moved, so they stay asleep. */
+void scene_wake_touched(Body *body, Body *other) {
+    if (body_is_asleep(body) && body_get_mass(body) < INFINITY && scene_body_disturbs(other)) {
+      body_wake(body);
+    }
+}
+
+/* Runs the collision rules that apply to a touching pair of bodies,
+   with axis pointing from body1 towards body2. Handlers are only called
+   if the bodies are approaching; listeners are told about the event. */
+void scene_run_rules(Scene *scene, Body *body1, Body *body2, ContactEvent event,
+                     ContactPair *contact, Vector axis, bool approaching) {
+    size_t group1 = body_get_collision_group(body1);
+    size_t group2 = body_get_collision_group(body2);
+    for (size_t r = 0; r < list_size(scene->collision_rules); r++) {
+      if (body_is_removed(body1) || body_is_removed(body2)) {
+        break;
+      }
+      CollisionRule *rule = list_get(scene->collision_rules, r);
+      bool forward = rule->group1 == group1 && rule->group2 == group2;
+      bool backward = !forward && rule->group1 == group2 && rule->group2 == group1;
+      if (!forward && !backward) {
+        continue;
+      }
+      Body *first = forward ? body1 : body2, *second = forward ? body2 : body1;
+      if (rule->listener != NULL) {
+        rule->listener(event, first, second, contact, rule->aux);
+      } else if (rule->handler != NULL && approaching) {
+        rule->handler(first, second, forward ? axis : vec_negate(axis), rule->aux);
+      }
+    }
+}
+
+/* Runs the collision rules on the pairs of grouped bodies
+   whose boxes the broadphase finds overlapping.
+   Each pair is tested once, however many rules apply to it. Pairs that
+   touch are remembered across ticks, which gives contact listeners their
+   begin/persist/end events and lets the narrowphase warm-start.
+   Pairs where nothing is awake to move either body are not tested,
+   and their contacts are kept as they were. */
+void scene_collide_groups(Scene *scene) {
+    size_t num_rules = list_size(scene->collision_rules);
+    if (num_rules == 0) {
+      return;
+    }
+    scene->tick++;
+    scene_find_pairs(scene);
+
+    for (size_t p = 0; p < scene->pairs->size; p++) {
+      Body *body1 = scene_pair_body(scene, scene->pairs->pairs[p].first);
+      Body *body2 = scene_pair_body(scene, scene->pairs->pairs[p].second);
+      size_t group1 = body_get_collision_group(body1);
+      size_t group2 = body_get_collision_group(body2);
+      // a handler may have removed one of the bodies
+      if (body_is_removed(body1) || body_is_removed(body2) || !scene_has_rule(scene, group1, group2)) {
+        continue;
+      }
+      ContactPair *contact = contact_table_find(scene->contacts, body1, body2);
+      if ((body_is_asleep(body1) || body_is_asleep(body2))
+          && !scene_body_disturbs(body1) && !scene_body_disturbs(body2)) {
+        // nothing in the pair can have moved, so neither can its contact
+        if (contact != NULL) {
+          contact->tick = scene->tick;
+        }
+        continue;
+      }
+      ContactEvent event = contact != NULL ? CONTACT_PERSIST : CONTACT_BEGIN;
+      GjkCache *cache = contact != NULL ? &contact->cache : NULL;
+      // the cache and contact points are in the order the contact keeps,
+      // which differs from the pair's when the contact was added elsewhere
+      bool flipped = contact != NULL && contact->body1 != body1;
+      Body *first = flipped ? body2 : body1;
+      Body *second = flipped ? body1 : body2;
+      // solved pairs need their contact points
+      ContactManifold manifold = {false};
+      CollisionInfo info;
+      if (scene_solver_rule(scene, group1, group2) != NULL) {
+        manifold = find_body_manifold(first, second, cache);
+        info = (CollisionInfo) {manifold.collided, manifold.axis, manifold.depth};
+      } else {
+        info = find_body_collision(first, second, cache);
+      }
+      if (flipped) {
+        info.axis = vec_negate(info.axis);
+      }
+      if (!info.collided) {
+        continue;
+      }
+      if (contact == NULL) {
+        contact = contact_table_add(scene->contacts, body1, body2);
+      }
+      contact->axis = contact->body1 == body1 ? info.axis : vec_negate(info.axis);
+      contact->depth = info.depth;
+      contact->tick = scene->tick;
+      scene_update_points(contact, &manifold);
+      scene_wake_touched(body1, body2);
+      scene_wake_touched(body2, body1);
+
+      // Only bodies moving towards each other are passed to collision handlers
+      bool approaching = vec_dot(vec_subtract(body_get_velocity(body1), body_get_velocity(body2)),
+                                 vec_subtract(body_get_centroid(body2), body_get_centroid(body1))) > 0;
+      scene_run_rules(scene, body1, body2, event, contact, info.axis, approaching);
+    }
+
+    // the pairs not touched this tick have stopped touching
+    for (size_t i = 0; i < contact_table_size(scene->contacts); i++) {
+      ContactPair *contact = contact_table_get(scene->contacts, i);
+      if (contact->tick != scene->tick) {
+        scene_notify_contact(scene, CONTACT_END, contact);
+        contact_table_remove(scene->contacts, i);
+        i--;
+      }
+    }
+}
+
+/* Where a body is in the solver's body array: awake bodies by their slots,
+   and every body the solver cannot move in the one slot after them */
+size_t scene_solver_index(Scene *scene, Body *body) {
+    if (body_is_static(body) || body_is_asleep(body)) {
+      return scene->store->awake;
+    }
+    return body_get_slot(body);
+}
+
+/* Where the impulse a solver row finds goes back to */
+typedef struct {
+    ContactPair *contact;
+    /* The index of the row's contact point, unused if the contact has none */
+    size_t point;
+} SolvedRow;
+
+/* Solves the contacts found this tick whose groups have a solver rule
+   (see scene_add_group_solver()), warm-starting each from its impulse
+   last tick. The impulses are added to the bodies' impulses,
+   so integrating the bodies applies them. */
+void scene_solve_contacts(Scene *scene, double dt) {
+    size_t count = 0;
+    for (size_t i = 0; i < contact_table_size(scene->contacts); i++) {
+      ContactPair *contact = contact_table_get(scene->contacts, i);
+      if (contact->tick == scene->tick) {
+        count += contact->num_points > 0 ? contact->num_points : 1;
+      }
+    }
+    if (count == 0) {
+      return;
+    }
+    BodyStore *store = scene->store;
+    size_t awake = store->awake;
+    SolverBody *bodies = scene_scratch(scene, (awake + 1) * sizeof(SolverBody));
+    for (size_t i = 0; i < awake; i++) {
+      Vector push = vec_add(store->impulse[i], vec_multiply(dt, store->force[i]));
+      bodies[i] = (SolverBody) {
+          vec_add(store->velocity[i], vec_multiply(store->inv_mass[i], push)),
+          store->velocity[i], store->inv_mass[i]
+      };
+    }
+    bodies[awake] = (SolverBody) {VEC_ZERO, VEC_ZERO, 0};
+
+    // one row per contact point, or per contact if it has no points
+    SolverContact *rows = scene_scratch(scene, count * sizeof(SolverContact));
+    SolvedRow *solved = scene_scratch(scene, count * sizeof(SolvedRow));
+    size_t num_rows = 0;
+    for (size_t i = 0; i < contact_table_size(scene->contacts); i++) {
+      ContactPair *contact = contact_table_get(scene->contacts, i);
+      if (contact->tick != scene->tick) {
+        continue;
+      }
+      CollisionRule *rule = scene_solver_rule(scene, body_get_collision_group(contact->body1),
+                                              body_get_collision_group(contact->body2));
+      size_t index1 = scene_solver_index(scene, contact->body1);
+      size_t index2 = scene_solver_index(scene, contact->body2);
+      if (rule == NULL || index1 == index2) {
+        continue;
+      }
+      if (contact->num_points == 0) {
+        rows[num_rows] = (SolverContact) {
+            index1, index2, contact->axis, contact->depth, rule->elasticity, contact->normal_impulse
+        };
+        solved[num_rows++] = (SolvedRow) {contact, 0};
+      }
+      for (size_t k = 0; k < contact->num_points; k++) {
+        rows[num_rows] = (SolverContact) {
+            index1, index2, contact->axis, contact->points[k].depth, rule->elasticity,
+            contact->points[k].impulse
+        };
+        solved[num_rows++] = (SolvedRow) {contact, k};
+      }
+      // summed from the points' impulses below
+      if (contact->num_points > 0) {
+        contact->normal_impulse = 0;
+      }
+    }
+    solver_solve(bodies, rows, num_rows, dt, scene->solver_iterations);
+
+    for (size_t i = 0; i < num_rows; i++) {
+      ContactPair *contact = solved[i].contact;
+      if (contact->num_points == 0) {
+        contact->normal_impulse = rows[i].impulse;
+      } else {
+        contact->points[solved[i].point].impulse = rows[i].impulse;
+        contact->normal_impulse += rows[i].impulse;
+      }
+      Vector impulse = vec_multiply(rows[i].impulse, rows[i].normal);
+      if (rows[i].body1 < awake) {
+        store->impulse[rows[i].body1] = vec_subtract(store->impulse[rows[i].body1], impulse);
+      }
+      if (rows[i].body2 < awake) {
+        store->impulse[rows[i].body2] = vec_add(store->impulse[rows[i].body2], impulse);
+      }
+    }
+}
+
+/* The earliest impact found so far while sweeping one bullet
+   over what was left of the tick after its last impact */
+typedef struct {
+    Scene *scene;
+    Body *bullet;
+    size_t index;
+    /* The body the bullet last stopped at, which it is moving away from */
+    Body *last;
+    /* How far the bullet moved over the rest of the tick */
+    Vector motion;
+    /* The fraction of the tick that was left */
+    double span;
+    /* The body it hits first, or NULL, and when and along which axis */
+    Body *other;
+    double toi;
+    Vector axis;
+} BulletSweep;
+
+/* How far a body moved during the tick, which is nothing
+   for bodies that were not integrated */
+Vector scene_body_motion(Body *body) {
+    if (body_is_static(body) || body_is_asleep(body)) {
+      return VEC_ZERO;
+    }
+    return vec_subtract(body_get_centroid(body), body_get_interpolated_centroid(body, 0));
+}
+
+/* The box a body covers over the whole tick */
+AABB scene_swept_aabb(Body *body, Vector motion) {
+    AABB box = body_get_aabb(body);
+    return aabb_union(box, (AABB) {vec_subtract(box.min, motion), vec_subtract(box.max, motion)});
+}
+
+/* Finds when a bullet hits another body during the tick, keeping the
+   earliest hit. Pairs touching at the end of the tick are skipped,
+   since the discrete test at the start of the next one finds them. */
+void scene_sweep_pair(BulletSweep *sweep, Body *other) {
+    Body *bullet = sweep->bullet;
+    if (other == sweep->last || body_is_removed(other)
+        || !scene_has_rule(sweep->scene, body_get_collision_group(bullet), body_get_collision_group(other))
+        || find_body_collision(bullet, other, NULL).collided) {
+      return;
+    }
+    Vector motion = vec_subtract(sweep->motion, vec_multiply(sweep->span, scene_body_motion(other)));
+    double toi;
+    Vector axis;
+    if (ccd_time_of_impact(ccd_body_shape(bullet), ccd_body_shape(other), motion, &toi, &axis)
+        && (sweep->other == NULL || toi < sweep->toi)) {
+      sweep->other = other;
+      sweep->toi = toi;
+      sweep->axis = axis;
+    }
+}
+
+void scene_sweep_static(size_t slot, void *aux) {
+    BulletSweep *sweep = aux;
+    scene_sweep_pair(sweep, sweep->scene->static_store->handles[slot]);
+}
+
+void scene_sweep_moving(size_t index, void *aux) {
+    BulletSweep *sweep = aux;
+    Body *other = list_get(sweep->scene->bodies, index);
+    // a pair of bullets is swept once, by the first of them
+    if (index == sweep->index || (body_is_bullet(other) && index < sweep->index)) {
+      return;
+    }
+    scene_sweep_pair(sweep, other);
+}
+
+/* Calls a function with the index of each grouped moving body whose box,
+   when the pairs were last found, overlaps a box */
+void scene_query_moving(Scene *scene, AABB box, BroadphaseQueryHandler handler, void *aux) {
+    if (scene->broadphase == BROADPHASE_GRID) {
+      spatial_hash_query(scene->grid, box, handler, aux);
+    }
+    else if (scene->broadphase == BROADPHASE_SWEEP) {
+      sweep_query(scene->sweep, box, handler, aux);
+    }
+    else if (scene->broadphase == BROADPHASE_TREE) {
+      aabb_tree_query(scene->tree, box, handler, aux);
+    }
+}
+
+/* Moves a body back along its motion to where it was at a time of impact */
+void scene_rewind_body(Scene *scene, Body *body, Vector motion, double toi) {
+    if (motion.x != 0 || motion.y != 0) {
+      Vector *position = &scene->store->position[body_get_slot(body)];
+      *position = vec_subtract(*position, vec_multiply(1 - toi, motion));
+    }
+}
+
+/* Applies a body's impulses at once and moves it on with its new velocity
+   for the rest of the tick. */
+void scene_finish_body(Scene *scene, Body *body, double rest) {
+    if (body_is_static(body) || body_is_asleep(body)) {
+      return;
+    }
+    BodyStore *store = scene->store;
+    size_t slot = body_get_slot(body);
+    body_store_apply_impulses(store, slot, slot + 1);
+    store->position[slot] = vec_add(store->position[slot], vec_multiply(rest, store->velocity[slot]));
+}
+
+/* Solves a bullet's contact on its own at its time of impact,
+   with the forces of the tick already integrated. */
+void scene_solve_impact(Scene *scene, ContactPair *contact, double elasticity, double dt) {
+    SolverBody bodies[2];
+    Body *pair[2] = {contact->body1, contact->body2};
+    for (size_t i = 0; i < 2; i++) {
+      bodies[i] = (SolverBody) {body_get_velocity(pair[i]), body_get_velocity(pair[i]), 0};
+      if (!body_is_static(pair[i]) && !body_is_asleep(pair[i])) {
+        bodies[i].inv_mass = 1 / body_get_mass(pair[i]);
+      }
+    }
+    SolverContact row = {0, 1, contact->axis, 0, elasticity, 0};
+    solver_solve(bodies, &row, 1, dt, 1);
+    contact->normal_impulse = row.impulse;
+    body_add_impulse(pair[0], vec_multiply(-row.impulse, row.normal));
+    body_add_impulse(pair[1], vec_multiply(row.impulse, row.normal));
+}
+
+/* Stops a bullet and the body it hit where they touched,
+   runs the pair's collision rules there, and moves both on
+   with the velocities the rules leave them for the rest of the tick. */
+void scene_bullet_impact(Scene *scene, BulletSweep *sweep, double dt) {
+    Body *bullet = sweep->bullet, *other = sweep->other;
+    scene_rewind_body(scene, bullet, sweep->motion, sweep->toi);
+    scene_rewind_body(scene, other, vec_multiply(sweep->span, scene_body_motion(other)), sweep->toi);
+
+    ContactPair *contact = contact_table_find(scene->contacts, bullet, other);
+    ContactEvent event = contact != NULL ? CONTACT_PERSIST : CONTACT_BEGIN;
+    if (contact == NULL) {
+      contact = contact_table_add(scene->contacts, bullet, other);
+    }
+    contact->axis = contact->body1 == bullet ? sweep->axis : vec_negate(sweep->axis);
+    contact->depth = 0;
+    contact->num_points = 0;
+    contact->tick = scene->tick;
+    scene_wake_touched(other, bullet);
+    // the time of impact is when they start closing the last of the gap
+    scene_run_rules(scene, bullet, other, event, contact, sweep->axis, true);
+    CollisionRule *rule = scene_solver_rule(scene, body_get_collision_group(bullet),
+                                            body_get_collision_group(other));
+    if (rule != NULL && !body_is_removed(bullet) && !body_is_removed(other)) {
+      scene_solve_impact(scene, contact, rule->elasticity, dt);
+    }
+
+    double rest = (1 - sweep->toi) * sweep->span * dt;
+    scene_finish_body(scene, bullet, rest);
+    scene_finish_body(scene, other, rest);
+}
+
+/* Sweeps a bullet from where it last stopped to where it ends the tick,
+   and stops it at the first body it would otherwise pass through
+   (see scene_bullet_impact()). Only the bodies whose boxes overlap its path
+   are swept: static ones from the static tree, and moving ones from the
+   broadphase, by where they were when the pairs were found. So a bullet
+   can miss a body that moved into its path from outside it this tick.
+   This repeats over what is left of the tick after each impact,
+   up to MAX_BULLET_IMPACTS times.
+   Returns whether the bullet hit anything. */
+bool scene_sweep_bullet(Scene *scene, size_t index, double dt) {
+    Body *bullet = list_get(scene->bodies, index);
+    // where the bullet was when it last stopped, and how much of the tick was left
+    Vector from = body_get_interpolated_centroid(bullet, 0);
+    double span = 1;
+    Body *last = NULL;
+    size_t impacts = 0;
+    while (impacts < MAX_BULLET_IMPACTS && !body_is_removed(bullet)) {
+      Vector motion = vec_subtract(body_get_centroid(bullet), from);
+      BulletSweep sweep = {scene, bullet, index, last, motion, span, NULL, 1, VEC_ZERO};
+      AABB box = scene_swept_aabb(bullet, motion);
+      aabb_tree_query(scene->static_tree, box, scene_sweep_static, &sweep);
+      scene_query_moving(scene, box, scene_sweep_moving, &sweep);
+      if (sweep.other == NULL) {
+        break;
+      }
+      scene_bullet_impact(scene, &sweep, dt);
+      impacts++;
+      from = vec_add(from, vec_multiply(sweep.toi, motion));
+      span *= 1 - sweep.toi;
+      last = sweep.other;
+    }
+    return impacts > 0;
+}
+
+/* Sweeps each awake grouped bullet over the tick (see scene_sweep_bullet()),
+   against the bodies that were in the scene when the sweep began.
+   If bodies were added or removed since the pairs were found,
+   they are found again first, so the broadphase matches the scene.
+   Returns whether any bullet hit something, which may have removed bodies. */
+bool scene_sweep_bullets(Scene *scene, double dt) {
+    if (list_size(scene->collision_rules) == 0) {
+      return false;
+    }
+    if (scene->static_store->changed) {
+      scene_build_static_tree(scene);
+    }
+    bool any_hit = false;
+    bool stale = scene->broadphase_stale;
+    size_t num_bodies = scene_bodies(scene);
+    for (size_t i = 0; i < num_bodies; i++) {
+      Body *bullet = list_get(scene->bodies, i);
+      if (!body_is_bullet(bullet) || body_get_collision_group(bullet) == 0
+          || body_is_removed(bullet) || body_is_static(bullet) || body_is_asleep(bullet)) {
+        continue;
+      }
+      if (stale) {
+        scene_find_pairs(scene);
+        stale = false;
+      }
+      if (scene_sweep_bullet(scene, i, dt)) {
+        any_hit = true;
+      }
+    }
+    return any_hit;
+}
+
+/* Sets the number of slots the island forest has space for. */
+void scene_reserve_islands(Scene *scene, size_t capacity) {
+    scene->island_parents = scene_grow_array(scene->island_parents, sizeof(size_t), capacity);
+    scene->island_idle = scene_grow_array(scene->island_idle, sizeof(double), capacity);
+    scene->island_ids = scene_grow_array(scene->island_ids, sizeof(size_t), capacity);
+    scene->island_capacity = capacity;
+}
+
+void scene_set_sleep(Scene *scene, double velocity, double force, double time) {
+    assert(velocity >= 0 && force >= 0 && time > 0);
+    scene->sleep_velocity = velocity;
+    scene->sleep_force = force;
+    scene->sleep_time = time;
+    if (time == INFINITY) {
+      BodyStore *store = scene->store;
+      while (store->awake < store->size) {
+        body_store_wake_island(store, store->island[store->awake]);
+      }
+    }
+    else if (scene->fixed && scene->island_capacity < scene->max_bodies) {
+      scene_reserve_islands(scene, scene->max_bodies);
+    }
+}
+
+size_t scene_awake_bodies(Scene *scene) {
+    return scene->store->awake;
+}
+
+/* Finds the root of a slot's tree in the island forest, halving its path */
+size_t scene_island_root(Scene *scene, size_t slot) {
+    size_t *parents = scene->island_parents;
+    while (parents[slot] != slot) {
+      parents[slot] = parents[parents[slot]];
+      slot = parents[slot];
+    }
+    return slot;
+}
+
+/* Puts two bodies in the same island if both are awake and can be moved.
+   Bodies with infinite mass would otherwise join everything resting on them
+   into one island. */
+void scene_island_join(Scene *scene, Body *body1, Body *body2) {
+    if (body1 == NULL || body2 == NULL || body_is_asleep(body1) || body_is_asleep(body2)
+        || body_get_mass(body1) == INFINITY || body_get_mass(body2) == INFINITY) {
+      return;
+    }
+    size_t root1 = scene_island_root(scene, body_get_slot(body1));
+    size_t root2 = scene_island_root(scene, body_get_slot(body2));
+    scene->island_parents[root1] = root2;
+}
+
+/* Wakes the islands of sleeping bodies that were given an impulse,
+   and discards the forces added to sleeping bodies.
+   The sleeping slots are contiguous, so this is cheap when none were pushed. */
+void scene_wake_pushed(Scene *scene) {
+    BodyStore *store = scene->store;
+    for (size_t i = store->awake; i < store->size; i++) {
+      if (store->impulse[i].x != 0 || store->impulse[i].y != 0) {
+        body_store_wake_island(store, store->island[i]);
+        // the slots checked so far may have been moved, so start again
+        i = store->awake - 1;
+        continue;
+      }
+      store->force[i] = VEC_ZERO;
+    }
+}
+
+/* Adds dt to the idle time of each awake body that is still enough to sleep,
+   and restarts the others'. Must run after the contacts are solved
+   and before the forces are integrated. */
+void scene_update_idle(Scene *scene, double dt) {
+    BodyStore *store = scene->store;
+    for (size_t i = 0; i < store->awake; i++) {
+      Vector velocity = store->velocity[i];
+      // a body at rest has balanced forces, whether from forces or impulses
+      Vector net = vec_add(store->force[i], vec_multiply(1 / dt, store->impulse[i]));
+      bool still = vec_len(velocity) < scene->sleep_velocity
+          && (store->inv_mass[i] == 0 || vec_len(net) < scene->sleep_force);
+      store->idle_time[i] = still ? store->idle_time[i] + dt : 0;
+    }
+}
+
+/* Puts to sleep each island of awake bodies that have all been idle
+   for sleep_time. Bodies are in the same island if they touch
+   or share a force creator. */
+void scene_sleep_islands(Scene *scene) {
+    BodyStore *store = scene->store;
+    size_t num_awake = store->awake;
+    if (num_awake > scene->island_capacity) {
+      assert(!scene->fixed);
+      size_t capacity = scene->island_capacity > 0 ? scene->island_capacity : 1;
+      while (capacity < num_awake) {
+        capacity *= GROWTH_FACTOR;
+      }
+      scene_reserve_islands(scene, capacity);
+    }
+    for (size_t i = 0; i < num_awake; i++) {
+      scene->island_parents[i] = i;
+      scene->island_ids[i] = 0;
+    }
+    for (size_t i = 0; i < contact_table_size(scene->contacts); i++) {
+      ContactPair *contact = contact_table_get(scene->contacts, i);
+      scene_island_join(scene, contact->body1, contact->body2);
+    }
+    for (size_t g = 0; g < scene->num_groups; g++) {
+      ForceGroup *group = &scene->groups[g];
+      for (size_t i = 0; i < group->size; i++) {
+        scene_island_join(scene, group->params[i].bodies[0], group->params[i].bodies[1]);
+      }
+    }
+
+    for (size_t i = 0; i < num_awake; i++) {
+      scene->island_idle[i] = INFINITY;
+    }
+    for (size_t i = 0; i < num_awake; i++) {
+      size_t root = scene_island_root(scene, i);
+      scene->island_idle[root] = fmin(scene->island_idle[root], store->idle_time[i]);
+    }
+    for (size_t i = 0; i < num_awake; i++) {
+      if (scene->island_parents[i] == i && scene->island_idle[i] >= scene->sleep_time) {
+        scene->island_ids[i] = ++scene->islands;
+      }
+    }
+    // Going down, each slot moved into i has already been checked
+    for (size_t i = num_awake; i-- > 0;) {
+      size_t island = scene->island_ids[scene_island_root(scene, i)];
+      if (island != 0) {
+        body_store_sleep(store, i, island);
+      }
+    }
+}
+
+void scene_set_threads(Scene *scene, size_t num_threads) {
+    assert(num_threads > 0);
+    if (scene->threads != NULL) {
+      for (size_t i = 0; i < thread_pool_size(scene->threads); i++) {
+        body_accumulator_free(scene->accumulators[i]);
+      }
+      for (size_t i = 1; i < thread_pool_size(scene->threads); i++) {
+        arena_free(scene->scratch[i]);
+      }
+      free(scene->accumulators);
+      thread_pool_free(scene->threads);
+      scene->threads = NULL;
+      scene->accumulators = NULL;
+    }
+    scene->scratch = realloc(scene->scratch, num_threads * sizeof(Arena *));
+    assert(scene->scratch != NULL);
+    scene->scratch_marks = realloc(scene->scratch_marks, num_threads * sizeof(size_t));
+    assert(scene->scratch_marks != NULL);
+    if (num_threads == 1) {
+      return;
+    }
+    scene->threads = thread_pool_init(num_threads);
+    scene->accumulators = malloc(num_threads * sizeof(BodyAccumulator *));
+    assert(scene->accumulators != NULL);
+    for (size_t i = 0; i < num_threads; i++) {
+      scene->accumulators[i] = body_accumulator_init();
+      if (scene->fixed) {
+        // so that resetting it during a tick never grows it
+        body_accumulator_reset(scene->accumulators[i], scene->max_bodies);
+      }
+      if (i > 0) {
+        scene->scratch[i] = arena_init(scene->scratch_size, scene->fixed);
+      }
+    }
+}
+
+size_t scene_get_threads(Scene *scene) {
+    return scene->threads == NULL ? 1 : thread_pool_size(scene->threads);
+}
+
+/* Sets up the stores a worker's slot kernels use. Forces on moving bodies
+   go where body_add_force() would put them, and forces on static bodies
+   into scratch space that is never read. */
+void scene_force_stores(Scene *scene, size_t worker, ForceStore *stores) {
+    BodyStore *store = scene->store;
+    Vector *force = scene->threads != NULL ? scene->accumulators[worker]->force : store->force;
+    stores[0] = (ForceStore) {store->position, store->velocity, store->inv_mass, force};
+    BodyStore *statics = scene->static_store;
+    Vector *discarded = scene_scratch(scene, statics->size * sizeof(Vector));
+    for (size_t i = 0; i < statics->size; i++) {
+        discarded[i] = VEC_ZERO;
+    }
+    stores[1] = (ForceStore) {statics->position, statics->velocity, statics->inv_mass, discarded};
+}
+
+/* Looks up where the bodies of a group's forces in [start, end) are. */
+void scene_locate_bodies(ForceGroup *group, size_t start, size_t end) {
+    for (size_t i = start; i < end; i++) {
+        for (size_t k = 0; k < 2; k++) {
+            Body *body = group->params[i].bodies[k];
+            group->locations[2 * i + k] = body != NULL
+                ? (BodySlot) {body_is_static(body), body_get_slot(body)} : (BodySlot) {0, 0};
+        }
+    }
+}
+
+/* Applies one worker's share of every group of forces, skipping the groups
+   that only add impulses unless impulses is true.
+   Each batched group is handed to its kernel in one call. */
+void scene_apply_forces(Scene *scene, size_t worker, size_t num_workers, bool impulses) {
+    ForceStore stores[2];
+    bool have_stores = false;
+    for (size_t g = 0; g < scene->num_groups; g++) {
+        ForceGroup *group = &scene->groups[g];
+        if (group->impulsive && !impulses) {
+            continue;
+        }
+        size_t start, end;
+        thread_pool_split(worker, num_workers, group->size, &start, &end);
+        if (start == end) {
+            continue;
+        }
+        if (group->slot_kernel != NULL) {
+            if (!have_stores) {
+                scene_force_stores(scene, worker, stores);
+                have_stores = true;
+            }
+            scene_locate_bodies(group, start, end);
+            group->slot_kernel(group->params + start, group->locations + 2 * start,
+                               end - start, stores);
+            continue;
+        }
+        if (group->kernel != NULL) {
+            group->kernel(group->params + start, group->auxes + start, end - start);
+            continue;
+        }
+        for (size_t i = start; i < end; i++) {
+            assert(group->forcers[i] != NULL);
+            group->forcers[i](group->auxes[i] != NULL ? group->auxes[i] : &group->params[i]);
+        }
+    }
+}
+
+/* What the workers of a parallel tick share */
+typedef struct {
+    Scene *scene;
+    double dt;
+    /* The part of a substep to integrate (see scene_integrate_range()) */
+    size_t stage;
+    /* Whether evaluating the forces runs the groups that only add impulses */
+    bool impulses;
+} TickJob;
+
+void scene_update_worlds_task(size_t worker, size_t num_workers, void *aux) {
+    Scene *scene = ((TickJob *) aux)->scene;
+    size_t start, end;
+    thread_pool_split(worker, num_workers, list_size(scene->bodies), &start, &end);
+    for (size_t i = start; i < end; i++) {
+        body_update_world(list_get(scene->bodies, i));
+    }
+}
+
+void scene_apply_forces_task(size_t worker, size_t num_workers, void *aux) {
+    TickJob *job = aux;
+    Scene *scene = job->scene;
+    BodyAccumulator *accumulator = scene->accumulators[worker];
+    body_accumulator_reset(accumulator, scene->store->size);
+    body_redirect_accumulation(scene->store, accumulator);
+    scene_worker = worker;
+    scene_apply_forces(scene, worker, num_workers, job->impulses);
+    scene_worker = 0;
+    body_redirect_accumulation(NULL, NULL);
+}
+
+void scene_reduce_task(size_t worker, size_t num_workers, void *aux) {
+    Scene *scene = ((TickJob *) aux)->scene;
+    size_t start, end;
+    thread_pool_split(worker, num_workers, scene->store->size, &start, &end);
+    body_store_reduce(scene->store, scene->accumulators, num_workers, start, end);
+}
+
+/* Runs one part of a substep of the scene's integrator on the awake slots
+   in [start, end). Stage 0 is given the forces accumulated at the start
+   of the substep, and each later stage the forces accumulated after
+   the stage before it. */
+void scene_integrate_range(Scene *scene, size_t start, size_t end, double dt, size_t stage) {
+    BodyStore *store = scene->store;
+    switch (scene->integrator) {
+      case INTEGRATOR_TRAPEZOID:
+        body_store_integrate(store, start, end, dt);
+        break;
+      case INTEGRATOR_SEMI_IMPLICIT_EULER:
+        body_store_kick(store, start, end, dt);
+        body_store_drift(store, start, end, dt);
+        break;
+      case INTEGRATOR_VERLET:
+        // the forces after the drift are kept for the next substep's first kick
+        body_store_kick(store, start, end, dt / 2);
+        if (stage == 0) {
+          body_store_drift(store, start, end, dt);
+        }
+        break;
+      case INTEGRATOR_RK4:
+        body_store_rk4_stage(store, start, end, dt, stage, scene->rk4_scratch);
+        break;
+    }
+}
+
+void scene_integrate_task(size_t worker, size_t num_workers, void *aux) {
+    TickJob *job = aux;
+    size_t start, end;
+    thread_pool_split(worker, num_workers, job->scene->store->awake, &start, &end);
+    scene_integrate_range(job->scene, start, end, job->dt, job->stage);
+}
+
+void scene_set_integrator(Scene *scene, IntegratorType type, size_t substeps) {
+    assert(substeps > 0);
+    scene->integrator = type;
+    scene->substeps = substeps;
+    if (type == INTEGRATOR_RK4 && scene->fixed && scene->rk4_capacity < scene->max_bodies) {
+      scene->rk4_scratch = scene_grow_array(scene->rk4_scratch,
+                                            RK4_STAGES * sizeof(Vector), scene->max_bodies);
+      scene->rk4_capacity = scene->max_bodies;
+    }
+}
+
+/* Runs every force creator, accumulating into the bodies' slots. */
+void scene_evaluate_forces(Scene *scene, TickJob *job) {
+    if (scene->threads == NULL) {
+      scene_apply_forces(scene, 0, 1, job->impulses);
+    }
+    else if (scene->num_forces > 0) {
+      // shapes are cached lazily, so fill the caches before workers read them
+      thread_pool_run(scene->threads, scene_update_worlds_task, job);
+      thread_pool_run(scene->threads, scene_apply_forces_task, job);
+      thread_pool_run(scene->threads, scene_reduce_task, job);
+    }
+}
+
+/* Runs the force creators again partway through a tick, except for the
+   groups that only add impulses, such as collisions.
+   Only their forces count; the impulses they add are discarded,
+   since the ones from the start of the tick have already been applied.
+   The scratch memory they take is released again, so a tick needs
+   no more of it than two evaluations, however many substeps it has. */
+void scene_reevaluate_forces(Scene *scene, TickJob *job) {
+    size_t num_threads = scene_get_threads(scene);
+    for (size_t i = 0; i < num_threads; i++) {
+      scene->scratch_marks[i] = arena_used(scene->scratch[i]);
+    }
+    scene_evaluate_forces(scene, job);
+    for (size_t i = 0; i < num_threads; i++) {
+      arena_rewind(scene->scratch[i], scene->scratch_marks[i]);
+    }
+    BodyStore *store = scene->store;
+    for (size_t i = 0; i < store->size; i++) {
+      store->impulse[i] = VEC_ZERO;
+    }
+}
+
+/* Runs one part of a substep on all the awake bodies */
+void scene_integrate_stage(Scene *scene, TickJob *job, size_t stage) {
+    job->stage = stage;
+    if (scene->threads == NULL) {
+      scene_integrate_range(scene, 0, scene->store->awake, job->dt, stage);
+    }
+    else {
+      thread_pool_run(scene->threads, scene_integrate_task, job);
+    }
+}
+
+/* Moves the awake bodies over a tick in the scene's substeps,
+   starting from the forces and impulses accumulated so far. */
+void scene_integrate(Scene *scene, double dt) {
+    BodyStore *store = scene->store;
+    TickJob job = {scene, dt / scene->substeps, 0, false};
+    body_store_save_previous(store, 0, store->awake);
+    if (scene->integrator == INTEGRATOR_TRAPEZOID && scene->substeps == 1) {
+      // the original scheme, in one pass over the store
+      scene_integrate_stage(scene, &job, 0);
+      return;
+    }
+    if (scene->integrator == INTEGRATOR_RK4 && store->awake > scene->rk4_capacity) {
+      assert(!scene->fixed);
+      scene->rk4_scratch = scene_grow_array(scene->rk4_scratch,
+                                            RK4_STAGES * sizeof(Vector), store->awake);
+      scene->rk4_capacity = store->awake;
+    }
+    body_store_apply_impulses(store, 0, store->awake);
+    for (size_t step = 0; step < scene->substeps; step++) {
+      // Verlet's forces are still those from the end of the last substep
+      if (step > 0 && scene->integrator != INTEGRATOR_VERLET) {
+        scene_reevaluate_forces(scene, &job);
+      }
+      scene_integrate_stage(scene, &job, 0);
+      if (scene->integrator == INTEGRATOR_VERLET) {
+        scene_reevaluate_forces(scene, &job);
+        scene_integrate_stage(scene, &job, 1);
+      }
+      else if (scene->integrator == INTEGRATOR_RK4) {
+        for (size_t stage = 1; stage < RK4_STAGES; stage++) {
+          scene_reevaluate_forces(scene, &job);
+          scene_integrate_stage(scene, &job, stage);
+        }
+      }
+    }
+    if (scene->integrator == INTEGRATOR_VERLET) {
+      for (size_t i = 0; i < store->awake; i++) {
+        store->force[i] = VEC_ZERO;
+      }
+    }
+}
+
+/* Takes the bodies marked for removal out of the scene, along with
+   the forces that depend on them. They give up their slots at once,
+   but are only freed at the end of the tick (see scene_free_reaped()). */
+void scene_reap_removed(Scene *scene) {
+    // the removal flags are contiguous, so this scan is cheap
+    // when (as in most ticks) no body was removed
+    bool any_removed = false;
+    for (size_t i = 0; i < scene->store->size; i++) {
+      if (scene->store->removed[i]) {
+        any_removed = true;
+        break;
+      }
+    }
+    for (size_t i = 0; i < scene->static_store->size && !any_removed; i++) {
+      any_removed = scene->static_store->removed[i];
+    }
+
+    if (any_removed) {
+      scene->broadphase_stale = true;
+      // removes each removed body along with the forces that depend on it
+      for (size_t i = 0; i < scene_bodies(scene); i++) {
+          Body *body = list_get(scene->bodies, i);
+          if (body_is_removed(body)) {
+              /* Modifying the list while iterating though it. */
+              list_remove(scene->bodies, i);
+              scene_remove_body_forces(scene, body);
+              scene_release_proxy(scene, body);
+              scene_end_body_contacts(scene, body);
+              body_detach(body);
+              list_add(scene->reaped, body);
+              i--;
+          }
+      }
+    }
+}
+
+/* Frees the bodies removed during the tick, once its passes are done */
+void scene_free_reaped(Scene *scene) {
+    while (list_size(scene->reaped) > 0) {
+      body_free(list_remove_back(scene->reaped));
+    }
+}
+
+void scene_tick(Scene *scene, double dt) {
+    TickJob job = {scene, dt, 0, true};
+    for (size_t i = 0; i < scene_get_threads(scene); i++) {
+      arena_reset(scene->scratch[i]);
+    }
+    // applies all the forces, storing in the bodies
+    scene_evaluate_forces(scene, &job);
+
+    scene_collide_groups(scene);
+    scene_reap_removed(scene);
+
+    scene_wake_pushed(scene);
+    scene_solve_contacts(scene, dt);
+    // after the solver, so the impulses holding up resting bodies count
+    if (scene->sleep_time < INFINITY) {
+      scene_update_idle(scene, dt);
+    }
+
+    // integrates all the awake bodies in passes over the store
+    scene_integrate(scene, dt);
+
+    if (scene_sweep_bullets(scene, dt)) {
+      scene_reap_removed(scene);
+    }
+
+    if (scene->sleep_time < INFINITY) {
+      scene_sleep_islands(scene);
+    }
+    scene_free_reaped(scene);
+}
+
+void scene_set_fixed_step(Scene *scene, double dt, size_t max_steps) {
+    assert(dt > 0 && max_steps > 0);
+    scene->step = dt;
+    scene->max_steps = max_steps;
+}
+
+size_t scene_step_fixed(Scene *scene, double frame_dt) {
+    scene->step_time += frame_dt;
+    size_t steps = 0;
+    while (scene->step_time >= scene->step && steps < scene->max_steps) {
+      scene_tick(scene, scene->step);
+      scene->step_time -= scene->step;
+      steps++;
+    }
+    if (scene->step_time >= scene->step) {
+      // too far behind to catch up, so drop the whole ticks that were missed
+      scene->step_time = fmod(scene->step_time, scene->step);
+    }
+    scene->alpha = scene->step_time / scene->step;
+    return steps;
+}
 
+double scene_step_alpha(Scene *scene) {
+    return scene->alpha;
 }
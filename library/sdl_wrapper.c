@@ -9,6 +9,7 @@
 
 #include "sdl_wrapper.h"
 #include "body.h"
+#include "vector_batch.h"
 
 #define WINDOW_TITLE "CS 3"
 #define WINDOW_WIDTH 1000
@@ -151,11 +152,13 @@ Vector transform_coordinate(Vector v, Vector adjusted_center, double center_x, d
     return (Vector){center_x + pos.x, center_y - pos.y};
 }
 
-void sdl_draw_polygon_from_body(Body *body, RGBColor color) {
-    List *points = body_get_shape(body);
+/* Draws a body as if its centroid were at a given point */
+void sdl_draw_body_at(Body *body, RGBColor color, Vector centroid) {
+    ShapeView points = body_get_shape_view(body);
     // Check parameters
-    size_t n = list_size(points);
-    assert(n >= 3);
+    size_t n = points.size;
+    bool circle = body_get_kind(body) == BODY_CIRCLE;
+    assert(circle || n >= 3);
     assert(0 <= color.r && color.r <= 1);
     assert(0 <= color.g && color.g <= 1);
     assert(0 <= color.b && color.b <= 1);
@@ -192,18 +195,40 @@ void sdl_draw_polygon_from_body(Body *body, RGBColor color) {
     }
 
     /* Only render the body if it appears on screen. */
-    Vector adjusted_centroid = polygon_centroid(points);
+    Vector adjusted_centroid = centroid;
     double radius = body_get_radius(body) * scale * sqrt(2);
     Vector pos = vec_multiply(scale, vec_subtract(adjusted_centroid, adjusted_center));
     if (!is_on_screen((Vector){center_x + pos.x, center_y - pos.y}, radius)) {
+        free(x_points);
+        free(y_points);
         return;
     }
+    if (circle && (!body_get_image(body) || !is_SDL_image)) {
+        // Circles have no vertices, so they are drawn from their radius
+        Vector screen_center = transform_coordinate(adjusted_centroid, adjusted_center, center_x, center_y, scale);
+        filledCircleRGBA(
+            renderer,
+            screen_center.x, screen_center.y, body_get_radius(body) * scale,
+            color.r * 255, color.g * 255, color.b * 255, 255
+        );
+        free(x_points);
+        free(y_points);
+        return;
+    }
+    // Same map as transform_coordinate(), applied to all vertices at once,
+    // after moving them from the body's centroid to the one it is drawn at
+    Vector offset = vec_subtract(adjusted_center, vec_subtract(centroid, body_get_centroid(body)));
+    BatchTransform to_screen = {
+        scale, 0, 0, -scale,
+        {center_x - scale * offset.x, center_y + scale * offset.y}
+    };
+    Vector *screen = malloc(sizeof(Vector) * n);
+    vec_batch_transform(screen, points.vertices, n, to_screen);
     for (size_t i = 0; i < n; i++) {
-        Vector *vertex = list_get(points, i);
-        Vector point = transform_coordinate(*vertex, adjusted_center, center_x, center_y, scale);
-        x_points[i] = point.x;
-        y_points[i] = point.y;
+        x_points[i] = screen[i].x;
+        y_points[i] = screen[i].y;
     }
+    free(screen);
 
     if (!body_get_image(body) || !is_SDL_image) {
         // Draw polygon with the given color
@@ -214,11 +239,11 @@ void sdl_draw_polygon_from_body(Body *body, RGBColor color) {
         );
         free(x_points);
         free(y_points);
-        list_free(points);
     }
 
     else if (is_SDL_image) {
-        Vector centroid = body_get_centroid(body);
+        free(x_points);
+        free(y_points);
         SDL_Rect *dest = malloc(sizeof(SDL_Rect));
         int radius = (int) body_get_radius(body);
         Vector corner = VEC_ZERO;
@@ -250,6 +275,10 @@ void sdl_draw_polygon_from_body(Body *body, RGBColor color) {
     }
 }
 
+void sdl_draw_polygon_from_body(Body *body, RGBColor color) {
+    sdl_draw_body_at(body, color, body_get_centroid(body));
+}
+
 void sdl_init_textures(Scene *s);
 
 void sdl_show(void) {
@@ -274,17 +303,19 @@ void sdl_render_scene(Scene *s) {
       free(dest);
     }
 
+    // bodies are drawn between their last two ticks if the scene
+    // is stepped with scene_step_fixed(), and where they are otherwise
+    double alpha = scene_step_alpha(scene);
     size_t body_count = scene_bodies(scene);
     for (size_t i = 0; i < body_count; i++) {
         Body *body = scene_get_body(scene, i);
-        Vector original_body_position = body_get_centroid(body);
+        Vector position = body_get_interpolated_centroid(body, alpha);
         if (camera_is_on(scene_get_camera(scene))) {
             Vector camera_position = camera_get_position(scene_get_camera(scene));
-            Vector displacement_vector = displacement(original_body_position, camera_position, WINDOW_WIDTH, WINDOW_HEIGHT);
-            body_set_centroid(body, vec_add(camera_position, displacement_vector));
+            Vector displacement_vector = displacement(position, camera_position, WINDOW_WIDTH, WINDOW_HEIGHT);
+            position = vec_add(camera_position, displacement_vector);
         }
-        sdl_draw_polygon_from_body(body, body_get_color(body));
-        body_set_centroid(body, original_body_position);
+        sdl_draw_body_at(body, body_get_color(body), position);
     }
     sdl_show();
 }
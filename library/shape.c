@@ -0,0 +1,109 @@
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "shape.h"
+#include "polygon.h"
+#include "vector_batch.h"
+
+/* When the shape needs to grow */
+#define GROWTH_FACTOR 2
+
+typedef struct shape {
+    Vector *vertices;
+    size_t size;
+    size_t capacity;
+} Shape;
+
+Shape *shape_init(size_t initial_size) {
+    Shape *shape = malloc(sizeof(Shape));
+    assert(shape != NULL);
+    shape->capacity = initial_size > 0 ? initial_size : 1;
+    shape->vertices = malloc(shape->capacity * sizeof(Vector));
+    assert(shape->vertices != NULL);
+    shape->size = 0;
+    return shape;
+}
+
+Shape *shape_from_list(List *polygon) {
+    size_t size = list_size(polygon);
+    Shape *shape = shape_init(size);
+    for (size_t i = 0; i < size; i++) {
+        shape->vertices[i] = *(Vector *) list_get(polygon, i);
+    }
+    shape->size = size;
+    return shape;
+}
+
+List *shape_to_list(Shape *shape) {
+    List *polygon = list_init(shape->size, free);
+    for (size_t i = 0; i < shape->size; i++) {
+        list_add(polygon, vmalloc(shape->vertices[i]));
+    }
+    return polygon;
+}
+
+Shape *shape_copy(Shape *shape) {
+    Shape *copy = shape_init(shape->size);
+    for (size_t i = 0; i < shape->size; i++) {
+        copy->vertices[i] = shape->vertices[i];
+    }
+    copy->size = shape->size;
+    return copy;
+}
+
+void shape_free(Shape *shape) {
+    free(shape->vertices);
+    free(shape);
+}
+
+size_t shape_size(Shape *shape) {
+    return shape->size;
+}
+
+size_t shape_capacity(Shape *shape) {
+    return shape->capacity;
+}
+
+Vector shape_get(Shape *shape, size_t index) {
+    assert(index < shape->size);
+    return shape->vertices[index];
+}
+
+void shape_set(Shape *shape, size_t index, Vector vertex) {
+    assert(index < shape->size);
+    shape->vertices[index] = vertex;
+}
+
+void shape_add(Shape *shape, Vector vertex) {
+    if (shape->size == shape->capacity) {
+        shape->capacity *= GROWTH_FACTOR;
+        shape->vertices = realloc(shape->vertices, shape->capacity * sizeof(Vector));
+        assert(shape->vertices != NULL);
+    }
+    shape->vertices[shape->size++] = vertex;
+}
+
+Vector *shape_vertices(Shape *shape) {
+    return shape->vertices;
+}
+
+ShapeView shape_view(Shape *shape) {
+    return (ShapeView) {shape->vertices, shape->size};
+}
+
+double shape_area(Shape *shape) {
+    return polygon_view_area(shape_view(shape));
+}
+
+Vector shape_centroid(Shape *shape) {
+    return polygon_view_centroid(shape_view(shape));
+}
+
+void shape_translate(Shape *shape, Vector translation) {
+    vec_batch_translate(shape->vertices, shape->size, translation);
+}
+
+void shape_rotate(Shape *shape, double angle, Vector point) {
+    vec_batch_transform(shape->vertices, shape->vertices, shape->size,
+                        vec_batch_rotation(angle, point));
+}
@@ -6,60 +6,54 @@
 #define PAC_DTHETA ((2 * M_PI - PAC_ANG) / PAC_DELT)
 
 
-List *make_square(double side) {
-    /* List *sq = list_init(4, free);
-    list_add(sq, vmalloc((Vector){side/2,  side/2}));
-    list_add(sq, vmalloc((Vector){-side/2, side/2}));
-    list_add(sq, vmalloc((Vector){-side/2, -side/2}));
-    list_add(sq, vmalloc((Vector){side/2,  -side/2}));
-    return sq; */
-    return make_rectangle(side, side);
+Shape *shape_square(double side) {
+    return shape_rectangle(side, side);
 }
 
-List *make_rectangle(double height, double length) {
-  List *rec = list_init(4, free);
-  list_add(rec, vmalloc((Vector){length/2, height/2}));
-  list_add(rec, vmalloc((Vector){-length/2, height/2}));
-  list_add(rec, vmalloc((Vector){-length/2, -height/2}));
-  list_add(rec, vmalloc((Vector){length/2, -height/2}));
+Shape *shape_rectangle(double height, double length) {
+  Shape *rec = shape_init(4);
+  shape_add(rec, (Vector){length/2, height/2});
+  shape_add(rec, (Vector){-length/2, height/2});
+  shape_add(rec, (Vector){-length/2, -height/2});
+  shape_add(rec, (Vector){length/2, -height/2});
   return rec;
 }
 
-List *make_pacman(double radius){
-    List *pac = list_init(PAC_DELT+2, free);
-    list_add(pac, vmalloc(VEC_ZERO));
+Shape *shape_pacman(double radius){
+    Shape *pac = shape_init(PAC_DELT+2);
+    shape_add(pac, VEC_ZERO);
     Vector pac_point = (Vector){radius, 0};
     pac_point = vec_rotate(pac_point, PAC_ANG/2);
     for(int i = 0; i <= PAC_DELT; i++){
-      list_add(pac, vmalloc(pac_point));
+      shape_add(pac, pac_point);
       pac_point = vec_rotate(pac_point, PAC_DTHETA);
     }
     return pac;
 }
 
-List *make_ngon(int sides, double radius){
-  List *gon = list_init(sides, free);
+Shape *shape_ngon(int sides, double radius){
+  Shape *gon = shape_init(sides);
   Vector point = (Vector){0, radius};
   for(int i = 0; i < sides; i++){
-    list_add(gon, vmalloc(point));
+    shape_add(gon, point);
     point = vec_rotate(point, 2 * M_PI / sides);
   }
   return gon;
 }
 
-List *make_rounded_paddle(int sides, double radius, double angle){
-    List *gon = list_init(sides, free);
+Shape *shape_rounded_paddle(int sides, double radius, double angle){
+    Shape *gon = shape_init(sides);
     Vector point = (Vector){0, radius};
     point = vec_rotate(point, -1 * angle / 2);
     for (int i = 0; i < sides; i++){
-        list_add(gon, vmalloc(point));
+        shape_add(gon, point);
         point = vec_rotate(point, angle / sides);
     }
     return gon;
 }
 
-List *make_ship_shape(int detail, double height, double width) {
-    List *ship_shape = list_init(detail * 2, free);
+Shape *shape_ship(int detail, double height, double width) {
+    Shape *ship_shape = shape_init(detail * 2);
 
     for (int i = 0; i < detail; i ++) {
         Vector point = {
@@ -67,7 +61,7 @@ List *make_ship_shape(int detail, double height, double width) {
             height - i * i * height / detail / detail
         };
         point = vec_rotate(point, 3 * M_PI / 2);
-        list_add(ship_shape, vmalloc(point));
+        shape_add(ship_shape, point);
     }
     for (int i = detail - 1; i > 0; i --) {
         Vector point = {
@@ -75,7 +69,7 @@ List *make_ship_shape(int detail, double height, double width) {
             height - i * i * height / detail / detail
         };
         point = vec_rotate(point, 3 * M_PI / 2);
-        list_add(ship_shape, vmalloc(point));
+        shape_add(ship_shape, point);
     }
 
     return ship_shape;
@@ -83,7 +77,7 @@ List *make_ship_shape(int detail, double height, double width) {
 }
 
 
-List *make_n_star(int points, double radius){
+Shape *shape_n_star(int points, double radius){
     // smol and lomg are vectors to the dips and points of the star
     double theta = 2 * M_PI / (points * 2);
     Vector lomg = {
@@ -92,12 +86,49 @@ List *make_n_star(int points, double radius){
     };
     Vector smol = vec_multiply(.35, lomg);
     smol = vec_rotate(smol, theta);
-    List *star = list_init(points * 2, free);
+    Shape *star = shape_init(points * 2);
     for(int i = 0; i < points; i++){
-        list_add(star, vmalloc(lomg));
-        list_add(star, vmalloc(smol));
+        shape_add(star, lomg);
+        shape_add(star, smol);
         lomg = vec_rotate(lomg, 2 * theta);
         smol = vec_rotate(smol, 2 * theta);
     }
     return star;
 }
+
+/* The List-based constructors below are kept for existing callers;
+   they build the Shape and copy it into a list of vectors. */
+
+List *shape_into_list(Shape *shape) {
+    List *list = shape_to_list(shape);
+    shape_free(shape);
+    return list;
+}
+
+List *make_square(double side) {
+    return shape_into_list(shape_square(side));
+}
+
+List *make_rectangle(double height, double length) {
+    return shape_into_list(shape_rectangle(height, length));
+}
+
+List *make_pacman(double radius) {
+    return shape_into_list(shape_pacman(radius));
+}
+
+List *make_ngon(int sides, double radius) {
+    return shape_into_list(shape_ngon(sides, radius));
+}
+
+List *make_rounded_paddle(int sides, double radius, double angle) {
+    return shape_into_list(shape_rounded_paddle(sides, radius, angle));
+}
+
+List *make_ship_shape(int detail, double height, double width) {
+    return shape_into_list(shape_ship(detail, height, width));
+}
+
+List *make_n_star(int points, double radius) {
+    return shape_into_list(shape_n_star(points, radius));
+}
@@ -0,0 +1,51 @@
+#include <math.h>
+#include "solver.h"
+
+/* Pushes a contact's bodies apart along its normal by an impulse. */
+void solver_apply(SolverBody *bodies, SolverContact *contact, double impulse) {
+    SolverBody *body1 = &bodies[contact->body1], *body2 = &bodies[contact->body2];
+    body1->velocity = vec_subtract(body1->velocity,
+                                   vec_multiply(impulse * body1->inv_mass, contact->normal));
+    body2->velocity = vec_add(body2->velocity,
+                              vec_multiply(impulse * body2->inv_mass, contact->normal));
+}
+
+void solver_prepare(SolverBody *bodies, SolverContact *contacts, size_t count, double dt) {
+    for (size_t i = 0; i < count; i++) {
+        SolverContact *contact = &contacts[i];
+        SolverBody *body1 = &bodies[contact->body1], *body2 = &bodies[contact->body2];
+        double inv_mass = body1->inv_mass + body2->inv_mass;
+        contact->mass = inv_mass > 0 ? 1 / inv_mass : 0;
+
+        // Bodies that were already approaching bounce back, but bodies
+        // only pushed together by this tick's forces stay at rest
+        double approach = vec_dot(vec_subtract(body1->incoming, body2->incoming), contact->normal);
+        double bounce = approach > 0 ? contact->elasticity * approach : 0;
+        double correction = SOLVER_BAUMGARTE / dt * fmax(contact->depth - SOLVER_SLOP, 0);
+        contact->target = fmax(bounce, correction);
+
+        solver_apply(bodies, contact, contact->impulse);
+    }
+}
+
+void solver_iterate(SolverBody *bodies, SolverContact *contacts, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        SolverContact *contact = &contacts[i];
+        Vector relative = vec_subtract(bodies[contact->body2].velocity,
+                                       bodies[contact->body1].velocity);
+        double separation = vec_dot(relative, contact->normal);
+        // The total impulse is clamped, not each correction, so a later sweep
+        // can take back some of what an earlier one pushed with
+        double total = fmax(contact->impulse + (contact->target - separation) * contact->mass, 0);
+        solver_apply(bodies, contact, total - contact->impulse);
+        contact->impulse = total;
+    }
+}
+
+void solver_solve(SolverBody *bodies, SolverContact *contacts, size_t count, double dt,
+                  size_t iterations) {
+    solver_prepare(bodies, contacts, count, dt);
+    for (size_t i = 0; i < iterations; i++) {
+        solver_iterate(bodies, contacts, count);
+    }
+}
@@ -0,0 +1,282 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <assert.h>
+#include "spatial_hash.h"
+
+/* When the arrays need to grow */
+#define GROWTH_FACTOR 2
+/* Boxes covering more cells than this are tested against every box instead,
+   so one huge body does not fill thousands of cells */
+#define MAX_CELLS_PER_BOX 64
+/* The automatic cell size, as a multiple of the average box size */
+#define AUTO_CELL_SCALE 2.0
+
+/* One box's membership in one cell */
+typedef struct {
+    int64_t cell_x;
+    int64_t cell_y;
+    size_t item;
+} CellEntry;
+
+typedef struct spatial_hash {
+    double cell_size;
+    /* The inserted boxes and their ids */
+    size_t size;
+    size_t capacity;
+    AABB *boxes;
+    size_t *ids;
+    /* Items that cover too many cells to be put in the grid */
+    size_t *oversized;
+    size_t num_oversized;
+    /* Scratch space for the cell entries, before and after bucketing */
+    CellEntry *entries;
+    CellEntry *sorted;
+    size_t entries_capacity;
+    /* bucket_start[b] is the index in sorted of the first entry in bucket b,
+       and then the index after its last once the entries are bucketed */
+    size_t *bucket_start;
+    size_t buckets_capacity;
+    /* Whether the buckets hold every inserted box, as of the last
+       spatial_hash_find_pairs(), and the grid they were built with */
+    bool built;
+    double built_cell_size;
+    size_t num_buckets;
+} SpatialHash;
+
+SpatialHash *spatial_hash_init(double cell_size) {
+    SpatialHash *hash = malloc(sizeof(SpatialHash));
+    assert(hash != NULL);
+    hash->cell_size = cell_size;
+    hash->size = 0;
+    hash->capacity = 0;
+    hash->boxes = NULL;
+    hash->ids = NULL;
+    hash->oversized = NULL;
+    hash->num_oversized = 0;
+    hash->entries = NULL;
+    hash->sorted = NULL;
+    hash->entries_capacity = 0;
+    hash->bucket_start = NULL;
+    hash->buckets_capacity = 0;
+    hash->built = false;
+    return hash;
+}
+
+void spatial_hash_free(SpatialHash *hash) {
+    free(hash->boxes);
+    free(hash->ids);
+    free(hash->oversized);
+    free(hash->entries);
+    free(hash->sorted);
+    free(hash->bucket_start);
+    free(hash);
+}
+
+void spatial_hash_set_cell_size(SpatialHash *hash, double cell_size) {
+    hash->cell_size = cell_size;
+}
+
+void spatial_hash_clear(SpatialHash *hash) {
+    hash->size = 0;
+    hash->built = false;
+}
+
+void spatial_hash_insert(SpatialHash *hash, size_t id, AABB box) {
+    if (hash->size == hash->capacity) {
+        hash->capacity = hash->capacity > 0 ? hash->capacity * GROWTH_FACTOR : 16;
+        hash->boxes = realloc(hash->boxes, hash->capacity * sizeof(AABB));
+        hash->ids = realloc(hash->ids, hash->capacity * sizeof(size_t));
+        hash->oversized = realloc(hash->oversized, hash->capacity * sizeof(size_t));
+        assert(hash->boxes != NULL && hash->ids != NULL && hash->oversized != NULL);
+    }
+    hash->boxes[hash->size] = box;
+    hash->ids[hash->size] = id;
+    hash->size++;
+    hash->built = false;
+}
+
+double spatial_hash_choose_cell_size(SpatialHash *hash) {
+    if (hash->cell_size > 0) {
+        return hash->cell_size;
+    }
+    double total = 0;
+    for (size_t i = 0; i < hash->size; i++) {
+        AABB box = hash->boxes[i];
+        total += fmax(box.max.x - box.min.x, box.max.y - box.min.y);
+    }
+    double cell_size = AUTO_CELL_SCALE * total / hash->size;
+    return cell_size > 0 ? cell_size : 1;
+}
+
+int64_t spatial_hash_cell(double coordinate, double cell_size) {
+    return (int64_t) floor(coordinate / cell_size);
+}
+
+size_t spatial_hash_bucket(int64_t cell_x, int64_t cell_y, size_t mask) {
+    uint64_t h = (uint64_t) cell_x * 73856093u ^ (uint64_t) cell_y * 19349663u;
+    return (size_t) (h ^ (h >> 29)) & mask;
+}
+
+void spatial_hash_add_entry(SpatialHash *hash, size_t *num_entries, CellEntry entry) {
+    if (*num_entries == hash->entries_capacity) {
+        hash->entries_capacity = hash->entries_capacity > 0
+            ? hash->entries_capacity * GROWTH_FACTOR : 64;
+        hash->entries = realloc(hash->entries, hash->entries_capacity * sizeof(CellEntry));
+        hash->sorted = realloc(hash->sorted, hash->entries_capacity * sizeof(CellEntry));
+        assert(hash->entries != NULL && hash->sorted != NULL);
+    }
+    hash->entries[(*num_entries)++] = entry;
+}
+
+void spatial_hash_find_pairs(SpatialHash *hash, PairBuffer *pairs) {
+    if (hash->size < 2) {
+        return;
+    }
+    double cell_size = spatial_hash_choose_cell_size(hash);
+
+    // Put each box in every cell it covers
+    size_t num_entries = 0;
+    hash->num_oversized = 0;
+    for (size_t i = 0; i < hash->size; i++) {
+        AABB box = hash->boxes[i];
+        int64_t x0 = spatial_hash_cell(box.min.x, cell_size);
+        int64_t y0 = spatial_hash_cell(box.min.y, cell_size);
+        int64_t x1 = spatial_hash_cell(box.max.x, cell_size);
+        int64_t y1 = spatial_hash_cell(box.max.y, cell_size);
+        if ((x1 - x0 + 1) * (y1 - y0 + 1) > MAX_CELLS_PER_BOX) {
+            hash->oversized[hash->num_oversized++] = i;
+            continue;
+        }
+        for (int64_t x = x0; x <= x1; x++) {
+            for (int64_t y = y0; y <= y1; y++) {
+                spatial_hash_add_entry(hash, &num_entries, (CellEntry) {x, y, i});
+            }
+        }
+    }
+
+    // Group the entries by bucket with a counting sort
+    size_t num_buckets = 1;
+    while (num_buckets < 2 * num_entries) {
+        num_buckets *= 2;
+    }
+    if (num_buckets + 1 > hash->buckets_capacity) {
+        hash->buckets_capacity = num_buckets + 1;
+        hash->bucket_start = realloc(hash->bucket_start, hash->buckets_capacity * sizeof(size_t));
+        assert(hash->bucket_start != NULL);
+    }
+    size_t mask = num_buckets - 1;
+    size_t *start = hash->bucket_start;
+    for (size_t b = 0; b <= num_buckets; b++) {
+        start[b] = 0;
+    }
+    for (size_t e = 0; e < num_entries; e++) {
+        start[spatial_hash_bucket(hash->entries[e].cell_x, hash->entries[e].cell_y, mask) + 1]++;
+    }
+    for (size_t b = 0; b < num_buckets; b++) {
+        start[b + 1] += start[b];
+    }
+    for (size_t e = 0; e < num_entries; e++) {
+        CellEntry entry = hash->entries[e];
+        hash->sorted[start[spatial_hash_bucket(entry.cell_x, entry.cell_y, mask)]++] = entry;
+    }
+    // Each start[b] now holds the end of bucket b, i.e. the start of bucket b + 1
+    hash->built = true;
+    hash->built_cell_size = cell_size;
+    hash->num_buckets = num_buckets;
+    size_t bucket_begin = 0;
+    for (size_t b = 0; b < num_buckets; b++) {
+        size_t bucket_end = start[b];
+        for (size_t e1 = bucket_begin; e1 < bucket_end; e1++) {
+            CellEntry a = hash->sorted[e1];
+            for (size_t e2 = e1 + 1; e2 < bucket_end; e2++) {
+                CellEntry b_entry = hash->sorted[e2];
+                // Different cells can hash to the same bucket
+                if (a.cell_x != b_entry.cell_x || a.cell_y != b_entry.cell_y) {
+                    continue;
+                }
+                AABB box1 = hash->boxes[a.item], box2 = hash->boxes[b_entry.item];
+                if (!aabb_overlap(box1, box2)) {
+                    continue;
+                }
+                // Two boxes can share several cells; only report the pair
+                // from the cell holding the corner of their intersection
+                double corner_x = fmax(box1.min.x, box2.min.x);
+                double corner_y = fmax(box1.min.y, box2.min.y);
+                if (spatial_hash_cell(corner_x, cell_size) == a.cell_x
+                        && spatial_hash_cell(corner_y, cell_size) == a.cell_y) {
+                    pair_buffer_add(pairs, hash->ids[a.item], hash->ids[b_entry.item]);
+                }
+            }
+        }
+        bucket_begin = bucket_end;
+    }
+
+    // Test the boxes that were too big for the grid against everything
+    for (size_t k = 0; k < hash->num_oversized; k++) {
+        size_t big = hash->oversized[k];
+        for (size_t i = 0; i < hash->size; i++) {
+            if (i == big) {
+                continue;
+            }
+            // Pairs of two oversized boxes are only reported by the first one
+            bool other_oversized = false;
+            for (size_t j = 0; j < k; j++) {
+                if (hash->oversized[j] == i) {
+                    other_oversized = true;
+                    break;
+                }
+            }
+            if (!other_oversized && aabb_overlap(hash->boxes[big], hash->boxes[i])) {
+                pair_buffer_add(pairs, hash->ids[big], hash->ids[i]);
+            }
+        }
+    }
+}
+
+void spatial_hash_query(SpatialHash *hash, AABB box, BroadphaseQueryHandler handler, void *aux) {
+    double cell_size = hash->built_cell_size;
+    int64_t x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    if (hash->built) {
+        x0 = spatial_hash_cell(box.min.x, cell_size);
+        y0 = spatial_hash_cell(box.min.y, cell_size);
+        x1 = spatial_hash_cell(box.max.x, cell_size);
+        y1 = spatial_hash_cell(box.max.y, cell_size);
+    }
+    if (!hash->built || (x1 - x0 + 1) * (y1 - y0 + 1) > MAX_CELLS_PER_BOX) {
+        for (size_t i = 0; i < hash->size; i++) {
+            if (aabb_overlap(box, hash->boxes[i])) {
+                handler(hash->ids[i], aux);
+            }
+        }
+        return;
+    }
+
+    size_t mask = hash->num_buckets - 1;
+    size_t *end = hash->bucket_start;
+    for (int64_t x = x0; x <= x1; x++) {
+        for (int64_t y = y0; y <= y1; y++) {
+            size_t b = spatial_hash_bucket(x, y, mask);
+            for (size_t e = b > 0 ? end[b - 1] : 0; e < end[b]; e++) {
+                CellEntry entry = hash->sorted[e];
+                AABB other = hash->boxes[entry.item];
+                if (entry.cell_x != x || entry.cell_y != y || !aabb_overlap(box, other)) {
+                    continue;
+                }
+                // As with pairs, only report a box from the cell holding
+                // the corner of its intersection with the query
+                if (spatial_hash_cell(fmax(box.min.x, other.min.x), cell_size) == x
+                        && spatial_hash_cell(fmax(box.min.y, other.min.y), cell_size) == y) {
+                    handler(hash->ids[entry.item], aux);
+                }
+            }
+        }
+    }
+    for (size_t k = 0; k < hash->num_oversized; k++) {
+        size_t big = hash->oversized[k];
+        if (aabb_overlap(box, hash->boxes[big])) {
+            handler(hash->ids[big], aux);
+        }
+    }
+}
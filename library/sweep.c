@@ -0,0 +1,251 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "sweep.h"
+
+/* When the arrays need to grow */
+#define GROWTH_FACTOR 2
+/* If more endpoints than this were added since the last sort,
+   insertion sort would be slow, so the endpoints are fully re-sorted */
+#define MAX_INSERTION_SORT_NEW 32
+
+typedef struct {
+    AABB box;
+    size_t id;
+    bool active;
+    /* The position of the proxy in the list of open boxes while sweeping */
+    size_t open_index;
+} SweepProxy;
+
+typedef struct {
+    double value;
+    size_t proxy;
+    bool is_min;
+    /* Whether the proxy's box has no width along x */
+    bool zero_width;
+} SweepEndpoint;
+
+typedef struct sweep {
+    SweepProxy *proxies;
+    size_t num_proxies;
+    size_t proxies_capacity;
+    /* Proxies that were removed and can be reused */
+    size_t *free_proxies;
+    size_t num_free;
+    /* Proxies that were removed but still have endpoints in the array;
+       they become free once the endpoints are dropped */
+    size_t *removed_proxies;
+    size_t num_removed;
+    /* The x endpoints of every active proxy, sorted as of the last sweep */
+    SweepEndpoint *endpoints;
+    size_t num_endpoints;
+    size_t endpoints_capacity;
+    /* Endpoints appended since the last sort */
+    size_t num_unsorted;
+    /* The width of the widest box as of the last sort */
+    double max_width;
+    /* Scratch space for the boxes open while sweeping */
+    size_t *open;
+} SweepAndPrune;
+
+SweepAndPrune *sweep_init(void) {
+    SweepAndPrune *sweep = malloc(sizeof(SweepAndPrune));
+    assert(sweep != NULL);
+    sweep->proxies = NULL;
+    sweep->num_proxies = 0;
+    sweep->proxies_capacity = 0;
+    sweep->free_proxies = NULL;
+    sweep->num_free = 0;
+    sweep->removed_proxies = NULL;
+    sweep->num_removed = 0;
+    sweep->endpoints = NULL;
+    sweep->num_endpoints = 0;
+    sweep->endpoints_capacity = 0;
+    sweep->num_unsorted = 0;
+    sweep->max_width = 0;
+    sweep->open = NULL;
+    return sweep;
+}
+
+void sweep_free(SweepAndPrune *sweep) {
+    free(sweep->proxies);
+    free(sweep->free_proxies);
+    free(sweep->removed_proxies);
+    free(sweep->endpoints);
+    free(sweep->open);
+    free(sweep);
+}
+
+size_t sweep_insert(SweepAndPrune *sweep, size_t id, AABB box) {
+    size_t proxy;
+    if (sweep->num_free > 0) {
+        proxy = sweep->free_proxies[--sweep->num_free];
+    } else {
+        if (sweep->num_proxies == sweep->proxies_capacity) {
+            sweep->proxies_capacity = sweep->proxies_capacity > 0
+                ? sweep->proxies_capacity * GROWTH_FACTOR : 16;
+            sweep->proxies = realloc(sweep->proxies, sweep->proxies_capacity * sizeof(SweepProxy));
+            sweep->free_proxies = realloc(sweep->free_proxies, sweep->proxies_capacity * sizeof(size_t));
+            sweep->removed_proxies = realloc(sweep->removed_proxies, sweep->proxies_capacity * sizeof(size_t));
+            sweep->open = realloc(sweep->open, sweep->proxies_capacity * sizeof(size_t));
+            assert(sweep->proxies != NULL && sweep->free_proxies != NULL
+                && sweep->removed_proxies != NULL && sweep->open != NULL);
+        }
+        proxy = sweep->num_proxies++;
+    }
+    sweep->proxies[proxy] = (SweepProxy) {box, id, true, 0};
+
+    if (sweep->num_endpoints + 2 > sweep->endpoints_capacity) {
+        sweep->endpoints_capacity = sweep->endpoints_capacity > 0
+            ? sweep->endpoints_capacity * GROWTH_FACTOR : 32;
+        sweep->endpoints = realloc(sweep->endpoints, sweep->endpoints_capacity * sizeof(SweepEndpoint));
+        assert(sweep->endpoints != NULL);
+    }
+    bool zero_width = box.min.x == box.max.x;
+    sweep->endpoints[sweep->num_endpoints++] = (SweepEndpoint) {box.min.x, proxy, true, zero_width};
+    sweep->endpoints[sweep->num_endpoints++] = (SweepEndpoint) {box.max.x, proxy, false, zero_width};
+    sweep->num_unsorted += 2;
+    return proxy;
+}
+
+void sweep_update(SweepAndPrune *sweep, size_t proxy, size_t id, AABB box) {
+    assert(proxy < sweep->num_proxies && sweep->proxies[proxy].active);
+    sweep->proxies[proxy].box = box;
+    sweep->proxies[proxy].id = id;
+}
+
+void sweep_remove(SweepAndPrune *sweep, size_t proxy) {
+    assert(proxy < sweep->num_proxies && sweep->proxies[proxy].active);
+    sweep->proxies[proxy].active = false;
+    sweep->removed_proxies[sweep->num_removed++] = proxy;
+}
+
+/* The order of an endpoint among endpoints with the same value.
+   Max endpoints come first and min endpoints last, so touching boxes do not
+   overlap. A box with no width opens and closes in between, so it overlaps
+   only the boxes that strictly contain it. */
+int sweep_endpoint_rank(SweepEndpoint e) {
+    if (e.zero_width) {
+        return 1;
+    }
+    return e.is_min ? 2 : 0;
+}
+
+/* Whether endpoint a belongs before endpoint b */
+bool sweep_endpoint_before(SweepEndpoint a, SweepEndpoint b) {
+    if (a.value != b.value) {
+        return a.value < b.value;
+    }
+    int rank_a = sweep_endpoint_rank(a), rank_b = sweep_endpoint_rank(b);
+    if (rank_a != rank_b) {
+        return rank_a < rank_b;
+    }
+    if (rank_a != 1) {
+        return false;
+    }
+    // A box with no width always opens right before it closes
+    return a.proxy < b.proxy || (a.proxy == b.proxy && a.is_min && !b.is_min);
+}
+
+int sweep_endpoint_compare(const void *a, const void *b) {
+    SweepEndpoint e1 = *(const SweepEndpoint *) a, e2 = *(const SweepEndpoint *) b;
+    if (sweep_endpoint_before(e1, e2)) {
+        return -1;
+    }
+    return sweep_endpoint_before(e2, e1) ? 1 : 0;
+}
+
+/* Refreshes the endpoint values from the boxes, drops the endpoints of
+   removed proxies, and restores the sorted order. */
+void sweep_sort(SweepAndPrune *sweep) {
+    SweepEndpoint *endpoints = sweep->endpoints;
+    size_t n = 0;
+    sweep->max_width = 0;
+    for (size_t i = 0; i < sweep->num_endpoints; i++) {
+        SweepEndpoint e = endpoints[i];
+        SweepProxy *proxy = &sweep->proxies[e.proxy];
+        if (!proxy->active) {
+            continue;
+        }
+        e.value = e.is_min ? proxy->box.min.x : proxy->box.max.x;
+        e.zero_width = proxy->box.min.x == proxy->box.max.x;
+        if (proxy->box.max.x - proxy->box.min.x > sweep->max_width) {
+            sweep->max_width = proxy->box.max.x - proxy->box.min.x;
+        }
+        endpoints[n++] = e;
+    }
+    sweep->num_endpoints = n;
+    while (sweep->num_removed > 0) {
+        sweep->free_proxies[sweep->num_free++] = sweep->removed_proxies[--sweep->num_removed];
+    }
+
+    if (sweep->num_unsorted > MAX_INSERTION_SORT_NEW) {
+        qsort(endpoints, n, sizeof(SweepEndpoint), sweep_endpoint_compare);
+    } else {
+        for (size_t i = 1; i < n; i++) {
+            SweepEndpoint e = endpoints[i];
+            size_t j = i;
+            while (j > 0 && sweep_endpoint_before(e, endpoints[j - 1])) {
+                endpoints[j] = endpoints[j - 1];
+                j--;
+            }
+            endpoints[j] = e;
+        }
+    }
+    sweep->num_unsorted = 0;
+}
+
+void sweep_find_pairs(SweepAndPrune *sweep, PairBuffer *pairs) {
+    sweep_sort(sweep);
+    size_t num_open = 0;
+    size_t *open = sweep->open;
+    for (size_t i = 0; i < sweep->num_endpoints; i++) {
+        SweepEndpoint e = sweep->endpoints[i];
+        SweepProxy *proxy = &sweep->proxies[e.proxy];
+        if (e.is_min) {
+            // Every open box overlaps this one along x
+            for (size_t k = 0; k < num_open; k++) {
+                SweepProxy *other = &sweep->proxies[open[k]];
+                if (proxy->box.min.y < other->box.max.y && other->box.min.y < proxy->box.max.y) {
+                    pair_buffer_add(pairs, proxy->id, other->id);
+                }
+            }
+            proxy->open_index = num_open;
+            open[num_open++] = e.proxy;
+        } else {
+            size_t last = open[--num_open];
+            open[proxy->open_index] = last;
+            sweep->proxies[last].open_index = proxy->open_index;
+        }
+    }
+}
+
+/* Reports a proxy found by a query, if it is still in the broadphase */
+void sweep_report(SweepAndPrune *sweep, SweepEndpoint e, AABB box,
+                  BroadphaseQueryHandler handler, void *aux) {
+    SweepProxy *proxy = &sweep->proxies[e.proxy];
+    if (e.is_min && proxy->active && aabb_overlap(box, proxy->box)) {
+        handler(proxy->id, aux);
+    }
+}
+
+void sweep_query(SweepAndPrune *sweep, AABB box, BroadphaseQueryHandler handler, void *aux) {
+    size_t sorted = sweep->num_endpoints - sweep->num_unsorted;
+    // Finds the first endpoint at or after the leftmost edge an overlapping box can have
+    double left = box.min.x - sweep->max_width;
+    size_t lo = 0, hi = sorted;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (sweep->endpoints[mid].value < left) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    for (size_t i = lo; i < sorted && sweep->endpoints[i].value < box.max.x; i++) {
+        sweep_report(sweep, sweep->endpoints[i], box, handler, aux);
+    }
+    for (size_t i = sorted; i < sweep->num_endpoints; i++) {
+        sweep_report(sweep, sweep->endpoints[i], box, handler, aux);
+    }
+}
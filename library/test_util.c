@@ -29,6 +29,10 @@ bool vec_within(double epsilon, Vector v1, Vector v2) {
     return within(epsilon, v1.x, v2.x) && within(epsilon, v1.y, v2.y);
 }
 
+double rand_range(double min, double max) {
+    return min + (max - min) * rand() / RAND_MAX;
+}
+
 void read_testname(char *filename, char *testname, size_t testname_size) {
     FILE *f = fopen(filename, "r");
     if (f == NULL) {
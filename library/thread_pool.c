@@ -0,0 +1,129 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <pthread.h>
+#include "thread_pool.h"
+
+typedef struct thread_pool ThreadPool;
+
+/* What each worker thread is started with */
+typedef struct {
+    ThreadPool *pool;
+    size_t index;
+} Worker;
+
+typedef struct thread_pool {
+    size_t num_threads;
+    /* Threads 1 to num_threads - 1; the caller is worker 0 */
+    pthread_t *threads;
+    Worker *workers;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    ThreadTask task;
+    void *aux;
+    /* Incremented each time a task is started */
+    size_t generation;
+    /* The number of workers still running the current task */
+    size_t remaining;
+    bool stopping;
+} ThreadPool;
+
+void *thread_pool_worker(void *arg) {
+    Worker *worker = arg;
+    ThreadPool *pool = worker->pool;
+    size_t seen = 0;
+    while (true) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->generation == seen && !pool->stopping) {
+            pthread_cond_wait(&pool->start, &pool->lock);
+        }
+        if (pool->stopping) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        ThreadTask task = pool->task;
+        void *aux = pool->aux;
+        pthread_mutex_unlock(&pool->lock);
+
+        task(worker->index, pool->num_threads, aux);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->remaining == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+ThreadPool *thread_pool_init(size_t num_threads) {
+    assert(num_threads > 0);
+    ThreadPool *pool = malloc(sizeof(ThreadPool));
+    assert(pool != NULL);
+    pool->num_threads = num_threads;
+    pool->threads = malloc(num_threads * sizeof(pthread_t));
+    pool->workers = malloc(num_threads * sizeof(Worker));
+    assert(pool->threads != NULL && pool->workers != NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->start, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->task = NULL;
+    pool->aux = NULL;
+    pool->generation = 0;
+    pool->remaining = 0;
+    pool->stopping = false;
+    for (size_t i = 1; i < num_threads; i++) {
+        pool->workers[i] = (Worker) {pool, i};
+        int error = pthread_create(&pool->threads[i], NULL, thread_pool_worker, &pool->workers[i]);
+        assert(error == 0);
+    }
+    return pool;
+}
+
+void thread_pool_free(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 1; i < pool->num_threads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->start);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool);
+}
+
+size_t thread_pool_size(ThreadPool *pool) {
+    return pool->num_threads;
+}
+
+void thread_pool_run(ThreadPool *pool, ThreadTask task, void *aux) {
+    if (pool->num_threads == 1) {
+        task(0, 1, aux);
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->aux = aux;
+    pool->remaining = pool->num_threads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start);
+    pthread_mutex_unlock(&pool->lock);
+
+    task(0, pool->num_threads, aux);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->remaining > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void thread_pool_split(size_t worker, size_t num_workers, size_t n, size_t *start, size_t *end) {
+    *start = n * worker / num_workers;
+    *end = n * (worker + 1) / num_workers;
+}
@@ -42,7 +42,7 @@ double vec_dot(Vector v1, Vector v2) {
 }
 
 double vec_len(Vector v){
-  return pow(vec_dot(v, v), 0.5);
+  return sqrt(vec_dot(v, v));
 }
 
 double vec_cross(Vector v1, Vector v2) {
@@ -50,25 +50,28 @@ double vec_cross(Vector v1, Vector v2) {
 }
 
 Vector vec_rotate(Vector v, double angle) {
+    double c = cos(angle), s = sin(angle);
     Vector rotated = {
-        .x = cos(angle) * v.x - sin(angle) * v.y,
-        .y = sin(angle) * v.x + cos(angle) * v.y
+        .x = c * v.x - s * v.y,
+        .y = s * v.x + c * v.y
     };
     return rotated;
 }
 
 Vector vec_unit(Vector v){
-  if(vec_len(v) == 0){
+  double len = vec_len(v);
+  if(len == 0){
     return VEC_ZERO;
   }
-  return vec_multiply(1.0/vec_len(v), v);
+  return vec_multiply(1.0/len, v);
 }
 
 double vec_angle(Vector v){
-  if (vec_len(v) == 0){
+  double len = vec_len(v);
+  if (len == 0){
     return 0;
   }
-  double angle = acos(v.x / vec_len(v));
+  double angle = acos(v.x / len);
   if (v.y < 0){
     angle = 2 * M_PI - angle;
   }
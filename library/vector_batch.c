@@ -0,0 +1,174 @@
+#include <math.h>
+#include "vector_batch.h"
+
+#if defined(VEC_BATCH_SCALAR)
+#define VEC_BATCH_BACKEND "scalar"
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define VEC_BATCH_AVX2
+#define VEC_BATCH_SSE2
+#define VEC_BATCH_BACKEND "avx2"
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define VEC_BATCH_SSE2
+#define VEC_BATCH_BACKEND "sse2"
+#else
+#define VEC_BATCH_BACKEND "scalar"
+#endif
+
+/* The loops below handle as many vectors as they can 2 (AVX2) or 1 (SSE2)
+   at a time, and finish the rest with the scalar code.
+   Vector is two adjacent doubles, so one vector fills an SSE2 register. */
+
+const char *vec_batch_backend(void) {
+    return VEC_BATCH_BACKEND;
+}
+
+BatchTransform vec_batch_rotation(double angle, Vector point) {
+    double c = cos(angle), s = sin(angle);
+    // rotating p about point is R p + (point - R point)
+    Vector offset = {
+        .x = point.x - (c * point.x - s * point.y),
+        .y = point.y - (s * point.x + c * point.y)
+    };
+    return (BatchTransform) {c, -s, s, c, offset};
+}
+
+void vec_batch_translate(Vector *vectors, size_t n, Vector translation) {
+    size_t i = 0;
+#if defined(VEC_BATCH_AVX2)
+    __m256d t2 = _mm256_setr_pd(translation.x, translation.y, translation.x, translation.y);
+    for (; i + 2 <= n; i += 2) {
+        double *p = &vectors[i].x;
+        _mm256_storeu_pd(p, _mm256_add_pd(_mm256_loadu_pd(p), t2));
+    }
+#endif
+#if defined(VEC_BATCH_SSE2)
+    __m128d t = _mm_setr_pd(translation.x, translation.y);
+    for (; i < n; i++) {
+        double *p = &vectors[i].x;
+        _mm_storeu_pd(p, _mm_add_pd(_mm_loadu_pd(p), t));
+    }
+#endif
+    for (; i < n; i++) {
+        vectors[i].x += translation.x;
+        vectors[i].y += translation.y;
+    }
+}
+
+void vec_batch_transform(Vector *out, const Vector *in, size_t n, BatchTransform transform) {
+    size_t i = 0;
+#if defined(VEC_BATCH_AVX2)
+    // each lane pair computes (xx, yx) * x + (xy, yy) * y + offset
+    __m256d col_x2 = _mm256_setr_pd(transform.xx, transform.yx, transform.xx, transform.yx);
+    __m256d col_y2 = _mm256_setr_pd(transform.xy, transform.yy, transform.xy, transform.yy);
+    __m256d offset2 = _mm256_setr_pd(transform.offset.x, transform.offset.y,
+                                     transform.offset.x, transform.offset.y);
+    for (; i + 2 <= n; i += 2) {
+        __m256d p = _mm256_loadu_pd(&in[i].x);
+        __m256d x = _mm256_unpacklo_pd(p, p);
+        __m256d y = _mm256_unpackhi_pd(p, p);
+        __m256d sum = _mm256_add_pd(_mm256_mul_pd(col_x2, x), _mm256_mul_pd(col_y2, y));
+        _mm256_storeu_pd(&out[i].x, _mm256_add_pd(sum, offset2));
+    }
+#endif
+#if defined(VEC_BATCH_SSE2)
+    __m128d col_x = _mm_setr_pd(transform.xx, transform.yx);
+    __m128d col_y = _mm_setr_pd(transform.xy, transform.yy);
+    __m128d offset = _mm_setr_pd(transform.offset.x, transform.offset.y);
+    for (; i < n; i++) {
+        __m128d p = _mm_loadu_pd(&in[i].x);
+        __m128d x = _mm_unpacklo_pd(p, p);
+        __m128d y = _mm_unpackhi_pd(p, p);
+        __m128d sum = _mm_add_pd(_mm_mul_pd(col_x, x), _mm_mul_pd(col_y, y));
+        _mm_storeu_pd(&out[i].x, _mm_add_pd(sum, offset));
+    }
+#endif
+    for (; i < n; i++) {
+        Vector v = in[i];
+        out[i].x = transform.xx * v.x + transform.xy * v.y + transform.offset.x;
+        out[i].y = transform.yx * v.x + transform.yy * v.y + transform.offset.y;
+    }
+}
+
+void vec_batch_project(const Vector *vectors, size_t n, Vector axis, double *min, double *max) {
+    double lo = axis.x * vectors[0].x + axis.y * vectors[0].y;
+    double hi = lo;
+    size_t i = 1;
+#if defined(VEC_BATCH_AVX2)
+    if (n >= 5) {
+        // four dot products at a time; their lanes come out in the order 0 2 1 3
+        __m256d axis2 = _mm256_setr_pd(axis.x, axis.y, axis.x, axis.y);
+        __m256d lo4 = _mm256_set1_pd(lo), hi4 = lo4;
+        for (; i + 4 <= n; i += 4) {
+            __m256d a = _mm256_mul_pd(_mm256_loadu_pd(&vectors[i].x), axis2);
+            __m256d b = _mm256_mul_pd(_mm256_loadu_pd(&vectors[i + 2].x), axis2);
+            __m256d dots = _mm256_add_pd(_mm256_unpacklo_pd(a, b), _mm256_unpackhi_pd(a, b));
+            lo4 = _mm256_min_pd(dots, lo4);
+            hi4 = _mm256_max_pd(dots, hi4);
+        }
+        __m128d lo2 = _mm_min_pd(_mm256_castpd256_pd128(lo4), _mm256_extractf128_pd(lo4, 1));
+        __m128d hi2 = _mm_max_pd(_mm256_castpd256_pd128(hi4), _mm256_extractf128_pd(hi4, 1));
+        lo = _mm_cvtsd_f64(_mm_min_sd(lo2, _mm_unpackhi_pd(lo2, lo2)));
+        hi = _mm_cvtsd_f64(_mm_max_sd(hi2, _mm_unpackhi_pd(hi2, hi2)));
+    }
+#elif defined(VEC_BATCH_SSE2)
+    if (n >= 3) {
+        // two dot products at a time
+        __m128d axis1 = _mm_setr_pd(axis.x, axis.y);
+        __m128d lo2 = _mm_set1_pd(lo), hi2 = lo2;
+        for (; i + 2 <= n; i += 2) {
+            __m128d a = _mm_mul_pd(_mm_loadu_pd(&vectors[i].x), axis1);
+            __m128d b = _mm_mul_pd(_mm_loadu_pd(&vectors[i + 1].x), axis1);
+            __m128d dots = _mm_add_pd(_mm_unpacklo_pd(a, b), _mm_unpackhi_pd(a, b));
+            lo2 = _mm_min_pd(dots, lo2);
+            hi2 = _mm_max_pd(dots, hi2);
+        }
+        lo = _mm_cvtsd_f64(_mm_min_sd(lo2, _mm_unpackhi_pd(lo2, lo2)));
+        hi = _mm_cvtsd_f64(_mm_max_sd(hi2, _mm_unpackhi_pd(hi2, hi2)));
+    }
+#endif
+    for (; i < n; i++) {
+        double dot = axis.x * vectors[i].x + axis.y * vectors[i].y;
+        lo = dot < lo ? dot : lo;
+        hi = dot > hi ? dot : hi;
+    }
+    *min = lo;
+    *max = hi;
+}
+
+void vec_batch_bounds(const Vector *vectors, size_t n, Vector *min, Vector *max) {
+    Vector lo = vectors[0], hi = vectors[0];
+    size_t i = 1;
+#if defined(VEC_BATCH_SSE2)
+    __m128d lo2 = _mm_loadu_pd(&lo.x), hi2 = lo2;
+#if defined(VEC_BATCH_AVX2)
+    if (n >= 3) {
+        __m256d lo4 = _mm256_setr_pd(lo.x, lo.y, lo.x, lo.y), hi4 = lo4;
+        for (; i + 2 <= n; i += 2) {
+            __m256d p = _mm256_loadu_pd(&vectors[i].x);
+            lo4 = _mm256_min_pd(p, lo4);
+            hi4 = _mm256_max_pd(p, hi4);
+        }
+        lo2 = _mm_min_pd(_mm256_castpd256_pd128(lo4), _mm256_extractf128_pd(lo4, 1));
+        hi2 = _mm_max_pd(_mm256_castpd256_pd128(hi4), _mm256_extractf128_pd(hi4, 1));
+    }
+#endif
+    for (; i < n; i++) {
+        __m128d p = _mm_loadu_pd(&vectors[i].x);
+        lo2 = _mm_min_pd(p, lo2);
+        hi2 = _mm_max_pd(p, hi2);
+    }
+    _mm_storeu_pd(&lo.x, lo2);
+    _mm_storeu_pd(&hi.x, hi2);
+#endif
+    for (; i < n; i++) {
+        Vector v = vectors[i];
+        lo.x = v.x < lo.x ? v.x : lo.x;
+        lo.y = v.y < lo.y ? v.y : lo.y;
+        hi.x = v.x > hi.x ? v.x : hi.x;
+        hi.y = v.y > hi.y ? v.y : hi.y;
+    }
+    *min = lo;
+    *max = hi;
+}
@@ -0,0 +1,80 @@
+#include "collision.h"
+#include "shapes.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Times the SAT narrowphase on pairs of regular polygons of several sizes,
+ * comparing the List interface, borrowed views, views with cached normals
+ * (all SAT), and GJK/EPA warm-started from a cache kept for each pair.
+ * Half of the pairs are placed so that they overlap.
+ */
+
+#define NUM_PAIRS 64
+#define ROUNDS 200
+
+typedef enum { USE_LISTS, USE_VIEWS, USE_NORMALS, USE_GJK } Method;
+
+const char *METHOD_NAMES[] = {
+    "find_collision", "find_collision_view", "find_collision_normals", "find_gjk_collision"
+};
+
+double bench_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+size_t bench_run(Body **bodies, GjkCache *caches, Method method) {
+    size_t hits = 0;
+    for (size_t i = 0; i < NUM_PAIRS; i++) {
+        Body *body1 = bodies[2 * i], *body2 = bodies[2 * i + 1];
+        CollisionInfo info;
+        if (method == USE_LISTS) {
+            List *shape1 = body_get_shape(body1), *shape2 = body_get_shape(body2);
+            info = find_collision(shape1, shape2);
+            list_free(shape1);
+            list_free(shape2);
+        } else if (method == USE_VIEWS) {
+            info = find_collision_view(body_get_shape_view(body1), body_get_shape_view(body2));
+        } else if (method == USE_NORMALS) {
+            info = find_collision_normals(body_get_shape_view(body1), body_get_normals(body1),
+                                          body_get_shape_view(body2), body_get_normals(body2));
+        } else {
+            info = find_gjk_collision(body_get_shape_view(body1), body_get_shape_view(body2), &caches[i]);
+        }
+        hits += info.collided;
+    }
+    return hits;
+}
+
+int main(void) {
+    const int SIDES[] = {4, 8, 12, 16, 32, 100, 300};
+    for (size_t s = 0; s < sizeof(SIDES) / sizeof(*SIDES); s++) {
+        Body *bodies[2 * NUM_PAIRS];
+        for (size_t i = 0; i < 2 * NUM_PAIRS; i++) {
+            bodies[i] = body_init_shape(shape_ngon(SIDES[s], 1), 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+            body_set_rotation(bodies[i], i * 0.37);
+            // Every other pair is too far apart to touch
+            double gap = i % 4 < 2 ? 1.5 : 2.5;
+            body_set_centroid(bodies[i], (Vector) {10 * (i / 2) + gap * (i % 2), 5});
+        }
+        for (Method method = USE_LISTS; method <= USE_GJK; method++) {
+            GjkCache caches[NUM_PAIRS] = {{VEC_ZERO, {0, 0}}};
+            size_t hits = 0;
+            double start = bench_seconds();
+            for (size_t round = 0; round < ROUNDS; round++) {
+                hits += bench_run(bodies, caches, method);
+            }
+            double elapsed = bench_seconds() - start;
+            printf("%2d sides  %-24s %8.1f ns/pair  (%zu hits)\n", SIDES[s], METHOD_NAMES[method],
+                   elapsed * 1e9 / (ROUNDS * NUM_PAIRS), hits / ROUNDS);
+        }
+        for (size_t i = 0; i < 2 * NUM_PAIRS; i++) {
+            body_free(bodies[i]);
+        }
+    }
+    return 0;
+}
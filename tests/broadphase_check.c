@@ -0,0 +1,31 @@
+#include "broadphase_check.h"
+#include <assert.h>
+
+void check_pairs(const AABB *boxes, const bool *present, size_t n, PairBuffer *pairs) {
+    pair_buffer_sort(pairs);
+    size_t p = 0;
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            if ((present == NULL || (present[i] && present[j]))
+                && aabb_overlap(boxes[i], boxes[j])) {
+                assert(p < pairs->size);
+                assert(pairs->pairs[p].first == i);
+                assert(pairs->pairs[p].second == j);
+                p++;
+            }
+        }
+    }
+    assert(p == pairs->size);
+}
+
+void count_found(size_t id, void *aux) {
+    ((size_t *) aux)[id]++;
+}
+
+void check_query(const AABB *boxes, const bool *present, size_t n, AABB box, size_t *found) {
+    for (size_t i = 0; i < n; i++) {
+        bool overlaps = (present == NULL || present[i]) && aabb_overlap(boxes[i], box);
+        assert(found[i] == (overlaps ? 1 : 0));
+        found[i] = 0;
+    }
+}
@@ -0,0 +1,58 @@
+#include "aabb.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+void test_aabb_of_view() {
+    Vector v[] = {{1, -2}, {3, 0}, {-1, 4}};
+    AABB box = aabb_of_view((ShapeView) {v, 3});
+    assert(vec_equal(box.min, (Vector) {-1, -2}));
+    assert(vec_equal(box.max, (Vector) {3, 4}));
+    box = aabb_of_circle((Vector) {1, 1}, 2);
+    assert(vec_equal(box.min, (Vector) {-1, -1}));
+    assert(vec_equal(box.max, (Vector) {3, 3}));
+}
+
+void test_aabb_overlap() {
+    AABB a = {{0, 0}, {2, 2}};
+    AABB b = {{1, 1}, {3, 3}};
+    AABB c = {{2, 0}, {4, 2}};
+    assert(aabb_overlap(a, b));
+    assert(aabb_overlap(b, a));
+    // Touching edges do not count
+    assert(!aabb_overlap(a, c));
+    assert(aabb_overlap(b, c));
+}
+
+void test_aabb_union_contains() {
+    AABB a = {{0, 0}, {2, 2}};
+    AABB b = {{1, -1}, {3, 1}};
+    AABB u = aabb_union(a, b);
+    assert(vec_equal(u.min, (Vector) {0, -1}));
+    assert(vec_equal(u.max, (Vector) {3, 2}));
+    assert(aabb_contains(u, a));
+    assert(aabb_contains(u, b));
+    assert(!aabb_contains(a, b));
+    AABB fat = aabb_fatten(a, 0.5);
+    assert(vec_equal(fat.min, (Vector) {-0.5, -0.5}));
+    assert(vec_equal(fat.max, (Vector) {2.5, 2.5}));
+    assert(isclose(aabb_perimeter(fat), 12));
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_aabb_of_view)
+    DO_TEST(test_aabb_overlap)
+    DO_TEST(test_aabb_union_contains)
+
+    puts("aabb_test PASS");
+    return 0;
+}
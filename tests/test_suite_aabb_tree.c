@@ -0,0 +1,112 @@
+#include "aabb_tree.h"
+#include "broadphase_check.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define NUM_BOXES 300
+#define NUM_ROUNDS 20
+
+void test_tree_query() {
+    AABBTree *tree = aabb_tree_init(0.1);
+    aabb_tree_insert(tree, 0, (AABB) {{0, 0}, {1, 1}});
+    aabb_tree_insert(tree, 1, (AABB) {{5, 5}, {6, 6}});
+    aabb_tree_insert(tree, 2, (AABB) {{-1000, -1000}, {1000, 0.5}});
+    aabb_tree_validate(tree);
+    size_t found[3] = {0, 0, 0};
+    aabb_tree_query(tree, (AABB) {{0.5, 0.25}, {5.5, 5.5}}, count_found, found);
+    assert(found[0] == 1 && found[1] == 1 && found[2] == 1);
+    // Inside a fat box, but not the box itself
+    aabb_tree_query(tree, (AABB) {{6.05, 6.05}, {6.08, 6.08}}, count_found, found);
+    assert(found[0] == 1 && found[1] == 1 && found[2] == 1);
+    aabb_tree_free(tree);
+}
+
+void test_tree_fat_boxes() {
+    AABBTree *tree = aabb_tree_init(0.5);
+    size_t proxy = aabb_tree_insert(tree, 0, (AABB) {{0, 0}, {2, 2}});
+    aabb_tree_insert(tree, 1, (AABB) {{10, 10}, {12, 12}});
+    // The fat box reaches 1 past each side
+    assert(!aabb_tree_move(tree, proxy, 0, (AABB) {{0.9, -0.9}, {2.9, 1.1}}));
+    assert(aabb_tree_move(tree, proxy, 0, (AABB) {{1.5, 0}, {3.5, 2}}));
+    aabb_tree_validate(tree);
+    aabb_tree_free(tree);
+}
+
+void test_tree_balanced() {
+    AABBTree *tree = aabb_tree_init(0);
+    // Inserting in sorted order would make an unbalanced tree a list
+    for (size_t i = 0; i < 1024; i++) {
+        aabb_tree_insert(tree, i, (AABB) {{i, 0}, {i + 0.5, 1}});
+    }
+    aabb_tree_validate(tree);
+    assert(aabb_tree_height(tree) <= 2 * 11);
+    aabb_tree_free(tree);
+}
+
+void test_tree_matches_brute_force() {
+    srand(4);
+    AABB boxes[NUM_BOXES];
+    Vector velocities[NUM_BOXES];
+    bool present[NUM_BOXES];
+    size_t proxies[NUM_BOXES];
+    AABBTree *tree = aabb_tree_init(0.2);
+    PairBuffer *pairs = pair_buffer_init(1);
+    for (size_t i = 0; i < NUM_BOXES; i++) {
+        Vector min = {rand_range(-50, 50), rand_range(-50, 50)};
+        // Sizes spread over three orders of magnitude
+        double size = i % 100 == 0 ? 40 : (i % 2 ? rand_range(0.05, 0.5) : rand_range(1, 5));
+        boxes[i] = (AABB) {min, {min.x + size, min.y + size}};
+        // Each box moves a small fraction of its size per round
+        velocities[i] = vec_multiply(size, (Vector) {rand_range(-0.1, 0.1), rand_range(-0.1, 0.1)});
+        present[i] = true;
+        proxies[i] = aabb_tree_insert(tree, i, boxes[i]);
+    }
+    size_t reinserted = 0;
+    for (int round = 0; round < NUM_ROUNDS; round++) {
+        for (size_t i = 0; i < NUM_BOXES; i++) {
+            if (present[i] && rand() % 20 == 0) {
+                aabb_tree_remove(tree, proxies[i]);
+                present[i] = false;
+                continue;
+            }
+            boxes[i].min = vec_add(boxes[i].min, velocities[i]);
+            boxes[i].max = vec_add(boxes[i].max, velocities[i]);
+            if (!present[i]) {
+                if (rand() % 4 == 0) {
+                    proxies[i] = aabb_tree_insert(tree, i, boxes[i]);
+                    present[i] = true;
+                }
+            } else if (aabb_tree_move(tree, proxies[i], i, boxes[i])) {
+                reinserted++;
+            }
+        }
+        aabb_tree_validate(tree);
+        pair_buffer_clear(pairs);
+        aabb_tree_find_pairs(tree, pairs);
+        check_pairs(boxes, present, NUM_BOXES, pairs);
+    }
+    // Most moves stay inside the fat boxes
+    assert(reinserted < NUM_BOXES * NUM_ROUNDS / 2);
+    pair_buffer_free(pairs);
+    aabb_tree_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_tree_query)
+    DO_TEST(test_tree_fat_boxes)
+    DO_TEST(test_tree_balanced)
+    DO_TEST(test_tree_matches_brute_force)
+
+    puts("aabb_tree_test PASS");
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "arena.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+void test_arena_alloc() {
+    Arena *arena = arena_init(256, false);
+    char *a = arena_alloc(arena, 3);
+    char *b = arena_alloc(arena, 40);
+    assert((uintptr_t) a % _Alignof(max_align_t) == 0);
+    assert((uintptr_t) b % _Alignof(max_align_t) == 0);
+    assert(b >= a + 3);
+    memset(a, 1, 3);
+    memset(b, 2, 40);
+    assert(a[2] == 1 && b[0] == 2);
+    assert(arena_used(arena) >= 43);
+    arena_reset(arena);
+    assert(arena_used(arena) == 0);
+    // Memory is handed out again from the start after a reset
+    assert(arena_alloc(arena, 3) == a);
+    arena_free(arena);
+}
+
+void test_arena_grow() {
+    Arena *arena = arena_init(64, false);
+    int *values[100];
+    for (int i = 0; i < 100; i++) {
+        values[i] = arena_alloc(arena, 10 * sizeof(int));
+        for (int j = 0; j < 10; j++) {
+            values[i][j] = i * 10 + j;
+        }
+    }
+    // Growing does not move earlier allocations
+    for (int i = 0; i < 100; i++) {
+        for (int j = 0; j < 10; j++) {
+            assert(values[i][j] == i * 10 + j);
+        }
+    }
+    size_t used = arena_used(arena);
+    arena_reset(arena);
+    // The merged block holds a whole round of allocations
+    void *first = arena_alloc(arena, 10 * sizeof(int));
+    for (int i = 1; i < 100; i++) {
+        char *next = arena_alloc(arena, 10 * sizeof(int));
+        assert(next > (char *) first);
+    }
+    assert(arena_used(arena) == used);
+    arena_free(arena);
+}
+
+void test_arena_fixed() {
+    Arena *arena = arena_init(1024, true);
+    for (int round = 0; round < 10; round++) {
+        for (int i = 0; i < 16; i++) {
+            arena_alloc(arena, 64);
+        }
+        assert(arena_used(arena) == 1024);
+        arena_reset(arena);
+    }
+    arena_free(arena);
+}
+
+void test_arena_rewind() {
+    Arena *arena = arena_init(64, false);
+    char *kept = arena_alloc(arena, 16);
+    size_t used = arena_used(arena);
+    char *first = arena_alloc(arena, 16);
+    arena_rewind(arena, used);
+    assert(arena_used(arena) == used);
+    // Memory after the mark is handed out again
+    assert(arena_alloc(arena, 16) == first);
+    arena_rewind(arena, used);
+    // including after the arena grew past it
+    for (int i = 0; i < 10; i++) {
+        arena_alloc(arena, 40);
+    }
+    arena_rewind(arena, used);
+    assert(arena_used(arena) == used);
+    assert(arena_alloc(arena, 16) == first);
+    kept[0] = 1;
+    arena_rewind(arena, 0);
+    assert(arena_alloc(arena, 16) == kept);
+    arena_free(arena);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_arena_alloc)
+    DO_TEST(test_arena_grow)
+    DO_TEST(test_arena_fixed)
+    DO_TEST(test_arena_rewind)
+
+    puts("arena_test PASS");
+    return 0;
+}
@@ -1,3 +1,42 @@
-int main(){
-  return 0;
+#include "aux.h"
+#include "shapes.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+void test_aux_bodies_constants() {
+    Body *body1 = body_init(make_square(2), 1, (RGBColor) {0, 0, 0});
+    Body *body2 = body_init(make_square(2), 1, (RGBColor) {0, 0, 0});
+    Aux *aux = aux_init(2, 1);
+    aux_body_add(aux, body1);
+    aux_body_add(aux, body2);
+    // Constants grow past the initial size
+    for (int i = 0; i < 10; i++) {
+        aux_constant_add(aux, i * 0.5);
+    }
+    assert(aux_num_bodies(aux) == 2);
+    assert(aux_num_constants(aux) == 10);
+    assert(aux_get_body(aux, 0) == body1);
+    assert(aux_get_body(aux, 1) == body2);
+    for (int i = 0; i < 10; i++) {
+        assert(aux_get_constant(aux, i) == i * 0.5);
+    }
+    aux_free(aux);
+    body_free(body1);
+    body_free(body2);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_aux_bodies_constants)
+
+    puts("aux_test PASS");
+    return 0;
 }
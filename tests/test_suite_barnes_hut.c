@@ -0,0 +1,110 @@
+#include "barnes_hut.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define NUM_MASSES 500
+
+/* The field at mass i, summed over every other mass */
+Vector direct_field(const Vector *positions, const double *masses, size_t n,
+                    size_t i, double min_distance) {
+    Vector field = VEC_ZERO;
+    for (size_t j = 0; j < n; j++) {
+        Vector r = vec_subtract(positions[j], positions[i]);
+        double distance = sqrt(vec_dot(r, r));
+        if (j == i || distance == 0) {
+            continue;
+        }
+        double clamped = fmax(distance, min_distance);
+        field = vec_add(field, vec_multiply(masses[j] / (distance * clamped * clamped), r));
+    }
+    return field;
+}
+
+void random_masses(Vector *positions, double *masses, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        // Clustered, so the tree has to go deep in places
+        double spread = i % 3 == 0 ? 1000 : 10;
+        positions[i] = (Vector) {rand_range(-spread, spread), rand_range(-spread, spread)};
+        masses[i] = rand_range(1, 100);
+    }
+}
+
+void test_barnes_hut_exact() {
+    srand(5);
+    Vector positions[NUM_MASSES];
+    double masses[NUM_MASSES];
+    random_masses(positions, masses, NUM_MASSES);
+    BarnesHut *tree = barnes_hut_init(0, 1);
+    barnes_hut_build(tree, positions, masses, NUM_MASSES);
+    for (size_t i = 0; i < NUM_MASSES; i++) {
+        Vector expected = direct_field(positions, masses, NUM_MASSES, i, 1);
+        Vector actual = barnes_hut_field(tree, i);
+        assert(vec_len(vec_subtract(actual, expected)) <= 1e-9 * vec_len(expected));
+    }
+    barnes_hut_free(tree);
+}
+
+void test_barnes_hut_approximate() {
+    srand(6);
+    Vector positions[NUM_MASSES];
+    double masses[NUM_MASSES];
+    random_masses(positions, masses, NUM_MASSES);
+    BarnesHut *tree = barnes_hut_init(0.5, 1);
+    // Building twice reuses the arrays
+    barnes_hut_build(tree, positions, masses, NUM_MASSES / 2);
+    barnes_hut_build(tree, positions, masses, NUM_MASSES);
+    double total_error = 0, total = 0;
+    for (size_t i = 0; i < NUM_MASSES; i++) {
+        Vector expected = direct_field(positions, masses, NUM_MASSES, i, 1);
+        Vector actual = barnes_hut_field(tree, i);
+        total_error += vec_len(vec_subtract(actual, expected));
+        total += vec_len(expected);
+    }
+    assert(total_error < 0.02 * total);
+    barnes_hut_free(tree);
+}
+
+void test_barnes_hut_coincident() {
+    // Masses at the same position must not split cells forever
+    Vector positions[] = {{1, 1}, {1, 1}, {1, 1}, {4, 5}};
+    double masses[] = {1, 2, 3, 4};
+    BarnesHut *tree = barnes_hut_init(0.5, 2);
+    barnes_hut_build(tree, positions, masses, 4);
+    Vector field = barnes_hut_field(tree, 3);
+    // 6 units of mass at distance 5
+    assert(vec_isclose(field, vec_multiply(6.0 / 125, (Vector) {-3, -4})));
+    field = barnes_hut_field(tree, 0);
+    assert(vec_isclose(field, vec_multiply(4.0 / 125, (Vector) {3, 4})));
+    barnes_hut_free(tree);
+}
+
+void test_barnes_hut_min_distance() {
+    Vector positions[] = {{0, 0}, {1, 0}};
+    double masses[] = {1, 8};
+    BarnesHut *tree = barnes_hut_init(0.5, 2);
+    barnes_hut_build(tree, positions, masses, 2);
+    // Acts as if the masses were 2 apart
+    assert(vec_isclose(barnes_hut_field(tree, 0), (Vector) {2, 0}));
+    assert(vec_isclose(barnes_hut_field(tree, 1), (Vector) {-0.25, 0}));
+    barnes_hut_free(tree);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_barnes_hut_exact)
+    DO_TEST(test_barnes_hut_approximate)
+    DO_TEST(test_barnes_hut_coincident)
+    DO_TEST(test_barnes_hut_min_distance)
+
+    puts("barnes_hut_test PASS");
+    return 0;
+}
@@ -72,6 +72,54 @@ void test_body_setters() {
     body_free(body);
 }
 
+void test_body_rotation_no_drift() {
+    Vector v[] = {{1, 1}, {2, 1}, {2, 2}, {1, 2}};
+    const size_t VERTICES = sizeof(v) / sizeof(*v);
+    List *shape = list_init(4, free);
+    for (size_t i = 0; i < VERTICES; i++) {
+        Vector *list_v = malloc(sizeof(*list_v));
+        *list_v = v[i];
+        list_add(shape, list_v);
+    }
+    Body *body = body_init(shape, 1, (RGBColor) {0, 0, 0});
+    // Many small rotations and moves, ending back at the starting pose
+    for (int i = 1; i <= 1000; i++) {
+        body_set_rotation(body, i * 0.01);
+        body_set_centroid(body, (Vector) {i, -i});
+    }
+    body_set_rotation(body, 0);
+    body_set_centroid(body, (Vector) {1.5, 1.5});
+    List *shape2 = body_get_shape(body);
+    for (size_t i = 0; i < VERTICES; i++) {
+        assert(vec_isclose(*(Vector *) list_get(shape2, i), v[i]));
+    }
+    list_free(shape2);
+    body_free(body);
+}
+
+void test_body_shape_view() {
+    Vector v[] = {{1, 1}, {2, 1}, {2, 2}, {1, 2}};
+    const size_t VERTICES = sizeof(v) / sizeof(*v);
+    List *shape = list_init(4, free);
+    for (size_t i = 0; i < VERTICES; i++) {
+        Vector *list_v = malloc(sizeof(*list_v));
+        *list_v = v[i];
+        list_add(shape, list_v);
+    }
+    Body *body = body_init(shape, 1, (RGBColor) {0, 0, 0});
+    ShapeView view = body_get_shape_view(body);
+    assert(view.size == VERTICES);
+    for (size_t i = 0; i < VERTICES; i++) {
+        assert(vec_isclose(view.vertices[i], v[i]));
+    }
+    body_set_centroid(body, (Vector) {0.5, 1.5});
+    view = body_get_shape_view(body);
+    for (size_t i = 0; i < VERTICES; i++) {
+        assert(vec_isclose(view.vertices[i], vec_add(v[i], (Vector) {-1, 0})));
+    }
+    body_free(body);
+}
+
 void test_body_tick() {
     const Vector A = {1, 2};
     const double DT = 1e-6;
@@ -248,6 +296,8 @@ int main(int argc, char *argv[]) {
 
     DO_TEST(test_body_init)
     DO_TEST(test_body_setters)
+    DO_TEST(test_body_rotation_no_drift)
+    DO_TEST(test_body_shape_view)
     DO_TEST(test_body_tick)
     DO_TEST(test_infinite_mass)
     DO_TEST(test_forces)
@@ -0,0 +1,146 @@
+#include "body_store.h"
+#include "body.h"
+#include "shapes.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+void test_store_add_remove() {
+    BodyStore *store = body_store_init(1);
+    Body *body1 = body_init(make_square(2), 1, (RGBColor) {0, 0, 0});
+    Body *body2 = body_init(make_square(2), 2, (RGBColor) {0, 0, 0});
+    Body *body3 = body_init(make_square(2), 3, (RGBColor) {0, 0, 0});
+    body_set_centroid(body1, (Vector) {1, 1});
+    body_set_centroid(body2, (Vector) {2, 2});
+    body_set_centroid(body3, (Vector) {3, 3});
+    body_set_store(body1, store);
+    body_set_store(body2, store);
+    body_set_store(body3, store);
+    assert(store->size == 3);
+    assert(store->capacity >= 3);
+
+    // Removing the first slot moves the last body into it
+    body_free(body1);
+    assert(store->size == 2);
+    assert(store->handles[0] == body3);
+    assert(vec_equal(store->position[0], (Vector) {3, 3}));
+    assert(vec_equal(body_get_centroid(body3), (Vector) {3, 3}));
+    assert(vec_equal(body_get_centroid(body2), (Vector) {2, 2}));
+    assert(body_get_mass(body3) == 3);
+
+    body_free(body2);
+    body_free(body3);
+    assert(store->size == 0);
+    body_store_free(store);
+}
+
+void test_store_keeps_state() {
+    BodyStore *store = body_store_init(4);
+    Body *body = body_init(make_square(2), 2, (RGBColor) {0, 0, 0});
+    body_set_velocity(body, (Vector) {1, 2});
+    body_add_force(body, (Vector) {3, 4});
+    body_add_impulse(body, (Vector) {5, 6});
+    body_remove(body);
+    body_set_store(body, store);
+    assert(vec_equal(body_get_velocity(body), (Vector) {1, 2}));
+    assert(vec_equal(body_get_force(body), (Vector) {3, 4}));
+    assert(vec_equal(body_get_impulse(body), (Vector) {5, 6}));
+    assert(body_is_removed(body));
+    body_free(body);
+    body_store_free(store);
+}
+
+void test_store_integrate() {
+    const double DT = 0.5;
+    BodyStore *store = body_store_init(2);
+    Body *light = body_init(make_square(2), 1, (RGBColor) {0, 0, 0});
+    Body *wall = body_init(make_square(2), INFINITY, (RGBColor) {0, 0, 0});
+    body_set_store(light, store);
+    body_set_store(wall, store);
+    body_set_velocity(wall, (Vector) {1, 0});
+    body_add_force(light, (Vector) {2, 0});
+    body_add_force(wall, (Vector) {2, 0});
+    body_add_impulse(light, (Vector) {0, 1});
+    body_store_integrate(store, 0, store->size, DT);
+    assert(vec_isclose(body_get_velocity(light), (Vector) {1, 1}));
+    assert(vec_isclose(body_get_centroid(light), (Vector) {0.25, 0.25}));
+    assert(vec_equal(body_get_force(light), VEC_ZERO));
+    assert(vec_equal(body_get_impulse(light), VEC_ZERO));
+    assert(vec_equal(body_get_velocity(wall), (Vector) {1, 0}));
+    assert(vec_isclose(body_get_centroid(wall), (Vector) {0.5, 0}));
+    body_free(light);
+    body_free(wall);
+    body_store_free(store);
+}
+
+void test_store_sleep_wake() {
+    BodyStore *store = body_store_init(1);
+    Body *bodies[4];
+    for (size_t i = 0; i < 4; i++) {
+        bodies[i] = body_init(make_square(2), 1, (RGBColor) {0, 0, 0});
+        body_set_centroid(bodies[i], (Vector) {i, 0});
+        body_set_velocity(bodies[i], (Vector) {1, 0});
+        body_set_store(bodies[i], store);
+    }
+    assert(store->awake == 4);
+
+    // Sleeping slots move behind the awake ones and stop
+    body_store_sleep(store, body_get_slot(bodies[0]), 1);
+    body_store_sleep(store, body_get_slot(bodies[2]), 1);
+    body_store_sleep(store, body_get_slot(bodies[3]), 2);
+    assert(store->awake == 1);
+    assert(store->handles[0] == bodies[1]);
+    assert(body_is_asleep(bodies[0]) && body_is_asleep(bodies[2]) && body_is_asleep(bodies[3]));
+    assert(!body_is_asleep(bodies[1]));
+    assert(vec_equal(body_get_velocity(bodies[0]), VEC_ZERO));
+    assert(vec_equal(body_get_centroid(bodies[2]), (Vector) {2, 0}));
+    body_store_integrate(store, 0, store->awake, 1);
+    assert(vec_equal(body_get_centroid(bodies[1]), (Vector) {2, 0}));
+    assert(vec_equal(body_get_centroid(bodies[0]), (Vector) {0, 0}));
+
+    // A new slot is awake
+    Body *added = body_init(make_square(2), 1, (RGBColor) {0, 0, 0});
+    body_set_store(added, store);
+    assert(store->awake == 2 && !body_is_asleep(added));
+    assert(body_is_asleep(bodies[0]) && body_is_asleep(bodies[3]));
+
+    // Waking a body wakes its whole island
+    body_wake(bodies[0]);
+    assert(store->awake == 4);
+    assert(!body_is_asleep(bodies[0]) && !body_is_asleep(bodies[2]));
+    assert(body_is_asleep(bodies[3]));
+
+    // Removing an awake slot keeps the sleeping one behind the awake ones
+    body_free(bodies[1]);
+    assert(store->awake == 3 && store->size == 4);
+    assert(body_is_asleep(bodies[3]) && store->handles[3] == bodies[3]);
+    for (size_t i = 0; i < store->size; i++) {
+        assert(body_get_slot(store->handles[i]) == i);
+    }
+    body_free(bodies[3]);
+    assert(store->awake == 3);
+    body_free(bodies[0]);
+    body_free(bodies[2]);
+    body_free(added);
+    assert(store->size == 0 && store->awake == 0);
+    body_store_free(store);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_store_add_remove)
+    DO_TEST(test_store_keeps_state)
+    DO_TEST(test_store_integrate)
+    DO_TEST(test_store_sleep_wake)
+
+    puts("body_store_test PASS");
+    return 0;
+}
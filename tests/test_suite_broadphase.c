@@ -0,0 +1,53 @@
+#include "broadphase.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+void test_pair_buffer_add() {
+    PairBuffer *buffer = pair_buffer_init(1);
+    for (size_t i = 0; i < 100; i++) {
+        pair_buffer_add(buffer, i + 1, i);
+    }
+    assert(buffer->size == 100);
+    assert(buffer->capacity >= 100);
+    for (size_t i = 0; i < 100; i++) {
+        // The smaller id always comes first
+        assert(buffer->pairs[i].first == i);
+        assert(buffer->pairs[i].second == i + 1);
+    }
+    pair_buffer_clear(buffer);
+    assert(buffer->size == 0);
+    assert(buffer->capacity >= 100);
+    pair_buffer_free(buffer);
+}
+
+void test_pair_buffer_sort() {
+    PairBuffer *buffer = pair_buffer_init(4);
+    pair_buffer_add(buffer, 3, 1);
+    pair_buffer_add(buffer, 0, 5);
+    pair_buffer_add(buffer, 2, 0);
+    pair_buffer_add(buffer, 1, 2);
+    pair_buffer_sort(buffer);
+    size_t expected[][2] = {{0, 2}, {0, 5}, {1, 2}, {1, 3}};
+    for (size_t i = 0; i < 4; i++) {
+        assert(buffer->pairs[i].first == expected[i][0]);
+        assert(buffer->pairs[i].second == expected[i][1]);
+    }
+    pair_buffer_free(buffer);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_pair_buffer_add)
+    DO_TEST(test_pair_buffer_sort)
+
+    puts("broadphase_test PASS");
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "ccd.h"
+#include "collision.h"
+#include "polygon.h"
+#include "shapes.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define WALL_HEIGHT 10
+#define WALL_WIDTH 0.2
+
+// A thin wall along the y-axis, from y = -5 to y = 5
+Shape *make_wall() {
+    return shape_rectangle(WALL_HEIGHT, WALL_WIDTH);
+}
+
+void test_circle_polygon_toi() {
+    Shape *wall = make_wall();
+    ShapeView view = shape_view(wall);
+    Vector normals[4];
+    polygon_view_edge_normals(view, normals);
+    double toi;
+    Vector axis;
+
+    // Ends well past the wall, so the discrete test would miss it
+    assert(ccd_circle_polygon_toi((Vector) {5, 0}, 0.5, view, normals, (Vector) {10, 0},
+                                  &toi, &axis));
+    assert(isclose(toi, 0.44));
+    assert(vec_isclose(axis, (Vector) {1, 0}));
+    // Computing the normals gives the same impact
+    assert(ccd_circle_polygon_toi((Vector) {5, 0}, 0.5, view, NULL, (Vector) {10, 0},
+                                  &toi, &axis));
+    assert(isclose(toi, 0.44));
+
+    // Clips the wall's corner
+    assert(ccd_circle_polygon_toi((Vector) {5, 5.3}, 0.5, view, normals, (Vector) {10, 0},
+                                  &toi, &axis));
+    assert(isclose(toi, 0.45));
+    assert(vec_isclose(axis, (Vector) {0.8, -0.6}));
+
+    // Passes over the wall, stops short of it, or moves away from it
+    assert(!ccd_circle_polygon_toi((Vector) {5, 5.6}, 0.5, view, normals, (Vector) {10, 0},
+                                   &toi, &axis));
+    assert(!ccd_circle_polygon_toi((Vector) {-1, 0}, 0.5, view, normals, (Vector) {1, 0},
+                                   &toi, &axis));
+    assert(!ccd_circle_polygon_toi((Vector) {-5, 0}, 0.5, view, normals, (Vector) {-1, 0},
+                                   &toi, &axis));
+    // Already overlaps at the start
+    assert(!ccd_circle_polygon_toi((Vector) {10, 0}, 0.5, view, normals, (Vector) {10, 0},
+                                   &toi, &axis));
+    shape_free(wall);
+}
+
+void test_circle_circle_toi() {
+    double toi;
+    Vector axis;
+    assert(ccd_circle_circle_toi((Vector) {10, 0}, 1, VEC_ZERO, 1, (Vector) {20, 0},
+                                 &toi, &axis));
+    assert(isclose(toi, 0.4));
+    assert(vec_isclose(axis, (Vector) {1, 0}));
+    assert(!ccd_circle_circle_toi((Vector) {10, 3}, 1, VEC_ZERO, 1, (Vector) {20, 0},
+                                  &toi, &axis));
+    assert(!ccd_circle_circle_toi((Vector) {1, 0}, 1, VEC_ZERO, 1, (Vector) {1, 0},
+                                  &toi, &axis));
+}
+
+void test_conservative_advancement() {
+    Shape *wall = make_wall();
+    Shape *square = shape_square(1);
+    shape_translate(square, (Vector) {5, 0});
+    double toi;
+    Vector axis;
+    double tolerance = 2 * CCD_TOLERANCE;
+
+    // Face against face
+    assert(ccd_conservative_advancement(shape_view(square), NULL, shape_view(wall), NULL,
+                                        (Vector) {10, 0}, &toi, &axis));
+    assert(within(tolerance, toi, 0.44));
+    assert(vec_isclose(axis, (Vector) {1, 0}));
+
+    // Corner against face
+    shape_rotate(square, M_PI / 4, (Vector) {5, 0});
+    assert(ccd_conservative_advancement(shape_view(square), NULL, shape_view(wall), NULL,
+                                        (Vector) {10, 0}, &toi, &axis));
+    double expected = (5 - 0.1 - sqrt(0.5)) / 10;
+    assert(within(tolerance, toi, expected));
+
+    // Misses the wall, or starts overlapping it
+    assert(!ccd_conservative_advancement(shape_view(square), NULL, shape_view(wall), NULL,
+                                         (Vector) {10, 20}, &toi, &axis));
+    assert(!ccd_conservative_advancement(shape_view(square), NULL, shape_view(wall), NULL,
+                                         (Vector) {5, 0}, &toi, &axis));
+    shape_free(square);
+    shape_free(wall);
+}
+
+// A polygon swept against a circle uses the circle's test seen from the circle
+void test_time_of_impact() {
+    Shape *square = shape_square(1);
+    shape_translate(square, (Vector) {5, 0});
+    CcdShape polygon = {shape_view(square), NULL, VEC_ZERO, 0};
+    CcdShape circle = {{NULL, 0}, NULL, VEC_ZERO, 1};
+    double toi;
+    Vector axis;
+    assert(ccd_time_of_impact(polygon, circle, (Vector) {10, 0}, &toi, &axis));
+    assert(isclose(toi, 0.35));
+    assert(vec_isclose(axis, (Vector) {1, 0}));
+    assert(ccd_time_of_impact(circle, polygon, (Vector) {-10, 0}, &toi, &axis));
+    assert(isclose(toi, 0.35));
+    assert(vec_isclose(axis, (Vector) {-1, 0}));
+    shape_free(square);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_circle_polygon_toi)
+    DO_TEST(test_circle_circle_toi)
+    DO_TEST(test_conservative_advancement)
+    DO_TEST(test_time_of_impact)
+
+    puts("ccd_test PASS");
+    return 0;
+}
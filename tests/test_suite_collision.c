@@ -1,236 +1,222 @@
-int main (){
-  return 0;
-}
-/*
-#include "list.h"
+#include "collision.h"
+#include "shapes.h"
 #include "test_util.h"
-#include "vector.h"
-
 #include <assert.h>
+#include <math.h>
 #include <stdlib.h>
 
-void test_list_size0() {
-    List *l = list_init(0, free);
-    assert(list_size(l) == 0);
-    list_free(l);
+Shape *square_at(double side, Vector center) {
+    Shape *square = shape_square(side);
+    shape_translate(square, center);
+    return square;
 }
 
-void test_list_size1() {
-    List *l = list_init(1, free);
-    assert(list_size(l) == 0);
-    // Add
-    list_add(l, vmalloc((Vector){0, 0}));
-    assert(list_size(l) == 1);
-    // Remove
-    assert(vec_equal(*(Vector *)list_remove_back(l), (Vector){0, 0}));
-    assert(list_size(l) == 0);
-    // Add again
-    list_add(l, vmalloc((Vector){1, 1}));
-    assert(list_size(l) == 1);
-    assert(vec_equal(*(Vector *)list_get(l,0), (Vector){1, 1}));
-    // Set
-    list_set(l, 0, vmalloc((Vector){1, 2}));
-    assert(list_size(l) == 1);
-    assert(vec_equal(*(Vector *)list_get(l,0), (Vector){1, 2}));
-    list_free(l);
-  }
+// The bounding box pre-check must not include the origin
+void test_far_from_origin() {
+    Shape *square1 = square_at(2, (Vector) {10, 10});
+    Shape *square2 = square_at(2, (Vector) {13, 10});
+    assert(!find_collision_view(shape_view(square1), shape_view(square2)).collided);
+    shape_translate(square2, (Vector) {-1.5, 0.5});
+    CollisionInfo info = find_collision_view(shape_view(square1), shape_view(square2));
+    assert(info.collided);
+    assert(vec_isclose(info.axis, (Vector) {1, 0}));
+    assert(isclose(info.depth, 0.5));
+    shape_free(square1);
+    shape_free(square2);
+}
 
-void test_list_small() {
-    List *l = list_init(5, free);
-    assert(list_size(l) == 0);
-    // Fill partially
-    list_add(l, vmalloc((Vector){0, 0}));
-    list_add(l, vmalloc((Vector){1, 1}));
-    list_add(l, vmalloc((Vector){2, 2}));
-    assert(list_size(l) == 3);
-    assert(vec_equal(*(Vector *)list_get(l, 0), (Vector){0, 0}));
-    assert(vec_equal(*(Vector *)list_get(l, 1), (Vector){1, 1}));
-    assert(vec_equal(*(Vector *)list_get(l, 2), (Vector){2, 2}));
-    // Fill to capacity
-    list_add(l, vmalloc((Vector){3, 3}));
-    list_add(l, vmalloc((Vector){4, 4}));
-    assert(list_size(l) == 5);
-    assert(vec_equal(*(Vector *)list_get(l, 3), (Vector){3, 3}));
-    assert(vec_equal(*(Vector *)list_get(l, 4), (Vector){4, 4}));
-    // Remove some
-    assert(vec_equal(*(Vector *)list_remove_back(l), (Vector){4, 4}));
-    assert(vec_equal(*(Vector *)list_remove_back(l), (Vector){3, 3}));
-    assert(list_size(l) == 3);
-    // Add, replacing previous elements
-    list_add(l, vmalloc((Vector){5, 5}));
-    list_add(l, vmalloc((Vector){6, 6}));
-    assert(list_size(l) == 5);
-    assert(vec_equal(*(Vector *)list_get(l, 0), (Vector){0, 0}));
-    assert(vec_equal(*(Vector *)list_get(l, 1), (Vector){1, 1}));
-    assert(vec_equal(*(Vector *)list_get(l, 2), (Vector){2, 2}));
-    assert(vec_equal(*(Vector *)list_get(l, 3), (Vector){5, 5}));
-    assert(vec_equal(*(Vector *)list_get(l, 4), (Vector){6, 6}));
-    // Overwrite added elements
-    list_set(l, 3, vmalloc((Vector){7, 7}));
-    list_set(l, 4, vmalloc((Vector){8, 8}));
-    assert(vec_equal(*(Vector *)list_get(l, 0), (Vector){0, 0}));
-    assert(vec_equal(*(Vector *)list_get(l, 1), (Vector){1, 1}));
-    assert(vec_equal(*(Vector *)list_get(l, 2), (Vector){2, 2}));
-    assert(vec_equal(*(Vector *)list_get(l, 3), (Vector){7, 7}));
-    assert(vec_equal(*(Vector *)list_get(l, 4), (Vector){8, 8}));
-    list_free(l);
+// Only the edge from the last vertex to the first separates these shapes
+void test_closing_edge() {
+    Shape *triangle = shape_init(3);
+    shape_add(triangle, (Vector) {0, 0});
+    shape_add(triangle, (Vector) {4, 0});
+    shape_add(triangle, (Vector) {4, 4});
+    Shape *square = square_at(1, (Vector) {1, 3});
+    assert(!find_collision_view(shape_view(triangle), shape_view(square)).collided);
+    assert(!find_collision_view(shape_view(square), shape_view(triangle)).collided);
+    shape_translate(square, (Vector) {1, -1});
+    assert(find_collision_view(shape_view(triangle), shape_view(square)).collided);
+    shape_free(triangle);
+    shape_free(square);
 }
 
-#define LARGE_SIZE 10000
+void test_axis_points_from_first_to_second() {
+    Shape *square1 = square_at(2, (Vector) {0, 0});
+    Shape *square2 = square_at(2, (Vector) {0.25, -1.75});
+    CollisionInfo info = find_collision_view(shape_view(square1), shape_view(square2));
+    assert(info.collided);
+    assert(vec_isclose(info.axis, (Vector) {0, -1}));
+    assert(isclose(info.depth, 0.25));
+    info = find_collision_view(shape_view(square2), shape_view(square1));
+    assert(vec_isclose(info.axis, (Vector) {0, 1}));
+    assert(isclose(info.depth, 0.25));
+    shape_free(square1);
+    shape_free(square2);
+}
 
-// Get/set elements in large list
-void test_list_large_get_set() {
-    List *l = list_init(LARGE_SIZE, free);
-    // Add to capacity
-    for (size_t i = 0; i < LARGE_SIZE; i++) {
-        list_add(l, vmalloc((Vector){i, i}));
-    }
-    // Check
-    for (size_t i = 0; i < LARGE_SIZE; i++) {
-        assert(vec_equal(*(Vector *)list_get(l, i), (Vector){i, i}));
-    }
-    // Set every 100th value
-    for (size_t i = 0; i < LARGE_SIZE; i += 100) {
-        list_set(l, i, vmalloc((Vector){10 * i, 10 * i}));
-    }
-    // Check all values again
-    for (size_t i = 0; i < LARGE_SIZE; i++) {
-        if (i % 100 == 0) {
-            assert(vec_equal(*(Vector *)list_get(l, i), (Vector){10 * i, 10 * i}));
-        } else {
-            assert(vec_equal(*(Vector *)list_get(l, i), (Vector){i, i}));
+void test_cached_normals() {
+    Body *body1 = body_init_shape(shape_ngon(5, 1), 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    Body *body2 = body_init_shape(shape_square(1), 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    body_set_rotation(body1, 0.3);
+    body_set_rotation(body2, -1.1);
+    for (double x = -2.5; x <= 2.5; x += 0.25) {
+        body_set_centroid(body2, (Vector) {x, 0.5});
+        CollisionInfo cached = find_collision_normals(body_get_shape_view(body1), body_get_normals(body1),
+                                                      body_get_shape_view(body2), body_get_normals(body2));
+        CollisionInfo computed = find_collision_view(body_get_shape_view(body1), body_get_shape_view(body2));
+        assert(cached.collided == computed.collided);
+        if (cached.collided) {
+            assert(vec_isclose(cached.axis, computed.axis));
+            assert(isclose(cached.depth, computed.depth));
         }
     }
-    list_free(l);
+    body_free(body1);
+    body_free(body2);
 }
 
-// Add/remove elements from a large list
-void test_list_large_add_remove() {
-    List *l = list_init(LARGE_SIZE, free);
-    // Add to capacity
-    for (size_t i = 0; i < LARGE_SIZE; i++) {
-        list_add(l, vmalloc((Vector){i, i}));
-    }
-    // Remove all
-    for (size_t i = 0; i < LARGE_SIZE; i++) {
-        size_t value = LARGE_SIZE - 1 - i;
-        assert(vec_equal(*(Vector *)list_remove_back(l), (Vector){value, value}));
-    }
-    // Add to capacity again
-    for (size_t i = 0; i < LARGE_SIZE; i++) {
-        list_add(l, vmalloc((Vector){i + 1, i + 1}));
-    }
-    // Check all
-    for (size_t i = 0; i < LARGE_SIZE; i++) {
-        assert(vec_equal(*(Vector *)list_get(l, i), (Vector){i + 1, i + 1}));
-    }
-    list_free(l);
+void test_circle_circle() {
+    assert(!find_circle_collision((Vector) {0, 0}, 1, (Vector) {3, 4}, 3.5).collided);
+    CollisionInfo info = find_circle_collision((Vector) {0, 0}, 2, (Vector) {3, 4}, 3.5);
+    assert(info.collided);
+    assert(vec_isclose(info.axis, (Vector) {0.6, 0.8}));
+    assert(isclose(info.depth, 0.5));
 }
 
-#define MEDIUM_SIZE 100
-// Medium size used because add front is horrendously inefficient as is
-void test_list_add_front_remove(){
-  List *l = list_init(MEDIUM_SIZE+10, free);
-  // Add_front to capacity
-  for (size_t i = 0; i < MEDIUM_SIZE; i++) {
-      list_add_front(l, vmalloc((Vector){i, i}));
-  }
-  // Remove all (now in reverse order)
-  for (size_t i = 0; i < MEDIUM_SIZE; i++) {
-      size_t value = i;
-      assert(vec_equal(*(Vector *)list_remove_back(l), (Vector){value, value}));
-  }
-  list_free(l);
+void test_circle_polygon() {
+    Shape *square = square_at(2, (Vector) {10, 0});
+    ShapeView view = shape_view(square);
+    // Beside a face
+    assert(!find_circle_polygon_collision((Vector) {7.5, 0.5}, 1, view, NULL).collided);
+    CollisionInfo info = find_circle_polygon_collision((Vector) {8.5, 0.5}, 1, view, NULL);
+    assert(info.collided);
+    assert(vec_isclose(info.axis, (Vector) {1, 0}));
+    assert(isclose(info.depth, 0.5));
+    // Beside a corner, the closest point is the corner itself
+    assert(!find_circle_polygon_collision((Vector) {8.2, 1.8}, 1, view, NULL).collided);
+    info = find_circle_polygon_collision((Vector) {8.6, 1.6}, 1, view, NULL);
+    assert(info.collided);
+    assert(vec_isclose(info.axis, vec_unit((Vector) {0.4, -0.6})));
+    assert(isclose(info.depth, 1 - sqrt(0.52)));
+    // With its center inside, the circle leaves through the nearest face
+    info = find_circle_polygon_collision((Vector) {10.2, -0.7}, 0.5, view, NULL);
+    assert(info.collided);
+    assert(vec_isclose(info.axis, (Vector) {0, 1}));
+    assert(isclose(info.depth, 0.8));
+    shape_free(square);
 }
 
-typedef struct {
-    List *list;
-    size_t index;
-} ListAccess;
-void get_out_of_bounds(void *access) {
-    free(list_get(((ListAccess *) access)->list, ((ListAccess *) access)->index));
-}
-void set_out_of_bounds(void *access) {
-    list_set(
-        ((ListAccess *) access)->list,
-        ((ListAccess *) access)->index,
-        vmalloc(VEC_ZERO)
-    );
+void test_circle_bodies() {
+    Body *ball = body_init_circle(1, 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    Body *other = body_init_circle(2, 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    Body *square = body_init_shape(shape_square(2), 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    assert(body_get_kind(ball) == BODY_CIRCLE);
+    assert(body_get_kind(square) == BODY_POLYGON);
+    assert(body_get_shape_view(ball).size == 0);
+    body_set_centroid(other, (Vector) {0, 2.5});
+    body_set_centroid(square, (Vector) {1.5, 0});
+    CollisionInfo info = find_body_collision(ball, other, NULL);
+    assert(info.collided && vec_isclose(info.axis, (Vector) {0, 1}) && isclose(info.depth, 0.5));
+    info = find_body_collision(ball, square, NULL);
+    assert(info.collided && vec_isclose(info.axis, (Vector) {1, 0}) && isclose(info.depth, 0.5));
+    info = find_body_collision(square, ball, NULL);
+    assert(info.collided && vec_isclose(info.axis, (Vector) {-1, 0}) && isclose(info.depth, 0.5));
+    // Resizing a circle body changes what it collides with
+    body_set_radius(ball, 0.4);
+    assert(!find_body_collision(ball, square, NULL).collided);
+    body_free(ball);
+    body_free(other);
+    body_free(square);
 }
-void test_out_of_bounds_access() {
-    const size_t max_size = 5;
-    ListAccess *access = malloc(sizeof(*access));
-    access->list = list_init(max_size, free);
-    // This test takes several seconds to run
-    fputs("test_out_of_bounds_access running...\n", stderr);
-
-    // Try list with 0 elements, 1 element, ..., up to max_size elements
-    for (size_t size = 0; size <= max_size; size++) {
-        // Make sure negative indices report as out of bounds
-        for (access->index = -3; (int) access->index < 0; access->index++) {
-            assert(test_assert_fail(get_out_of_bounds, access));
-            assert(test_assert_fail(set_out_of_bounds, access));
-        }
-
-        // Make sure indices 0 through size - 1 are valid
-        for (access->index = 0; access->index < size; access->index++) {
-            // Store and retrieve an arbitrary vector
-            Vector v;
-            v.x = v.y = size + access->index;
-            list_set(access->list, access->index, vmalloc(v));
-            assert(vec_equal(*(Vector *)list_get(access->list, access->index), v));
-        }
 
-        // Assert indices greater than or equal to size are invalid
-        for (access->index = size; access->index < size + 3; access->index++) {
-            assert(test_assert_fail(get_out_of_bounds, access));
-            assert(test_assert_fail(set_out_of_bounds, access));
+// Finds the manifold point at a given position, if there is one
+ContactPoint *find_point(ContactManifold *manifold, Vector point) {
+    for (size_t i = 0; i < manifold->count; i++) {
+        if (vec_isclose(manifold->points[i].point, point)) {
+            return &manifold->points[i];
         }
-
-        // Increase the size of the list by 1
-        if (size < max_size) list_add(access->list, vmalloc(VEC_ZERO));
     }
-    list_free(access->list);
-    free(access);
+    return NULL;
 }
 
-void add_past_end(void *l) {
-    list_add((List *) l, vmalloc(VEC_ZERO));
+// A box resting flat on the ground touches it at both of its bottom corners
+void test_manifold_face_to_face() {
+    Shape *ground = shape_rectangle(2, 10);
+    shape_translate(ground, (Vector) {0, -1});
+    Shape *box = square_at(2, (Vector) {1, 0.9});
+    ContactManifold manifold = find_collision_manifold(shape_view(box), NULL,
+                                                       shape_view(ground), NULL);
+    assert(manifold.collided && manifold.count == 2);
+    assert(vec_isclose(manifold.axis, (Vector) {0, -1}) && isclose(manifold.depth, 0.1));
+    // The box's bottom edge is the reference, so the ground's top edge is clipped to it
+    ContactPoint *left = find_point(&manifold, (Vector) {0, 0});
+    ContactPoint *right = find_point(&manifold, (Vector) {2, 0});
+    assert(left != NULL && right != NULL && left->id != right->id);
+    assert(isclose(left->depth, 0.1) && isclose(right->depth, 0.1));
+    assert(left->impulse == 0);
+
+    // Sliding a little keeps the same features
+    uint32_t left_id = left->id, right_id = right->id;
+    shape_translate(box, (Vector) {0.25, -0.05});
+    manifold = find_collision_manifold(shape_view(box), NULL, shape_view(ground), NULL);
+    assert(manifold.count == 2);
+    left = find_point(&manifold, (Vector) {0.25, 0});
+    right = find_point(&manifold, (Vector) {2.25, 0});
+    assert(left != NULL && left->id == left_id && isclose(left->depth, 0.15));
+    assert(right != NULL && right->id == right_id);
+
+    // With the ground first, its top edge is the reference
+    manifold = find_collision_manifold(shape_view(ground), NULL, shape_view(box), NULL);
+    assert(manifold.count == 2 && vec_isclose(manifold.axis, (Vector) {0, 1}));
+    assert(find_point(&manifold, (Vector) {0.25, -0.15}) != NULL);
+    assert(find_point(&manifold, (Vector) {2.25, -0.15}) != NULL);
+    shape_free(ground);
+    shape_free(box);
 }
-void test_full_add() {
-    const size_t size = 3;
-    List *l = list_init(size, free);
 
-    // Fill list
-    for (size_t i = 0; i < size; i++) list_add(l, vmalloc(VEC_ZERO));
-
-    // Try adding to the full list -- should now let you do it and double size.
-    add_past_end(l);
-    assert(list_capacity(l) == size * 2);
-
-    list_free(l);
+// A tilted box touches the ground at one corner
+void test_manifold_corner() {
+    Shape *ground = shape_rectangle(2, 10);
+    shape_translate(ground, (Vector) {0, -1});
+    Shape *box = square_at(2, (Vector) {0, 1.2});
+    shape_rotate(box, 0.3, (Vector) {0, 1.2});
+    ContactManifold manifold = find_collision_manifold(shape_view(ground), NULL,
+                                                       shape_view(box), NULL);
+    assert(manifold.collided && manifold.count == 1);
+    assert(isclose(manifold.points[0].depth, manifold.depth));
+    assert(isclose(manifold.points[0].point.y, -manifold.depth));
+
+    shape_translate(box, (Vector) {0, 1});
+    assert(!find_collision_manifold(shape_view(ground), NULL, shape_view(box), NULL).collided);
+    shape_free(ground);
+    shape_free(box);
 }
 
-void remove_from_empty(void *l) {
-    free(list_remove_back((List *) l));
-}
-void test_empty_remove() {
-    const size_t size = 100;
-    List *l = list_init(size, free);
-
-    // Fill list with copies of v, then remove them all
-    Vector v = {.x = 1, .y = -2};
-    for (size_t i = 0; i < size; i++) list_add(l, vmalloc(v));
-    for (size_t i = 0; i < size; i++) assert(vec_equal(*(Vector *)list_remove_back(l), v));
-
-    // Try removing from the empty list -- should fail an assertion
-    assert(test_assert_fail(remove_from_empty, l));
-
-    list_free(l);
+// A circle touches at its point deepest inside the other shape
+void test_body_manifold() {
+    Body *ball = body_init_circle(1, 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    Body *square = body_init_shape(shape_square(2), 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    Body *box = body_init_shape(shape_square(2), 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    body_set_centroid(square, (Vector) {1.5, 0});
+    body_set_centroid(box, (Vector) {3, 1});
+    ContactManifold manifold = find_body_manifold(ball, square, NULL);
+    assert(manifold.collided && manifold.count == 1);
+    assert(vec_isclose(manifold.points[0].point, (Vector) {1, 0}));
+    assert(isclose(manifold.points[0].depth, 0.5));
+    manifold = find_body_manifold(square, ball, NULL);
+    assert(manifold.count == 1 && vec_isclose(manifold.points[0].point, (Vector) {1, 0}));
+    // Polygon bodies are clipped like their shapes
+    manifold = find_body_manifold(square, box, NULL);
+    assert(manifold.collided && manifold.count == 2);
+    assert(find_point(&manifold, (Vector) {2, 0}) != NULL);
+    assert(find_point(&manifold, (Vector) {2, 1}) != NULL);
+    body_set_centroid(box, (Vector) {5, 1});
+    assert(!find_body_manifold(square, box, NULL).collided);
+    body_free(ball);
+    body_free(square);
+    body_free(box);
 }
 
 int main(int argc, char *argv[]) {
-
     // Run all tests if there are no command-line arguments
     bool all_tests = argc == 1;
     // Read test name from file
@@ -239,18 +225,17 @@ int main(int argc, char *argv[]) {
         read_testname(argv[1], testname, sizeof(testname));
     }
 
-    DO_TEST(test_list_size0)
-    DO_TEST(test_list_size1)
-    DO_TEST(test_list_small)
-    DO_TEST(test_list_large_get_set)
-    DO_TEST(test_list_large_add_remove)
-    DO_TEST(test_list_add_front_remove)
-    DO_TEST(test_out_of_bounds_access)
-    DO_TEST(test_full_add)
-    DO_TEST(test_empty_remove)
-
-    puts("list_test PASS");
-
+    DO_TEST(test_far_from_origin)
+    DO_TEST(test_closing_edge)
+    DO_TEST(test_axis_points_from_first_to_second)
+    DO_TEST(test_cached_normals)
+    DO_TEST(test_circle_circle)
+    DO_TEST(test_circle_polygon)
+    DO_TEST(test_circle_bodies)
+    DO_TEST(test_manifold_face_to_face)
+    DO_TEST(test_manifold_corner)
+    DO_TEST(test_body_manifold)
+
+    puts("collision_test PASS");
     return 0;
 }
-*/
@@ -0,0 +1,125 @@
+#include "contact.h"
+#include "body.h"
+#include "shapes.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define NUM_BODIES 40
+
+Body **make_bodies(size_t count) {
+    Body **bodies = malloc(count * sizeof(Body *));
+    assert(bodies != NULL);
+    for (size_t i = 0; i < count; i++) {
+        bodies[i] = body_init(make_square(1), 1, (RGBColor) {0, 0, 0});
+    }
+    return bodies;
+}
+
+void free_bodies(Body **bodies, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        body_free(bodies[i]);
+    }
+    free(bodies);
+}
+
+void test_add_find() {
+    Body **bodies = make_bodies(3);
+    ContactTable *table = contact_table_init(4);
+    assert(contact_table_size(table) == 0);
+    assert(contact_table_find(table, bodies[0], bodies[1]) == NULL);
+
+    ContactPair *pair = contact_table_add(table, bodies[0], bodies[1]);
+    assert(pair->body1 == bodies[0] && pair->body2 == bodies[1]);
+    assert(vec_equal(pair->axis, VEC_ZERO));
+    assert(pair->depth == 0 && pair->normal_impulse == 0 && pair->tick == 0);
+    pair->depth = 2;
+    assert(contact_table_size(table) == 1);
+    // Either order finds the same pair
+    assert(contact_table_find(table, bodies[0], bodies[1]) == pair);
+    assert(contact_table_find(table, bodies[1], bodies[0]) == pair);
+    assert(contact_table_find(table, bodies[0], bodies[2]) == NULL);
+    assert(contact_table_get(table, 0)->depth == 2);
+
+    contact_table_free(table);
+    free_bodies(bodies, 3);
+}
+
+void test_remove() {
+    Body **bodies = make_bodies(4);
+    ContactTable *table = contact_table_init(1);
+    contact_table_add(table, bodies[0], bodies[1])->depth = 1;
+    contact_table_add(table, bodies[1], bodies[2])->depth = 2;
+    contact_table_add(table, bodies[2], bodies[3])->depth = 3;
+
+    // The last pair moves into the removed one's place and stays findable
+    contact_table_remove(table, 0);
+    assert(contact_table_size(table) == 2);
+    assert(contact_table_find(table, bodies[1], bodies[0]) == NULL);
+    assert(contact_table_get(table, 0)->depth == 3);
+    assert(contact_table_find(table, bodies[3], bodies[2]) == contact_table_get(table, 0));
+    assert(contact_table_find(table, bodies[1], bodies[2])->depth == 2);
+
+    // A removed pair can be added again
+    contact_table_add(table, bodies[1], bodies[0]);
+    assert(contact_table_size(table) == 3);
+    assert(contact_table_find(table, bodies[0], bodies[1])->depth == 0);
+
+    contact_table_remove(table, 2);
+    contact_table_remove(table, 1);
+    contact_table_remove(table, 0);
+    assert(contact_table_size(table) == 0);
+    contact_table_free(table);
+    free_bodies(bodies, 4);
+}
+
+void test_many_pairs() {
+    Body **bodies = make_bodies(NUM_BODIES);
+    ContactTable *table = contact_table_init(1);
+    // Every pair of bodies, which makes the table grow several times
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        for (size_t j = i + 1; j < NUM_BODIES; j++) {
+            contact_table_add(table, bodies[i], bodies[j])->depth = i * NUM_BODIES + j;
+        }
+    }
+    assert(contact_table_size(table) == NUM_BODIES * (NUM_BODIES - 1) / 2);
+
+    // Remove the pairs with an odd depth in table order
+    for (size_t i = 0; i < contact_table_size(table); i++) {
+        if ((size_t) contact_table_get(table, i)->depth % 2 == 1) {
+            contact_table_remove(table, i);
+            i--;
+        }
+    }
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        for (size_t j = i + 1; j < NUM_BODIES; j++) {
+            ContactPair *pair = contact_table_find(table, bodies[j], bodies[i]);
+            size_t depth = i * NUM_BODIES + j;
+            if (depth % 2 == 1) {
+                assert(pair == NULL);
+            } else {
+                assert(pair != NULL && pair->depth == depth);
+            }
+        }
+    }
+    contact_table_free(table);
+    free_bodies(bodies, NUM_BODIES);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_add_find)
+    DO_TEST(test_remove)
+    DO_TEST(test_many_pairs)
+
+    puts("contact_test PASS");
+    return 0;
+}
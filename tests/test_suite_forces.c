@@ -152,6 +152,48 @@ void test_forces_removed() {
     scene_free(scene);
 }
 
+// Tests that an exact gravity field matches gravity added to every pair
+void test_gravity_field() {
+    const double G = 1e3;
+    const int BODIES = 6;
+    const double DT = 1e-3;
+    const int STEPS = 1000;
+    Scene *pairwise = scene_init();
+    Scene *field = scene_init();
+    for (int i = 0; i < BODIES; i++) {
+        Vector position = {30 * cos(i), 30 * sin(2 * i)};
+        Body *body = body_init(make_shape(), i + 1, (RGBColor) {0, 0, 0});
+        body_set_centroid(body, position);
+        scene_add_body(pairwise, body);
+        body = body_init(make_shape(), i + 1, (RGBColor) {0, 0, 0});
+        body_set_centroid(body, position);
+        body_set_gravitating(body, true);
+        scene_add_body(field, body);
+    }
+    // Not gravitating, so it must not move
+    scene_add_body(field, body_init(make_shape(), 1, (RGBColor) {0, 0, 0}));
+    for (int i = 0; i < BODIES; i++) {
+        for (int j = i + 1; j < BODIES; j++) {
+            create_newtonian_gravity(pairwise, G,
+                scene_get_body(pairwise, i), scene_get_body(pairwise, j));
+        }
+    }
+    create_gravity_field(field, G, 0, 20);
+    for (int step = 0; step < STEPS; step++) {
+        scene_tick(pairwise, DT);
+        scene_tick(field, DT);
+    }
+    for (int i = 0; i < BODIES; i++) {
+        assert(vec_isclose(
+            body_get_centroid(scene_get_body(pairwise, i)),
+            body_get_centroid(scene_get_body(field, i))
+        ));
+    }
+    assert(vec_equal(body_get_centroid(scene_get_body(field, BODIES)), VEC_ZERO));
+    scene_free(pairwise);
+    scene_free(field);
+}
+
 int main(int argc, char *argv[]) {
     // Run all tests if there are no command-line arguments
     bool all_tests = argc == 1;
@@ -165,6 +207,7 @@ int main(int argc, char *argv[]) {
     DO_TEST(test_energy_conservation)
     DO_TEST(test_collisions)
     DO_TEST(test_forces_removed)
+    DO_TEST(test_gravity_field)
 
     puts("forces_test PASS");
     return 0;
@@ -0,0 +1,98 @@
+#include "gjk.h"
+#include "collision.h"
+#include "shapes.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+void test_polygon_support() {
+    Shape *gon = shape_ngon(100, 3);
+    ShapeView view = shape_view(gon);
+    for (size_t hint = 0; hint < view.size; hint += 7) {
+        for (double angle = 0; angle < 2 * M_PI; angle += 0.1) {
+            Vector direction = {cos(angle), sin(angle)};
+            size_t found = hint;
+            Vector support = gjk_polygon_support(&view, direction, &found);
+            assert(vec_equal(support, view.vertices[found]));
+            for (size_t i = 0; i < view.size; i++) {
+                assert(vec_dot(view.vertices[i], direction) <= vec_dot(support, direction));
+            }
+        }
+    }
+    shape_free(gon);
+}
+
+// GJK/EPA finds the same collisions, axes, and depths as SAT
+void test_matches_sat() {
+    Shape *gon1 = shape_ngon(40, 2);
+    Shape *gon2 = shape_ngon(7, 1.3);
+    shape_rotate(gon1, 0.05, VEC_ZERO);
+    GjkCache cache = {VEC_ZERO, {0, 0}};
+    srand(3);
+    for (size_t trial = 0; trial < 500; trial++) {
+        Vector offset = {6.0 * rand() / RAND_MAX - 3, 6.0 * rand() / RAND_MAX - 3};
+        double angle = 2 * M_PI * rand() / RAND_MAX;
+        Shape *moved = shape_copy(gon2);
+        shape_rotate(moved, angle, VEC_ZERO);
+        shape_translate(moved, offset);
+        CollisionInfo sat = find_collision_view(shape_view(gon1), shape_view(moved));
+        CollisionInfo gjk = find_gjk_collision(shape_view(gon1), shape_view(moved), &cache);
+        assert(sat.collided == gjk.collided);
+        if (sat.collided) {
+            assert(within(1e-6, sat.depth, gjk.depth));
+            assert(vec_within(1e-6, sat.axis, gjk.axis));
+        }
+        shape_free(moved);
+    }
+    shape_free(gon1);
+    shape_free(gon2);
+}
+
+size_t support_calls = 0;
+
+Vector counting_support(const void *polygon, Vector direction, size_t *hint) {
+    support_calls++;
+    return gjk_polygon_support(polygon, direction, hint);
+}
+
+void test_warm_start() {
+    Shape *gon1 = shape_ngon(50, 1);
+    Shape *gon2 = shape_ngon(50, 1);
+    shape_translate(gon2, (Vector) {0.3, 2.5});
+    ShapeView view1 = shape_view(gon1), view2 = shape_view(gon2);
+    ConvexShape shape1 = {counting_support, &view1}, shape2 = {counting_support, &view2};
+    GjkCache cache = {VEC_ZERO, {0, 0}};
+    assert(!gjk_intersect(shape1, shape2, &cache));
+    // The cached direction separates the shapes again after a small move
+    shape_translate(gon2, (Vector) {0.01, -0.02});
+    support_calls = 0;
+    assert(!gjk_intersect(shape1, shape2, &cache));
+    assert(support_calls == 2);
+
+    shape_translate(gon2, (Vector) {0, -1});
+    Vector axis;
+    double depth;
+    assert(gjk_penetration(shape1, shape2, &cache, &axis, &depth));
+    assert(vec_dot(axis, (Vector) {0.31, 1.48}) > 0);
+    assert(depth > 0 && depth < 1);
+    shape_free(gon1);
+    shape_free(gon2);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_polygon_support)
+    DO_TEST(test_matches_sat)
+    DO_TEST(test_warm_start)
+
+    puts("gjk_test PASS");
+    return 0;
+}
@@ -47,6 +47,18 @@ List *make_triangle() {
     return tri;
 }
 
+void test_square_edge_normals() {
+    Shape *sq = shape_square(2);
+    Vector normals[4];
+    polygon_view_edge_normals(shape_view(sq), normals);
+    assert(vec_isclose(normals[0], (Vector){0, 1}));
+    assert(vec_isclose(normals[1], (Vector){-1, 0}));
+    assert(vec_isclose(normals[2], (Vector){0, -1}));
+    // The edge from the last vertex back to the first
+    assert(vec_isclose(normals[3], (Vector){1, 0}));
+    shape_free(sq);
+}
+
 void test_triangle_area_centroid() {
     List *tri = make_triangle();
     assert(isclose(polygon_area(tri), 6));
@@ -198,6 +210,7 @@ int main(int argc, char *argv[]) {
     DO_TEST(test_square_area_centroid)
     DO_TEST(test_square_translate)
     DO_TEST(test_square_rotate)
+    DO_TEST(test_square_edge_normals)
     DO_TEST(test_triangle_area_centroid)
     DO_TEST(test_triangle_translate)
     DO_TEST(test_triangle_rotate)
@@ -0,0 +1,81 @@
+#include "pool.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+void test_pool_reuse() {
+    Pool *pool = pool_init(24, 4, false);
+    assert(pool_block_size(pool) == 24);
+    void *blocks[10];
+    for (size_t i = 0; i < 10; i++) {
+        blocks[i] = pool_alloc(pool);
+        // Blocks are aligned and do not overlap
+        assert((uintptr_t) blocks[i] % _Alignof(max_align_t) == 0);
+        memset(blocks[i], (int) i, 24);
+    }
+    assert(pool_used(pool) == 10);
+    for (size_t i = 0; i < 10; i++) {
+        unsigned char *bytes = blocks[i];
+        for (size_t j = 0; j < 24; j++) {
+            assert(bytes[j] == i);
+        }
+    }
+    pool_release(blocks[3]);
+    pool_release(NULL);
+    assert(pool_used(pool) == 9);
+    // The most recently released block is reused first
+    assert(pool_alloc(pool) == blocks[3]);
+    for (size_t i = 0; i < 10; i++) {
+        pool_release(blocks[i]);
+    }
+    assert(pool_used(pool) == 0);
+    pool_free(pool);
+}
+
+void test_pool_fixed() {
+    Pool *pool = pool_init(sizeof(double), 8, true);
+    double *values[8];
+    for (size_t i = 0; i < 8; i++) {
+        values[i] = pool_alloc(pool);
+        *values[i] = i;
+    }
+    assert(pool_used(pool) == 8);
+    // A fixed pool refills from released blocks only
+    for (size_t round = 0; round < 100; round++) {
+        size_t i = round % 8;
+        pool_release(values[i]);
+        values[i] = pool_alloc(pool);
+        *values[i] = round;
+    }
+    assert(pool_used(pool) == 8);
+    pool_free(pool);
+}
+
+void test_pool_free_func() {
+    Pool *pool = pool_init(sizeof(double), 2, false);
+    FreeFunc freer = pool_release;
+    for (size_t i = 0; i < 50; i++) {
+        freer(pool_alloc(pool));
+    }
+    assert(pool_used(pool) == 0);
+    pool_free(pool);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_pool_reuse)
+    DO_TEST(test_pool_fixed)
+    DO_TEST(test_pool_free_func)
+
+    puts("pool_test PASS");
+    return 0;
+}
@@ -1,4 +1,6 @@
 #include "scene.h"
+#include "forces.h"
+#include "shapes.h"
 #include "test_util.h"
 #include <assert.h>
 #include <math.h>
@@ -240,6 +242,799 @@ void test_reaping() {
     scene_free(scene);
 }
 
+void count_collision(Body *body1, Body *body2, Vector axis, void *aux) {
+    // The first body is always from the rule's first group
+    assert(body_get_collision_group(body1) == 1);
+    assert(body_get_collision_group(body2) == 2);
+    (*(int *) aux)++;
+}
+
+void test_group_collision() {
+    Scene *scene = scene_init();
+    int *count = malloc(sizeof(*count));
+    *count = 0;
+    scene_add_group_collision(scene, 1, 2, count_collision, count, free);
+
+    Body *mover = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    body_set_collision_group(mover, 1);
+    body_set_velocity(mover, (Vector) {1, 0});
+    scene_add_body(scene, mover);
+    // Touching the mover, but in a group with no rule for it
+    Body *ghost = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    body_set_centroid(ghost, (Vector) {0, 1});
+    scene_add_body(scene, ghost);
+    Body *near = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    body_set_collision_group(near, 2);
+    body_set_centroid(near, (Vector) {1.5, 0});
+    scene_add_body(scene, near);
+    Body *far = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    body_set_collision_group(far, 2);
+    body_set_centroid(far, (Vector) {10, 0});
+    scene_add_body(scene, far);
+
+    scene_tick(scene, 0.1);
+    assert(*count == 1);
+    scene_free(scene);
+}
+
+void count_any_collision(Body *body1, Body *body2, Vector axis, void *aux) {
+    (*(int *) aux)++;
+}
+
+typedef struct {
+    int events[3];
+    Body *body1;
+    Body *body2;
+} ContactLog;
+
+void log_contact(ContactEvent event, Body *body1, Body *body2, ContactPair *contact, void *aux) {
+    ContactLog *log = aux;
+    log->events[event]++;
+    log->body1 = body1;
+    log->body2 = body2;
+}
+
+void test_contact_events() {
+    Scene *scene = scene_init();
+    ContactLog *log = calloc(1, sizeof(ContactLog));
+    scene_add_group_contact_listener(scene, 2, 1, log_contact, log, free);
+    int *count = malloc(sizeof(*count));
+    *count = 0;
+    scene_add_group_collision(scene, 1, 2, count_any_collision, count, free);
+
+    Body *still = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    body_set_collision_group(still, 1);
+    scene_add_body(scene, still);
+    // Overlapping by 0.5 and moving away at 1 per second
+    Body *leaver = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    body_set_collision_group(leaver, 2);
+    body_set_centroid(leaver, (Vector) {1.5, 0});
+    body_set_velocity(leaver, (Vector) {1, 0});
+    scene_add_body(scene, leaver);
+
+    scene_tick(scene, 0.1);
+    assert(log->events[CONTACT_BEGIN] == 1 && log->events[CONTACT_PERSIST] == 0);
+    // The listener gets the bodies in the order of its groups
+    assert(log->body1 == leaver && log->body2 == still);
+    assert(scene_contacts(scene) == 1);
+    ContactPair *contact = scene_find_contact(scene, leaver, still);
+    assert(contact == scene_get_contact(scene, 0));
+    assert(isclose(contact->depth, 0.5));
+    Vector axis = contact->body1 == still ? (Vector) {1, 0} : (Vector) {-1, 0};
+    assert(vec_isclose(contact->axis, axis));
+    // Bodies moving apart are not passed to collision handlers
+    assert(*count == 0);
+
+    for (int t = 0; t < 3; t++) {
+        scene_tick(scene, 0.1);
+    }
+    assert(log->events[CONTACT_BEGIN] == 1 && log->events[CONTACT_PERSIST] == 3);
+    assert(log->events[CONTACT_END] == 0);
+    assert(isclose(scene_find_contact(scene, still, leaver)->depth, 0.2));
+
+    for (int t = 0; t < 3; t++) {
+        scene_tick(scene, 0.1);
+    }
+    assert(log->events[CONTACT_END] == 1);
+    assert(scene_contacts(scene) == 0);
+    assert(scene_find_contact(scene, still, leaver) == NULL);
+
+    // Removing a touching body ends its contact
+    body_set_centroid(leaver, (Vector) {1.5, 0});
+    scene_tick(scene, 0.1);
+    assert(log->events[CONTACT_BEGIN] == 2);
+    body_remove(leaver);
+    scene_tick(scene, 0.1);
+    assert(log->events[CONTACT_END] == 2);
+    assert(scene_contacts(scene) == 0);
+    scene_free(scene);
+}
+
+void ignore_contact(ContactEvent event, Body *body1, Body *body2, ContactPair *contact, void *aux) {
+}
+
+void test_sleeping_islands() {
+    const double DT = 0.1;
+    Scene *scene = scene_init();
+    scene_set_sleep(scene, 0.01, 0.01, 0.5);
+    scene_add_group_contact_listener(scene, 1, 1, ignore_contact, NULL, NULL);
+    // Two touching squares at rest, and a third joined to them by a weak spring
+    Body *stack[3];
+    for (size_t i = 0; i < 3; i++) {
+        stack[i] = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+        body_set_collision_group(stack[i], 1);
+        body_set_centroid(stack[i], (Vector) {i * 1.9, 0});
+        scene_add_body(scene, stack[i]);
+    }
+    body_set_centroid(stack[2], (Vector) {0, 10});
+    body_set_velocity(stack[2], (Vector) {0.1, 0});
+    create_spring(scene, 1e-4, stack[1], stack[2]);
+    Body *mover = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    body_set_collision_group(mover, 1);
+    body_set_centroid(mover, (Vector) {-20, 0});
+    body_set_velocity(mover, (Vector) {0, 1});
+    scene_add_body(scene, mover);
+
+    // The moving body keeps its whole island awake
+    for (int t = 0; t < 10; t++) {
+        scene_tick(scene, DT);
+    }
+    assert(scene_awake_bodies(scene) == 4);
+    body_set_velocity(stack[2], VEC_ZERO);
+    for (int t = 0; t < 4; t++) {
+        scene_tick(scene, DT);
+    }
+    assert(scene_awake_bodies(scene) == 4);
+    scene_tick(scene, DT);
+    assert(scene_awake_bodies(scene) == 1);
+    assert(body_is_asleep(stack[0]) && body_is_asleep(stack[2]) && !body_is_asleep(mover));
+
+    // Sleeping bodies stay put and keep their contact
+    Vector centroid = body_get_centroid(stack[2]);
+    for (int t = 0; t < 5; t++) {
+        scene_tick(scene, DT);
+    }
+    assert(vec_equal(body_get_centroid(stack[2]), centroid));
+    assert(scene_find_contact(scene, stack[0], stack[1]) != NULL);
+
+    // An impulse wakes the whole island
+    body_add_impulse(stack[0], (Vector) {-1, 0});
+    scene_tick(scene, DT);
+    assert(scene_awake_bodies(scene) == 4);
+    assert(isclose(body_get_centroid(stack[0]).x, -0.05));
+    body_set_velocity(stack[0], VEC_ZERO);
+    for (int t = 0; t < 6; t++) {
+        scene_tick(scene, DT);
+    }
+    assert(scene_awake_bodies(scene) == 1);
+
+    // An awake body running into a sleeping one wakes it
+    body_set_centroid(mover, (Vector) {-2, 0});
+    body_set_velocity(mover, (Vector) {1, 0});
+    scene_tick(scene, DT);
+    assert(!body_is_asleep(stack[0]));
+
+    // Disabling sleep wakes everything
+    scene_set_sleep(scene, 0, 0, INFINITY);
+    assert(scene_awake_bodies(scene) == 4);
+    scene_free(scene);
+}
+
+void test_static_bodies() {
+    Scene *scene = scene_init();
+    ContactLog *log = calloc(1, sizeof(ContactLog));
+    scene_add_group_contact_listener(scene, 1, 2, log_contact, log, free);
+    int *count = malloc(sizeof(*count));
+    *count = 0;
+    scene_add_group_collision(scene, 2, 2, count_any_collision, count, free);
+
+    // Two overlapping walls, which are never tested against each other
+    Body *walls[2];
+    for (size_t i = 0; i < 2; i++) {
+        walls[i] = body_init(make_shape(), INFINITY, (RGBColor) {0, 0, 0});
+        body_set_collision_group(walls[i], 2);
+        body_set_centroid(walls[i], (Vector) {i, 0});
+        scene_add_static_body(scene, walls[i]);
+        assert(body_is_static(walls[i]));
+    }
+    Body *ball = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    body_set_collision_group(ball, 1);
+    body_set_centroid(ball, (Vector) {-2.5, 0});
+    body_set_velocity(ball, (Vector) {1, 0});
+    scene_add_body(scene, ball);
+    assert(!body_is_static(ball) && scene_bodies(scene) == 3);
+
+    // Static bodies ignore forces and impulses
+    body_add_force(walls[0], (Vector) {5, 0});
+    body_add_impulse(walls[0], (Vector) {5, 5});
+    body_set_velocity(walls[1], (Vector) {1, 0});
+    scene_tick(scene, 1);
+    assert(vec_equal(body_get_centroid(walls[0]), (Vector) {0, 0}));
+    assert(vec_equal(body_get_velocity(walls[1]), VEC_ZERO));
+    assert(*count == 0);
+    assert(log->events[CONTACT_BEGIN] == 0);
+
+    // A moving body touches the static ones
+    scene_tick(scene, 0.1);
+    assert(log->events[CONTACT_BEGIN] == 1 && log->body1 == ball && log->body2 == walls[0]);
+    assert(*count == 0);
+
+    // Moving a wall moves its box
+    body_set_centroid(walls[0], (Vector) {10, 0});
+    scene_tick(scene, 0.1);
+    assert(log->events[CONTACT_END] == 1);
+    body_set_centroid(walls[0], (Vector) {-1, 0});
+    scene_tick(scene, 0.1);
+    assert(log->events[CONTACT_BEGIN] == 2);
+
+    // Removing a wall leaves the other in the broadphase
+    body_set_velocity(ball, VEC_ZERO);
+    body_set_centroid(ball, (Vector) {2.5, 0});
+    body_remove(walls[0]);
+    scene_tick(scene, 0.1);
+    assert(scene_bodies(scene) == 2);
+    assert(scene_contacts(scene) == 1 && scene_find_contact(scene, ball, walls[1]) != NULL);
+    scene_free(scene);
+}
+
+// Bullets stop at thin walls that other fast bodies pass through in one tick
+void test_bullets() {
+    Scene *scene = scene_init();
+    create_group_physics_collision(scene, 1, 1, 2);
+    Body *wall = body_init(make_rectangle(20, 0.2), INFINITY, (RGBColor) {0, 0, 0});
+    body_set_collision_group(wall, 2);
+    scene_add_static_body(scene, wall);
+
+    Body *ghost = body_init_circle(0.5, 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    Body *ball = body_init_circle(0.5, 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    Body *box = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    Body *movers[] = {ghost, ball, box};
+    for (size_t i = 0; i < 3; i++) {
+        body_set_collision_group(movers[i], 1);
+        body_set_centroid(movers[i], (Vector) {-3, 6.0 - 6.0 * i});
+        body_set_velocity(movers[i], (Vector) {100, 0});
+        scene_add_body(scene, movers[i]);
+    }
+    body_set_bullet(ball, true);
+    body_set_bullet(box, true);
+    assert(body_is_bullet(ball) && !body_is_bullet(ghost));
+
+    scene_tick(scene, 0.1);
+    assert(vec_isclose(body_get_centroid(ghost), (Vector) {7, 6}));
+    assert(vec_isclose(body_get_velocity(ghost), (Vector) {100, 0}));
+    // The ball touches the wall at x = -0.6, 0.24 of the way through the tick,
+    // and spends the rest of it moving back
+    assert(vec_isclose(body_get_centroid(ball), (Vector) {-0.6 - 7.6, 0}));
+    assert(vec_isclose(body_get_velocity(ball), (Vector) {-100, 0}));
+    // The box is swept by conservative advancement, which stops just short
+    assert(within(1e-2, body_get_centroid(box).x, -1.1 - 8.1));
+    assert(vec_isclose(body_get_velocity(box), (Vector) {-100, 0}));
+    assert(scene_find_contact(scene, ball, wall) != NULL);
+    assert(scene_find_contact(scene, ghost, wall) == NULL);
+
+    // Their contacts end once the discrete test sees them apart
+    scene_tick(scene, 0.1);
+    assert(scene_contacts(scene) == 0);
+    scene_free(scene);
+}
+
+// A bullet that grazes a body on its way still stops at the ground behind it
+void run_bullet_graze(BroadphaseType type) {
+    Scene *scene = scene_init();
+    scene_set_broadphase(scene, type);
+    create_group_physics_collision(scene, 1, 1, 1);
+    create_group_physics_collision(scene, 0, 1, 2);
+    int *count = malloc(sizeof(*count));
+    *count = 0;
+    scene_add_group_collision(scene, 1, 2, count_collision, count, free);
+    Body *ground = body_init(make_rectangle(2, 100), INFINITY, (RGBColor) {0, 0, 0});
+    body_set_collision_group(ground, 2);
+    body_set_centroid(ground, (Vector) {50, 0});
+    scene_add_static_body(scene, ground);
+
+    Body *bullet = body_init_circle(1, 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    body_set_centroid(bullet, (Vector) {50, 20});
+    body_set_velocity(bullet, (Vector) {0, -2900});
+    body_set_bullet(bullet, true);
+    Body *ball = body_init_circle(1, 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    body_set_centroid(ball, (Vector) {51.98, 16});
+    // The debris is removed during the tick, after the pairs are found,
+    // which moves the ball to the bystander's index
+    Body *debris = body_init_circle(1, 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    body_set_centroid(debris, (Vector) {-50, 50});
+    Body *bystander = body_init_circle(1, 1, (RGBColor) {0, 0, 0}, NULL, NULL);
+    body_set_centroid(bystander, (Vector) {150, 50});
+    Body *bodies[] = {bullet, debris, ball, bystander};
+    for (size_t i = 0; i < 4; i++) {
+        body_set_collision_group(bodies[i], 1);
+        scene_add_body(scene, bodies[i]);
+    }
+    body_remove(debris);
+
+    scene_tick(scene, 0.01);
+    assert(scene_find_contact(scene, bullet, ball) != NULL);
+    assert(*count == 1);
+    assert(scene_find_contact(scene, bullet, ground) != NULL);
+    // The ground's top is at y = 1, and the bullet no longer moves down
+    assert(body_get_centroid(bullet).y > 2 - 1e-3);
+    assert(body_get_velocity(bullet).y > -1e-6);
+    scene_free(scene);
+}
+
+void test_bullet_graze() {
+    run_bullet_graze(BROADPHASE_GRID);
+    run_bullet_graze(BROADPHASE_SWEEP);
+    run_bullet_graze(BROADPHASE_TREE);
+}
+
+void pull_down(void *body) {
+    body_add_force(body, (Vector) {0, -10 * body_get_mass(body)});
+}
+
+// A stack resting on the ground neither sinks nor jitters apart
+void test_contact_solver() {
+    Scene *scene = scene_init();
+    scene_add_group_solver(scene, 1, 1, 0);
+    Body *ground = body_init(make_rectangle(2, 40), INFINITY, (RGBColor) {0, 0, 0});
+    body_set_collision_group(ground, 1);
+    body_set_centroid(ground, (Vector) {0, -1});
+    scene_add_static_body(scene, ground);
+    Body *boxes[4];
+    for (size_t i = 0; i < 4; i++) {
+        boxes[i] = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+        body_set_collision_group(boxes[i], 1);
+        body_set_centroid(boxes[i], (Vector) {0, 1 + 2 * i});
+        scene_add_body(scene, boxes[i]);
+        scene_add_force_creator(scene, pull_down, boxes[i], NULL);
+    }
+    for (size_t t = 0; t < 300; t++) {
+        scene_tick(scene, 0.01);
+    }
+    for (size_t i = 0; i < 4; i++) {
+        assert(within(0.05, body_get_centroid(boxes[i]).y, 1 + 2 * i));
+        assert(vec_len(body_get_velocity(boxes[i])) < 0.1);
+    }
+    // The solver keeps each contact's impulse, which holds up the boxes above it
+    ContactPair *bottom = scene_find_contact(scene, ground, boxes[0]);
+    assert(bottom != NULL && within(0.05, bottom->normal_impulse, 4 * 10 * 0.01));
+    // at both of the box's bottom corners
+    assert(bottom->num_points == 2);
+    assert(isclose(bottom->points[0].impulse + bottom->points[1].impulse, bottom->normal_impulse));
+    scene_free(scene);
+}
+
+// The ground's reaction to the boxes' weight balances it, so the stack sleeps
+void test_solved_stack_sleeps() {
+    Scene *scene = scene_init();
+    scene_set_sleep(scene, 0.05, 1, 0.5);
+    scene_add_group_solver(scene, 1, 1, 0);
+    Body *ground = body_init(make_rectangle(2, 40), INFINITY, (RGBColor) {0, 0, 0});
+    body_set_collision_group(ground, 1);
+    body_set_centroid(ground, (Vector) {0, -1});
+    scene_add_static_body(scene, ground);
+    Body *boxes[3];
+    for (size_t i = 0; i < 3; i++) {
+        boxes[i] = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+        body_set_collision_group(boxes[i], 1);
+        body_set_centroid(boxes[i], (Vector) {0, 1 + 2 * i});
+        scene_add_body(scene, boxes[i]);
+        scene_add_force_creator(scene, pull_down, boxes[i], NULL);
+    }
+    for (size_t t = 0; t < 200; t++) {
+        scene_tick(scene, 0.01);
+    }
+    assert(scene_awake_bodies(scene) == 0);
+    for (size_t i = 0; i < 3; i++) {
+        assert(within(0.05, body_get_centroid(boxes[i]).y, 1 + 2 * i));
+    }
+    scene_free(scene);
+}
+
+void test_fixed_step() {
+    Scene *scene = scene_init();
+    assert(scene_step_alpha(scene) == 1);
+    scene_set_fixed_step(scene, 0.1, 3);
+    Body *body = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    body_set_velocity(body, (Vector) {1, 0});
+    scene_add_body(scene, body);
+
+    // Time short of a tick is kept for later
+    assert(scene_step_fixed(scene, 0.05) == 0);
+    assert(vec_equal(body_get_centroid(body), VEC_ZERO));
+    assert(isclose(scene_step_alpha(scene), 0.5));
+    assert(scene_step_fixed(scene, 0.2) == 2);
+    assert(vec_isclose(body_get_centroid(body), (Vector) {0.2, 0}));
+    assert(isclose(scene_step_alpha(scene), 0.5));
+    // Bodies are drawn between their last two ticks
+    assert(vec_isclose(body_get_interpolated_centroid(body, 0), (Vector) {0.1, 0}));
+    assert(vec_isclose(body_get_interpolated_centroid(body, scene_step_alpha(scene)),
+                       (Vector) {0.15, 0}));
+
+    // A long frame runs at most max_steps ticks and drops the rest
+    assert(scene_step_fixed(scene, 1.02) == 3);
+    assert(vec_isclose(body_get_centroid(body), (Vector) {0.5, 0}));
+    assert(isclose(scene_step_alpha(scene), 0.7));
+
+    // Moving a body does not draw it sweeping across
+    body_set_centroid(body, (Vector) {5, 5});
+    assert(vec_equal(body_get_interpolated_centroid(body, 0), (Vector) {5, 5}));
+    scene_free(scene);
+}
+
+/* Runs a unit mass on a unit spring from x = 1 for some ticks,
+   returning its energy and setting its position */
+double run_oscillator(IntegratorType type, size_t substeps, double dt, int ticks, Vector *position) {
+    Scene *scene = scene_init();
+    scene_set_integrator(scene, type, substeps);
+    Body *anchor = body_init(make_shape(), INFINITY, (RGBColor) {0, 0, 0});
+    scene_add_static_body(scene, anchor);
+    Body *mass = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    body_set_centroid(mass, (Vector) {1, 0});
+    scene_add_body(scene, mass);
+    create_spring(scene, 1, mass, anchor);
+    for (int t = 0; t < ticks; t++) {
+        scene_tick(scene, dt);
+    }
+    *position = body_get_centroid(mass);
+    Vector v = body_get_velocity(mass);
+    double energy = (vec_dot(*position, *position) + vec_dot(v, v)) / 2;
+    scene_free(scene);
+    return energy;
+}
+
+void test_integrators() {
+    // 1000 ticks of dt = 0.1 is 16 periods; the energy should stay 0.5
+    const double DT = 0.1, EXACT = cos(100);
+    Vector x;
+    // The default scheme gains energy at this step, less so with substeps
+    double gained = run_oscillator(INTEGRATOR_TRAPEZOID, 1, DT, 1000, &x);
+    double substepped = run_oscillator(INTEGRATOR_TRAPEZOID, 4, DT, 1000, &x);
+    assert(gained > 1 && substepped < gained);
+    // The symplectic integrators keep the energy bounded
+    assert(within(0.05, run_oscillator(INTEGRATOR_SEMI_IMPLICIT_EULER, 1, DT, 1000, &x), 0.5));
+    assert(within(1e-3, run_oscillator(INTEGRATOR_VERLET, 1, DT, 1000, &x), 0.5));
+    double error = fabs(x.x - EXACT);
+    run_oscillator(INTEGRATOR_VERLET, 4, DT, 1000, &x);
+    assert(fabs(x.x - EXACT) < error / 10);
+    // RK4 follows the exact solution closely
+    run_oscillator(INTEGRATOR_RK4, 1, DT, 1000, &x);
+    assert(within(1e-3, x.x, EXACT));
+}
+
+void count_handler_calls(Body *body1, Body *body2, Vector axis, void *aux) {
+    (*(int *) aux)++;
+}
+
+// Forces are evaluated again for each substep, but collisions are not
+void test_substep_collisions() {
+    Scene *scene = scene_init();
+    scene_set_integrator(scene, INTEGRATOR_RK4, 2);
+    Body *body1 = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    Body *body2 = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+    body_set_centroid(body2, (Vector) {1, 0});
+    body_set_velocity(body2, (Vector) {-1, 0});
+    scene_add_body(scene, body1);
+    scene_add_body(scene, body2);
+    int *count = malloc(sizeof(*count));
+    *count = 0;
+    create_collision(scene, body1, body2, count_handler_calls, count, free);
+    create_spring(scene, 1, body1, body2);
+    for (int t = 1; t <= 3; t++) {
+        scene_tick(scene, 0.01);
+        assert(*count == t);
+    }
+    scene_free(scene);
+}
+
+// Evaluating the forces again reuses the same scratch space each time
+void test_fixed_scene_substeps() {
+    const size_t NUM_BODIES = 12;
+    // room for two evaluations of the gravity field's gathered arrays, not 16
+    Scene *scene = scene_init_fixed(NUM_BODIES, 10, 1024);
+    scene_set_integrator(scene, INTEGRATOR_RK4, 4);
+    create_gravity_field(scene, 10, 0.5, 1);
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        Body *body = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+        body_set_centroid(body, (Vector) {3 * i, i % 2});
+        body_set_gravitating(body, true);
+        scene_add_body(scene, body);
+    }
+    for (int t = 0; t < 10; t++) {
+        scene_tick(scene, 0.1);
+    }
+    assert(body_get_centroid(scene_get_body(scene, 0)).x > 0);
+    scene_free(scene);
+}
+
+/* Counts the collisions in each tick of a scene of bouncing squares */
+void run_broadphase(BroadphaseType type, int *counts, int ticks) {
+    srand(3);
+    Scene *scene = scene_init();
+    scene_set_broadphase(scene, type);
+    int *count = malloc(sizeof(*count));
+    scene_add_group_collision(scene, 1, 1, count_any_collision, count, free);
+    for (int i = 0; i < 100; i++) {
+        Body *body = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+        body_set_centroid(body, (Vector) {rand() % 40, rand() % 40});
+        body_set_velocity(body, (Vector) {rand() % 5 - 2, rand() % 5 - 2});
+        body_set_collision_group(body, i % 10 == 0 ? 0 : 1);
+        scene_add_body(scene, body);
+    }
+    for (int t = 0; t < ticks; t++) {
+        *count = 0;
+        if (t == ticks / 2) {
+            // Removed bodies must leave the broadphase
+            for (size_t i = 0; i < scene_bodies(scene); i += 7) {
+                body_remove(scene_get_body(scene, i));
+            }
+        }
+        scene_tick(scene, 0.1);
+        counts[t] = *count;
+    }
+    scene_free(scene);
+}
+
+void test_broadphases_agree() {
+    const int TICKS = 30;
+    int grid_counts[TICKS], sweep_counts[TICKS], tree_counts[TICKS];
+    run_broadphase(BROADPHASE_GRID, grid_counts, TICKS);
+    run_broadphase(BROADPHASE_SWEEP, sweep_counts, TICKS);
+    run_broadphase(BROADPHASE_TREE, tree_counts, TICKS);
+    int total = 0;
+    for (int t = 0; t < TICKS; t++) {
+        assert(grid_counts[t] == sweep_counts[t]);
+        assert(grid_counts[t] == tree_counts[t]);
+        total += grid_counts[t];
+    }
+    assert(total > 0);
+}
+
+void test_force_removal_index() {
+    const size_t NUM_BODIES = 30;
+    Scene *scene = scene_init();
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        Body *body = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+        body_set_centroid(body, (Vector) {10 * i, 0});
+        scene_add_body(scene, body);
+    }
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        create_drag(scene, 0.1, scene_get_body(scene, i));
+        for (size_t j = i + 1; j < NUM_BODIES; j++) {
+            create_newtonian_gravity(scene, 1, scene_get_body(scene, i), scene_get_body(scene, j));
+        }
+    }
+    size_t remaining = NUM_BODIES;
+    assert(scene_forces(scene) == remaining + remaining * (remaining - 1) / 2);
+    for (int round = 0; round < 4; round++) {
+        // Remove several bodies at once, then one with the deprecated function
+        for (size_t i = round; i < scene_bodies(scene); i += 5) {
+            body_remove(scene_get_body(scene, i));
+        }
+        scene_tick(scene, 0.01);
+        scene_remove_body(scene, 0);
+        remaining = scene_bodies(scene);
+        assert(scene_forces(scene) == remaining + remaining * (remaining - 1) / 2);
+        for (size_t i = 0; i < remaining; i++) {
+            assert(body_force_handles(scene_get_body(scene, i)) == remaining);
+        }
+        scene_tick(scene, 0.01);
+    }
+    scene_free(scene);
+}
+
+void push_by_params(void *aux) {
+    ForceParams *params = aux;
+    body_add_force(params->bodies[0], (Vector) {params->constants[0], params->constants[1]});
+}
+
+void test_force_params() {
+    Scene *scene = scene_init();
+    Body *body = body_init(make_shape(), 2, (RGBColor) {0, 0, 0});
+    scene_add_body(scene, body);
+    // The parameters are copied into the scene, so they can be temporary
+    ForceParams params = {{body, NULL}, {4, -2}};
+    scene_add_force_params(scene, push_by_params, params);
+    params.constants[0] = 100;
+    assert(sizeof(ForceParams) <= 64);
+    scene_tick(scene, 1);
+    assert(vec_isclose(body_get_velocity(scene_get_body(scene, 0)), (Vector) {2, -1}));
+    body_remove(body);
+    scene_tick(scene, 1);
+    assert(scene_forces(scene) == 0);
+    scene_free(scene);
+}
+
+typedef struct {
+    size_t calls;
+    size_t forces;
+} KernelCounts;
+
+KernelCounts push_counts, pull_counts;
+
+void push_kernel(const ForceParams *params, void *const *auxes, size_t count) {
+    push_counts.calls++;
+    push_counts.forces += count;
+    for (size_t i = 0; i < count; i++) {
+        assert(auxes[i] == NULL);
+        body_add_force(params[i].bodies[0], (Vector) {params[i].constants[0], 0});
+    }
+}
+
+void pull_kernel(const ForceParams *params, void *const *auxes, size_t count) {
+    pull_counts.calls++;
+    pull_counts.forces += count;
+    for (size_t i = 0; i < count; i++) {
+        assert(*(double *) auxes[i] == 2);
+        body_add_force(params[i].bodies[1], (Vector) {-params[i].constants[0], 0});
+    }
+}
+
+void test_batched_forces() {
+    const size_t NUM_BODIES = 10;
+    Scene *scene = scene_init();
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        scene_add_body(scene, body_init(make_shape(), 1, (RGBColor) {0, 0, 0}));
+    }
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        Body *body = scene_get_body(scene, i);
+        Body *next = scene_get_body(scene, (i + 1) % NUM_BODIES);
+        scene_add_batched_force(scene, push_kernel, (ForceParams) {{body, NULL}, {1}}, NULL, NULL);
+        double *aux = scene_alloc_aux(scene, sizeof(double));
+        *aux = 2;
+        scene_add_batched_force(scene, pull_kernel, (ForceParams) {{body, next}, {1}},
+                                aux, pool_release);
+        create_drag(scene, 0.5, body);
+    }
+    assert(scene_forces(scene) == 3 * NUM_BODIES);
+    push_counts = (KernelCounts) {0, 0};
+    pull_counts = (KernelCounts) {0, 0};
+    scene_tick(scene, 1);
+    // Each kind of force is applied in one call
+    assert(push_counts.calls == 1 && push_counts.forces == NUM_BODIES);
+    assert(pull_counts.calls == 1 && pull_counts.forces == NUM_BODIES);
+    // Each body is pushed and pulled equally
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        assert(vec_isclose(body_get_velocity(scene_get_body(scene, i)), VEC_ZERO));
+    }
+
+    // Removing a body removes its forces from every group
+    body_remove(scene_get_body(scene, 3));
+    scene_tick(scene, 1);
+    assert(scene_forces(scene) == 3 * NUM_BODIES - 4);
+    push_counts = (KernelCounts) {0, 0};
+    pull_counts = (KernelCounts) {0, 0};
+    scene_tick(scene, 1);
+    assert(push_counts.forces == NUM_BODIES - 1);
+    assert(pull_counts.forces == NUM_BODIES - 2);
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+        size_t handles = body_force_handles(scene_get_body(scene, i));
+        assert(handles == 3 || handles == 4);
+    }
+    scene_free(scene);
+}
+
+// Pushes the first body towards the second at its constant speed
+void approach_kernel(const ForceParams *params, const BodySlot *slots, size_t count,
+                     const ForceStore *stores) {
+    for (size_t i = 0; i < count; i++) {
+        const ForceStore *from = &stores[slots[2 * i].store];
+        const ForceStore *to = &stores[slots[2 * i + 1].store];
+        size_t a = slots[2 * i].slot, b = slots[2 * i + 1].slot;
+        Vector direction = vec_unit(vec_subtract(to->position[b], from->position[a]));
+        from->force[a] = vec_add(from->force[a],
+                                 vec_multiply(params[i].constants[0] / from->inv_mass[a], direction));
+    }
+}
+
+void test_slot_forces() {
+    for (size_t threads = 1; threads <= 3; threads += 2) {
+        Scene *scene = scene_init();
+        scene_set_threads(scene, threads);
+        Body *target = body_init(make_shape(), INFINITY, (RGBColor) {0, 0, 0});
+        body_set_centroid(target, (Vector) {0, 10});
+        scene_add_static_body(scene, target);
+        Body *bodies[4];
+        for (size_t i = 0; i < 4; i++) {
+            bodies[i] = body_init(make_shape(), 1 + i, (RGBColor) {0, 0, 0});
+            body_set_centroid(bodies[i], (Vector) {10 * i, 0});
+            scene_add_body(scene, bodies[i]);
+            scene_add_slot_force(scene, approach_kernel, (ForceParams) {{bodies[i], target}, {2}});
+        }
+        // Pushed towards the static body, which does not move
+        scene_add_slot_force(scene, approach_kernel, (ForceParams) {{target, bodies[0]}, {2}});
+        scene_tick(scene, 1);
+        for (size_t i = 0; i < 4; i++) {
+            Vector direction = vec_unit((Vector) {-10.0 * i, 10});
+            assert(vec_isclose(body_get_velocity(bodies[i]), vec_multiply(2, direction)));
+        }
+        assert(vec_equal(body_get_centroid(target), (Vector) {0, 10}));
+        // Removing a body removes its slot forces
+        body_remove(bodies[0]);
+        scene_tick(scene, 1);
+        assert(scene_forces(scene) == 3);
+        scene_free(scene);
+    }
+}
+
+void test_fixed_scene() {
+    const size_t NUM_BODIES = 12;
+    Scene *scene = scene_init_fixed(NUM_BODIES, 100, 1024);
+    create_gravity_field(scene, 10, 0.5, 1);
+    for (int round = 0; round < 5; round++) {
+        // Refill the scene, then let the bodies collide and remove some
+        while (scene_bodies(scene) < NUM_BODIES) {
+            size_t i = scene_bodies(scene);
+            Body *body = body_init(make_shape(), 1, (RGBColor) {0, 0, 0});
+            body_set_centroid(body, (Vector) {3 * i, i % 2});
+            body_set_velocity(body, (Vector) {i % 2 ? 1 : -1, 0});
+            body_set_gravitating(body, true);
+            scene_add_body(scene, body);
+        }
+        for (size_t i = 0; i < NUM_BODIES; i++) {
+            for (size_t j = i + 1; j < NUM_BODIES; j++) {
+                if (body_force_handles(scene_get_body(scene, j)) < 7) {
+                    create_physics_collision(scene, 1, scene_get_body(scene, i),
+                                             scene_get_body(scene, j));
+                }
+            }
+        }
+        for (int t = 0; t < 10; t++) {
+            scene_tick(scene, 0.1);
+        }
+        for (size_t i = 0; i < scene_bodies(scene); i += 2) {
+            body_remove(scene_get_body(scene, i));
+        }
+        scene_tick(scene, 0.1);
+        assert(scene_bodies(scene) == NUM_BODIES / 2);
+    }
+    scene_free(scene);
+}
+
+void run_threads(size_t num_threads, Vector *positions, size_t num_bodies, int ticks) {
+    srand(5);
+    Scene *scene = scene_init();
+    scene_set_threads(scene, num_threads);
+    assert(scene_get_threads(scene) == num_threads);
+    for (size_t i = 0; i < num_bodies; i++) {
+        Body *body = body_init(make_shape(), 1 + rand() % 3, (RGBColor) {0, 0, 0});
+        body_set_centroid(body, (Vector) {rand() % 30, rand() % 30});
+        body_set_velocity(body, (Vector) {rand() % 5 - 2, rand() % 5 - 2});
+        scene_add_body(scene, body);
+    }
+    for (size_t i = 0; i < num_bodies; i++) {
+        Body *body = scene_get_body(scene, i);
+        create_drag(scene, 0.1, body);
+        for (size_t j = i + 1; j < num_bodies; j++) {
+            Body *other = scene_get_body(scene, j);
+            create_newtonian_gravity(scene, 5, body, other);
+            create_physics_collision(scene, 0.5, body, other);
+        }
+    }
+    for (int t = 0; t < ticks; t++) {
+        scene_tick(scene, 0.05);
+    }
+    for (size_t i = 0; i < num_bodies; i++) {
+        positions[i] = body_get_centroid(scene_get_body(scene, i));
+    }
+    scene_free(scene);
+}
+
+void test_threads_deterministic() {
+    const size_t NUM_BODIES = 20;
+    const int TICKS = 20;
+    Vector serial[NUM_BODIES], parallel1[NUM_BODIES], parallel2[NUM_BODIES];
+    run_threads(1, serial, NUM_BODIES, TICKS);
+    run_threads(4, parallel1, NUM_BODIES, TICKS);
+    run_threads(4, parallel2, NUM_BODIES, TICKS);
+    for (size_t i = 0; i < NUM_BODIES; i++) {
+        // Bitwise identical for the same number of threads
+        assert(vec_equal(parallel1[i], parallel2[i]));
+        // Only the order of the sums differs from the serial tick
+        assert(fabs(parallel1[i].x - serial[i].x) < 1e-6);
+        assert(fabs(parallel1[i].y - serial[i].y) < 1e-6);
+    }
+}
+
 int main(int argc, char *argv[]) {
     // Run all tests if there are no command-line arguments
     bool all_tests = argc == 1;
@@ -254,6 +1049,25 @@ int main(int argc, char *argv[]) {
     DO_TEST(test_force_creator)
     DO_TEST(test_force_creator_aux)
     DO_TEST(test_reaping)
+    DO_TEST(test_group_collision)
+    DO_TEST(test_contact_events)
+    DO_TEST(test_sleeping_islands)
+    DO_TEST(test_static_bodies)
+    DO_TEST(test_bullets)
+    DO_TEST(test_bullet_graze)
+    DO_TEST(test_contact_solver)
+    DO_TEST(test_solved_stack_sleeps)
+    DO_TEST(test_fixed_step)
+    DO_TEST(test_integrators)
+    DO_TEST(test_substep_collisions)
+    DO_TEST(test_broadphases_agree)
+    DO_TEST(test_force_removal_index)
+    DO_TEST(test_threads_deterministic)
+    DO_TEST(test_fixed_scene)
+    DO_TEST(test_fixed_scene_substeps)
+    DO_TEST(test_force_params)
+    DO_TEST(test_batched_forces)
+    DO_TEST(test_slot_forces)
 
     puts("scene_test PASS");
     return 0;
@@ -0,0 +1,65 @@
+#include "shape.h"
+#include "shapes.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+void test_shape_grow() {
+    Shape *shape = shape_init(1);
+    for (int i = 0; i < 10; i++) {
+        shape_add(shape, (Vector) {i, -i});
+    }
+    assert(shape_size(shape) == 10);
+    assert(shape_capacity(shape) >= 10);
+    Vector *vertices = shape_vertices(shape);
+    for (int i = 0; i < 10; i++) {
+        assert(vec_equal(vertices[i], (Vector) {i, -i}));
+    }
+    shape_set(shape, 3, VEC_ZERO);
+    assert(vec_equal(shape_get(shape, 3), VEC_ZERO));
+    shape_free(shape);
+}
+
+void test_shape_list_round_trip() {
+    List *list = make_ngon(7, 3);
+    Shape *shape = shape_from_list(list);
+    List *copy = shape_to_list(shape);
+    assert(list_size(copy) == list_size(list));
+    for (size_t i = 0; i < list_size(list); i++) {
+        assert(vec_equal(*(Vector *) list_get(copy, i), *(Vector *) list_get(list, i)));
+    }
+    assert(isclose(shape_area(shape), polygon_area(list)));
+    assert(vec_isclose(shape_centroid(shape), polygon_centroid(list)));
+    list_free(list);
+    list_free(copy);
+    shape_free(shape);
+}
+
+void test_shape_transform() {
+    Shape *shape = shape_square(2);
+    shape_translate(shape, (Vector) {3, 4});
+    assert(vec_isclose(shape_centroid(shape), (Vector) {3, 4}));
+    shape_rotate(shape, M_PI / 2, (Vector) {3, 4});
+    assert(vec_isclose(shape_get(shape, 0), (Vector) {2, 5}));
+    assert(vec_isclose(shape_centroid(shape), (Vector) {3, 4}));
+    assert(isclose(shape_area(shape), 4));
+    shape_free(shape);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_shape_grow)
+    DO_TEST(test_shape_list_round_trip)
+    DO_TEST(test_shape_transform)
+
+    puts("shape_test PASS");
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "solver.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define STACK_HEIGHT 5
+
+void test_head_on() {
+    // Elastic bodies swap velocities, inelastic ones stop
+    for (size_t elastic = 0; elastic < 2; elastic++) {
+        SolverBody bodies[2] = {
+            {{1, 0}, {1, 0}, 1},
+            {{-1, 0}, {-1, 0}, 1}
+        };
+        SolverContact contact = {0, 1, {1, 0}, 0, elastic, 0};
+        solver_solve(bodies, &contact, 1, 0.1, 1);
+        assert(vec_isclose(bodies[0].velocity, (Vector) {-1.0 * elastic, 0}));
+        assert(vec_isclose(bodies[1].velocity, (Vector) {1.0 * elastic, 0}));
+        assert(isclose(contact.impulse, 1 + elastic));
+    }
+}
+
+// Contacts push bodies apart but never pull them together
+void test_separating() {
+    SolverBody bodies[2] = {
+        {{-1, 0}, {-1, 0}, 1},
+        {{1, 0}, {1, 0}, 1}
+    };
+    SolverContact contact = {0, 1, {1, 0}, 0, 1, 0};
+    solver_solve(bodies, &contact, 1, 0.1, 4);
+    assert(contact.impulse == 0);
+    assert(vec_equal(bodies[0].velocity, (Vector) {-1, 0}));
+
+    // A warm-start impulse that is too large is taken back
+    contact.impulse = 10;
+    solver_solve(bodies, &contact, 1, 0.1, 1);
+    assert(contact.impulse == 0);
+    assert(vec_isclose(bodies[1].velocity, (Vector) {1, 0}));
+}
+
+// Stacks unit masses that this tick's gravity would move down
+// at unit speed on the ground, body 0
+void init_stack(SolverBody *bodies, SolverContact *contacts) {
+    bodies[0] = (SolverBody) {VEC_ZERO, VEC_ZERO, 0};
+    for (size_t i = 1; i <= STACK_HEIGHT; i++) {
+        bodies[i] = (SolverBody) {{0, -1}, VEC_ZERO, 1};
+        contacts[i - 1].body1 = i - 1;
+        contacts[i - 1].body2 = i;
+        contacts[i - 1].normal = (Vector) {0, 1};
+        contacts[i - 1].depth = 0;
+        contacts[i - 1].elasticity = 0.5;
+    }
+}
+
+double stack_error(SolverBody *bodies) {
+    double error = 0;
+    for (size_t i = 1; i <= STACK_HEIGHT; i++) {
+        error = fmax(error, vec_len(bodies[i].velocity));
+    }
+    return error;
+}
+
+void test_stack_converges() {
+    SolverBody bodies[STACK_HEIGHT + 1];
+    SolverContact contacts[STACK_HEIGHT];
+    double last_error = INFINITY;
+    for (size_t iterations = 1; iterations <= 128; iterations *= 2) {
+        init_stack(bodies, contacts);
+        for (size_t i = 0; i < STACK_HEIGHT; i++) {
+            contacts[i].impulse = 0;
+        }
+        solver_solve(bodies, contacts, STACK_HEIGHT, 0.1, iterations);
+        double error = stack_error(bodies);
+        assert(error <= last_error);
+        last_error = error;
+    }
+    assert(last_error < 1e-3);
+    // Each contact holds up the bodies above it, without bouncing them
+    for (size_t i = 0; i < STACK_HEIGHT; i++) {
+        assert(within(1e-2, contacts[i].impulse, STACK_HEIGHT - i));
+    }
+}
+
+// Cold, a tall stack takes many sweeps to settle,
+// but starting from last tick's impulses, one sweep is enough
+void test_warm_start() {
+    SolverBody bodies[STACK_HEIGHT + 1];
+    SolverContact contacts[STACK_HEIGHT];
+    init_stack(bodies, contacts);
+    for (size_t i = 0; i < STACK_HEIGHT; i++) {
+        contacts[i].impulse = 0;
+    }
+    solver_solve(bodies, contacts, STACK_HEIGHT, 0.1, 1);
+    double cold_error = stack_error(bodies);
+
+    init_stack(bodies, contacts);
+    for (size_t i = 0; i < STACK_HEIGHT; i++) {
+        contacts[i].impulse = STACK_HEIGHT - i;
+    }
+    solver_solve(bodies, contacts, STACK_HEIGHT, 0.1, 1);
+    assert(stack_error(bodies) < 1e-9);
+    assert(cold_error > 0.1);
+}
+
+// Overlapping bodies are pushed apart by part of their overlap per tick
+void test_baumgarte() {
+    SolverBody bodies[2] = {
+        {VEC_ZERO, VEC_ZERO, 0},
+        {VEC_ZERO, VEC_ZERO, 1}
+    };
+    double dt = 0.1;
+    SolverContact contact = {0, 1, {0, 1}, 0.5 + SOLVER_SLOP, 0, 0};
+    solver_solve(bodies, &contact, 1, dt, 1);
+    assert(vec_isclose(bodies[1].velocity, (Vector) {0, SOLVER_BAUMGARTE / dt * 0.5}));
+
+    // Overlaps within the slop are left alone
+    bodies[1].velocity = VEC_ZERO;
+    contact = (SolverContact) {0, 1, {0, 1}, SOLVER_SLOP / 2, 0, 0};
+    solver_solve(bodies, &contact, 1, dt, 1);
+    assert(vec_equal(bodies[1].velocity, VEC_ZERO));
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_head_on)
+    DO_TEST(test_separating)
+    DO_TEST(test_stack_converges)
+    DO_TEST(test_warm_start)
+    DO_TEST(test_baumgarte)
+
+    puts("solver_test PASS");
+    return 0;
+}
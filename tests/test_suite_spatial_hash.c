@@ -0,0 +1,78 @@
+#include "spatial_hash.h"
+#include "broadphase_check.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+#define NUM_BOXES 300
+
+void test_spatial_hash_small() {
+    SpatialHash *hash = spatial_hash_init(1);
+    PairBuffer *pairs = pair_buffer_init(1);
+    spatial_hash_insert(hash, 7, (AABB) {{0, 0}, {1.5, 1.5}});
+    spatial_hash_insert(hash, 3, (AABB) {{1, 1}, {2.5, 2.5}});
+    spatial_hash_insert(hash, 5, (AABB) {{5, 5}, {6, 6}});
+    spatial_hash_find_pairs(hash, pairs);
+    // The first two boxes share 4 cells, but are reported once
+    assert(pairs->size == 1);
+    assert(pairs->pairs[0].first == 3);
+    assert(pairs->pairs[0].second == 7);
+    spatial_hash_clear(hash);
+    pair_buffer_clear(pairs);
+    spatial_hash_find_pairs(hash, pairs);
+    assert(pairs->size == 0);
+    pair_buffer_free(pairs);
+    spatial_hash_free(hash);
+}
+
+void test_spatial_hash_matches_brute_force() {
+    srand(1);
+    AABB boxes[NUM_BOXES];
+    SpatialHash *hash = spatial_hash_init(0);
+    PairBuffer *pairs = pair_buffer_init(1);
+    for (int round = 0; round < 5; round++) {
+        spatial_hash_clear(hash);
+        pair_buffer_clear(pairs);
+        for (size_t i = 0; i < NUM_BOXES; i++) {
+            Vector min = {rand_range(-100, 100), rand_range(-100, 100)};
+            // A few boxes are far bigger than the rest
+            double size = i % 50 == 0 ? rand_range(20, 80) : rand_range(0.1, 5);
+            boxes[i] = (AABB) {min, {min.x + size, min.y + rand_range(0.1, size)}};
+            spatial_hash_insert(hash, i, boxes[i]);
+        }
+        if (round == 4) {
+            spatial_hash_set_cell_size(hash, 3);
+        }
+        spatial_hash_find_pairs(hash, pairs);
+        check_pairs(boxes, NULL, NUM_BOXES, pairs);
+
+        // Queries find the same boxes as testing each one, including
+        // queries too big for the grid
+        size_t found[NUM_BOXES] = {0};
+        for (size_t q = 0; q < 10; q++) {
+            Vector min = {rand_range(-110, 110), rand_range(-110, 110)};
+            double size = q == 0 ? 150 : rand_range(0, 20);
+            AABB box = {min, {min.x + size, min.y + rand_range(0, size)}};
+            spatial_hash_query(hash, box, count_found, found);
+            check_query(boxes, NULL, NUM_BOXES, box, found);
+        }
+    }
+    pair_buffer_free(pairs);
+    spatial_hash_free(hash);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_spatial_hash_small)
+    DO_TEST(test_spatial_hash_matches_brute_force)
+
+    puts("spatial_hash_test PASS");
+    return 0;
+}
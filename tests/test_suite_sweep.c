@@ -0,0 +1,142 @@
+#include "sweep.h"
+#include "broadphase_check.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+#define NUM_BOXES 200
+#define NUM_ROUNDS 20
+
+void test_sweep_small() {
+    SweepAndPrune *sweep = sweep_init();
+    PairBuffer *pairs = pair_buffer_init(1);
+    size_t a = sweep_insert(sweep, 0, (AABB) {{0, 0}, {2, 2}});
+    sweep_insert(sweep, 1, (AABB) {{1, 1}, {3, 3}});
+    // Overlaps along x only
+    sweep_insert(sweep, 2, (AABB) {{1, 5}, {3, 6}});
+    sweep_find_pairs(sweep, pairs);
+    assert(pairs->size == 1);
+    assert(pairs->pairs[0].first == 0 && pairs->pairs[0].second == 1);
+
+    // Touching boxes do not overlap
+    sweep_update(sweep, a, 0, (AABB) {{-2, 0}, {1, 2}});
+    pair_buffer_clear(pairs);
+    sweep_find_pairs(sweep, pairs);
+    assert(pairs->size == 0);
+
+    sweep_remove(sweep, a);
+    sweep_insert(sweep, 3, (AABB) {{2, 2}, {2.5, 5.5}});
+    pair_buffer_clear(pairs);
+    sweep_find_pairs(sweep, pairs);
+    pair_buffer_sort(pairs);
+    assert(pairs->size == 2);
+    assert(pairs->pairs[0].first == 1 && pairs->pairs[0].second == 3);
+    assert(pairs->pairs[1].first == 2 && pairs->pairs[1].second == 3);
+    pair_buffer_free(pairs);
+    sweep_free(sweep);
+}
+
+void test_sweep_degenerate() {
+    SweepAndPrune *sweep = sweep_init();
+    PairBuffer *pairs = pair_buffer_init(1);
+    AABB boxes[] = {
+        {{4, 0}, {6, 2}},
+        // No width, inside box 0
+        {{5, 0}, {5, 1}},
+        // No width, on the edges of box 0
+        {{4, 0}, {4, 1}},
+        {{6, 0}, {6, 1}},
+        // No width, at the same x as box 1
+        {{5, 0.5}, {5, 1.5}},
+        // Touching box 0 on both sides
+        {{2, 0}, {4, 2}},
+        {{6, 0}, {8, 2}},
+        // Touching box 5 and box 6 from above
+        {{2, 2}, {8, 3}},
+    };
+    size_t n = sizeof(boxes) / sizeof(AABB);
+    size_t proxies[sizeof(boxes) / sizeof(AABB)];
+    for (size_t i = 0; i < n; i++) {
+        proxies[i] = sweep_insert(sweep, i, boxes[i]);
+    }
+    sweep_find_pairs(sweep, pairs);
+    check_pairs(boxes, NULL, n, pairs);
+    assert(pairs->size == 2);
+
+    // Collapse box 5 onto box 0's left edge, which keeps the order sorted
+    boxes[5] = (AABB) {{4, 0}, {4, 2}};
+    sweep_update(sweep, proxies[5], 5, boxes[5]);
+    pair_buffer_clear(pairs);
+    sweep_find_pairs(sweep, pairs);
+    check_pairs(boxes, NULL, n, pairs);
+    pair_buffer_free(pairs);
+    sweep_free(sweep);
+}
+
+void test_sweep_matches_brute_force() {
+    srand(2);
+    AABB boxes[NUM_BOXES];
+    Vector velocities[NUM_BOXES];
+    bool present[NUM_BOXES];
+    size_t proxies[NUM_BOXES];
+    SweepAndPrune *sweep = sweep_init();
+    PairBuffer *pairs = pair_buffer_init(1);
+    for (size_t i = 0; i < NUM_BOXES; i++) {
+        Vector min = {rand_range(-50, 50), rand_range(-50, 50)};
+        boxes[i] = (AABB) {min, {min.x + rand_range(0.5, 5), min.y + rand_range(0.5, 5)}};
+        velocities[i] = (Vector) {rand_range(-1, 1), rand_range(-1, 1)};
+        present[i] = true;
+        proxies[i] = sweep_insert(sweep, i, boxes[i]);
+    }
+    for (int round = 0; round < NUM_ROUNDS; round++) {
+        for (size_t i = 0; i < NUM_BOXES; i++) {
+            if (present[i] && rand() % 20 == 0) {
+                // Take some boxes out and put others back in
+                sweep_remove(sweep, proxies[i]);
+                present[i] = false;
+                continue;
+            }
+            boxes[i].min = vec_add(boxes[i].min, velocities[i]);
+            boxes[i].max = vec_add(boxes[i].max, velocities[i]);
+            if (!present[i]) {
+                if (rand() % 4 == 0) {
+                    proxies[i] = sweep_insert(sweep, i, boxes[i]);
+                    present[i] = true;
+                }
+            } else {
+                sweep_update(sweep, proxies[i], i, boxes[i]);
+            }
+        }
+        pair_buffer_clear(pairs);
+        sweep_find_pairs(sweep, pairs);
+        check_pairs(boxes, present, NUM_BOXES, pairs);
+
+        // Queries find the same boxes as testing each one
+        size_t found[NUM_BOXES] = {0};
+        for (size_t q = 0; q < 10; q++) {
+            Vector min = {rand_range(-60, 60), rand_range(-60, 60)};
+            AABB box = {min, {min.x + rand_range(0, 20), min.y + rand_range(0, 20)}};
+            sweep_query(sweep, box, count_found, found);
+            check_query(boxes, present, NUM_BOXES, box, found);
+        }
+    }
+    pair_buffer_free(pairs);
+    sweep_free(sweep);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_sweep_small)
+    DO_TEST(test_sweep_degenerate)
+    DO_TEST(test_sweep_matches_brute_force)
+
+    puts("sweep_test PASS");
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "thread_pool.h"
+#include "test_util.h"
+#include <assert.h>
+#include <stdlib.h>
+
+#define NUM_ITEMS 1000
+
+typedef struct {
+    size_t calls[8];
+    int items[NUM_ITEMS];
+} Counts;
+
+void count_task(size_t worker, size_t num_workers, void *aux) {
+    Counts *counts = aux;
+    assert(worker < num_workers);
+    counts->calls[worker]++;
+    size_t start, end;
+    thread_pool_split(worker, num_workers, NUM_ITEMS, &start, &end);
+    for (size_t i = start; i < end; i++) {
+        counts->items[i]++;
+    }
+}
+
+void test_split() {
+    for (size_t workers = 1; workers <= 7; workers++) {
+        for (size_t n = 0; n < 20; n++) {
+            size_t expected_start = 0;
+            for (size_t w = 0; w < workers; w++) {
+                size_t start, end;
+                thread_pool_split(w, workers, n, &start, &end);
+                assert(start == expected_start);
+                assert(end >= start);
+                assert(end - start <= n / workers + 1);
+                expected_start = end;
+            }
+            assert(expected_start == n);
+        }
+    }
+}
+
+void test_run_every_worker() {
+    for (size_t threads = 1; threads <= 8; threads++) {
+        ThreadPool *pool = thread_pool_init(threads);
+        assert(thread_pool_size(pool) == threads);
+        Counts *counts = calloc(1, sizeof(Counts));
+        const size_t RUNS = 50;
+        for (size_t r = 0; r < RUNS; r++) {
+            thread_pool_run(pool, count_task, counts);
+        }
+        for (size_t w = 0; w < threads; w++) {
+            assert(counts->calls[w] == RUNS);
+        }
+        for (size_t i = 0; i < NUM_ITEMS; i++) {
+            assert(counts->items[i] == (int) RUNS);
+        }
+        free(counts);
+        thread_pool_free(pool);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_split)
+    DO_TEST(test_run_every_worker)
+
+    puts("thread_pool_test PASS");
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "vector_batch.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+// An odd count, so that every version also runs its scalar tail
+#define NUM_VECTORS 11
+
+void make_vectors(Vector *vectors) {
+    for (size_t i = 0; i < NUM_VECTORS; i++) {
+        vectors[i] = (Vector) {sin(i * 1.7) * (i + 1), cos(i * 0.9) * 3 - (double) i};
+    }
+}
+
+void test_backend() {
+    const char *backend = vec_batch_backend();
+    assert(strcmp(backend, "avx2") == 0 || strcmp(backend, "sse2") == 0
+        || strcmp(backend, "scalar") == 0);
+}
+
+void test_translate() {
+    Vector vectors[NUM_VECTORS], expected[NUM_VECTORS];
+    make_vectors(vectors);
+    make_vectors(expected);
+    Vector translation = {1.25, -3.5};
+    vec_batch_translate(vectors, NUM_VECTORS, translation);
+    for (size_t i = 0; i < NUM_VECTORS; i++) {
+        assert(vec_equal(vectors[i], vec_add(expected[i], translation)));
+    }
+    // An empty array is left alone
+    vec_batch_translate(NULL, 0, translation);
+}
+
+void test_transform() {
+    Vector in[NUM_VECTORS], out[NUM_VECTORS];
+    make_vectors(in);
+    BatchTransform transform = {2, -1, 0.5, 3, {4, -6}};
+    vec_batch_transform(out, in, NUM_VECTORS, transform);
+    for (size_t i = 0; i < NUM_VECTORS; i++) {
+        Vector expected = {
+            transform.xx * in[i].x + transform.xy * in[i].y + transform.offset.x,
+            transform.yx * in[i].x + transform.yy * in[i].y + transform.offset.y
+        };
+        assert(vec_equal(out[i], expected));
+    }
+    // Transforming in place gives the same result
+    vec_batch_transform(in, in, NUM_VECTORS, transform);
+    for (size_t i = 0; i < NUM_VECTORS; i++) {
+        assert(vec_equal(in[i], out[i]));
+    }
+}
+
+void test_rotation() {
+    Vector vectors[NUM_VECTORS], original[NUM_VECTORS];
+    make_vectors(vectors);
+    make_vectors(original);
+    Vector point = {2, -1};
+    vec_batch_transform(vectors, vectors, NUM_VECTORS, vec_batch_rotation(M_PI / 3, point));
+    for (size_t i = 0; i < NUM_VECTORS; i++) {
+        Vector expected = vec_add(point, vec_rotate(vec_subtract(original[i], point), M_PI / 3));
+        assert(vec_isclose(vectors[i], expected));
+    }
+    // The point itself does not move
+    vec_batch_transform(&point, &point, 1, vec_batch_rotation(1, point));
+    assert(vec_isclose(point, (Vector) {2, -1}));
+}
+
+void test_project() {
+    Vector vectors[NUM_VECTORS];
+    make_vectors(vectors);
+    Vector axis = {0.6, 0.8};
+    for (size_t n = 1; n <= NUM_VECTORS; n++) {
+        double min, max;
+        vec_batch_project(vectors, n, axis, &min, &max);
+        double expected_min = INFINITY, expected_max = -INFINITY;
+        for (size_t i = 0; i < n; i++) {
+            double dot = vec_dot(axis, vectors[i]);
+            expected_min = fmin(expected_min, dot);
+            expected_max = fmax(expected_max, dot);
+        }
+        assert(min == expected_min);
+        assert(max == expected_max);
+    }
+}
+
+void test_bounds() {
+    Vector vectors[NUM_VECTORS];
+    make_vectors(vectors);
+    for (size_t n = 1; n <= NUM_VECTORS; n++) {
+        Vector min, max;
+        vec_batch_bounds(vectors, n, &min, &max);
+        Vector expected_min = vectors[0], expected_max = vectors[0];
+        for (size_t i = 1; i < n; i++) {
+            expected_min.x = fmin(expected_min.x, vectors[i].x);
+            expected_min.y = fmin(expected_min.y, vectors[i].y);
+            expected_max.x = fmax(expected_max.x, vectors[i].x);
+            expected_max.y = fmax(expected_max.y, vectors[i].y);
+        }
+        assert(vec_equal(min, expected_min));
+        assert(vec_equal(max, expected_max));
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_backend)
+    DO_TEST(test_translate)
+    DO_TEST(test_transform)
+    DO_TEST(test_rotation)
+    DO_TEST(test_project)
+    DO_TEST(test_bounds)
+
+    puts("vector_batch_test PASS");
+    return 0;
+}